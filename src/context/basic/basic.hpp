@@ -6,6 +6,8 @@
 
 #include "factory.hpp"
 
+#include "tools/trace.h"
+
 namespace pppu
 {
 
@@ -16,6 +18,7 @@ namespace pppu
 template <typename Value>
 Value input(Context* ctx, Value const& in)
 {
+    trace::Span span("input");
     return f_input(ctx, in);
 }
 
@@ -26,6 +29,7 @@ Value input(Context* ctx, Value const& in)
 template <typename Value>
 Value open(Context* ctx, Value const& in)
 {
+    trace::Span span("open");
     return f_open(ctx, in);
 }
 
@@ -69,6 +73,7 @@ Value sub(Context* ctx, Value const& lhs, Value const& rhs)
 template <typename Value>
 Value mul(Context* ctx, Value const& lhs, Value const& rhs)
 {
+    trace::Span span("mul");
     return f_mul(ctx, lhs, rhs);
 }
 
@@ -80,6 +85,7 @@ Value mul(Context* ctx, Value const& lhs, Value const& rhs)
 template <typename Value>
 Value matmul(Context* ctx, Value const& lhs, Value const& rhs)
 {
+    trace::Span span("matmul");
     return f_matmul(ctx, lhs, rhs);
 }
 
@@ -90,6 +96,7 @@ Value matmul(Context* ctx, Value const& lhs, Value const& rhs)
 template <typename Value>
 Value square(Context* ctx, Value const& in)
 {
+    trace::Span span("square");
     using Protocol = typename Value::Protocol;
     using pdtype = typename Value::PlainType::value_type;
     using sdtype = typename Value::ShareType::value_type;
@@ -113,6 +120,7 @@ Value square(Context* ctx, Value const& in)
 template <typename Value>
 Value msb(Context* ctx, Value const& in)
 {
+    trace::Span span("msb");
     return f_msb(ctx, in);
 }
 
@@ -123,6 +131,7 @@ Value msb(Context* ctx, Value const& in)
 template <typename Value>
 Value eqz(Context* ctx, Value const& x)
 {
+    trace::Span span("eqz");
     using Protocol = typename Value::Protocol;
     using pdtype = typename Value::PlainType::value_type;
     using sdtype = typename Value::ShareType::value_type;
@@ -182,6 +191,7 @@ Value abs(Context* ctx, Value const& x)
 template <typename Value>
 std::vector<Value> bitdec(Context* ctx, Value const& in, std::size_t nbits)
 {
+    trace::Span span("bitdec");
     return f_bitdec(ctx, in, nbits);
 }
 
@@ -194,6 +204,7 @@ std::vector<Value> bitdec(Context* ctx, Value const& in, std::size_t nbits)
 template <typename Value>
 std::vector<Value> h1bitdec(Context* ctx, Value const& in, std::size_t nbits)
 {
+    trace::Span span("h1bitdec");
     return f_h1bitdec(ctx, in, nbits);
 }
 
@@ -124,12 +124,11 @@ Value make_public(Context* ctx, core::NDArrayRef<T> const& data, int64_t fracbit
     // TODO support user defined function
     using U = Value::PlainType::value_type;
     static_assert( std::constructible_from<U, T> );
-    auto fn = [](T const x){ return U(x); };
     
     if(fracbits == -1)
         fracbits = ctx->fxp_fracbits();
 
-    core::NDArrayRef<U> encoded_data = detail::encode(std::forward<decltype(fn)>(fn), data, fracbits);
+    core::NDArrayRef<U> encoded_data = detail::encode_fixed_point<U>(data, fracbits);
     return make_public<Value>(ctx, std::move(encoded_data), fracbits);
 }
 
@@ -160,12 +159,11 @@ Value make_private(Context* ctx, core::NDArrayRef<T> const& data, int64_t fracbi
     // TODO support user defined function
     using U = Value::PlainType::value_type;
     static_assert( std::constructible_from<U, T> );
-    auto fn = [](T const x){ return U(x); };
     
     if(fracbits == -1)
         fracbits = ctx->fxp_fracbits();
 
-    core::NDArrayRef<U> encoded_data = detail::encode(std::forward<decltype(fn)>(fn), data, fracbits);
+    core::NDArrayRef<U> encoded_data = detail::encode_fixed_point<U>(data, fracbits);
     return make_private<Value>(ctx, std::move(encoded_data), fracbits);
 }
 
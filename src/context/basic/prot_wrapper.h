@@ -22,6 +22,16 @@ concept protWithMethodMatmul = requires(Protocol prot, core::ArrayRef<pdtype> p,
     { prot.matmul_ss( s, s, M, N, K ) } -> std::same_as< core::ArrayRef<sdtype> >;
 };
 
+/// @brief Determine whether the protocol multiplies matrices given as two-dimensional views, reading their strides in place.
+template <typename Protocol, typename pdtype, typename sdtype>
+concept protWithMethodStridedMatmul = requires(Protocol prot, core::NDArrayRef<pdtype> p, core::NDArrayRef<sdtype> s)
+{
+    { prot.matmul_pp( p, p ) } -> std::same_as< core::NDArrayRef<pdtype> >;
+    { prot.matmul_ps( p, s ) } -> std::same_as< core::NDArrayRef<sdtype> >;
+    { prot.matmul_sp( s, p ) } -> std::same_as< core::NDArrayRef<sdtype> >;
+    { prot.matmul_ss( s, s ) } -> std::same_as< core::NDArrayRef<sdtype> >;
+};
+
 /// @brief Determine whether the input meets the requirements of square.
 template <typename Protocol, typename pdtype, typename sdtype>
 concept protWithMethodSquare = requires(Protocol prot, core::ArrayRef<pdtype> p, core::ArrayRef<sdtype> s)
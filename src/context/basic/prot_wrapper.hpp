@@ -251,16 +251,28 @@ Value _matmul_pp(Context* ctx, Value const& lhs, Value const& rhs)
 {
     assert( lhs.is_plain() && rhs.is_plain() );
 
-    auto* prot = ctx->prot<typename Value::Protocol>();
+    using Protocol = typename Value::Protocol;
+    using pdtype = typename Value::PlainType::value_type;
+    using sdtype = typename Value::ShareType::value_type;
 
-    auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+    auto* prot = ctx->prot<Protocol>();
 
     Value ans;
 
-    auto flhs = flatten( lhs.data_p() );
-    auto frhs = flatten( rhs.data_p() );
-    auto fans = prot->matmul_pp( flhs, frhs, M, N, K );
-    ans.assign_p( unflatten(fans, {M, K}) );
+    if constexpr ( protWithMethodStridedMatmul<Protocol, pdtype, sdtype> )
+    {
+        // transposed or sliced operands are read in place
+        ans.assign_p( prot->matmul_pp( lhs.data_p(), rhs.data_p() ) );
+    }
+    else
+    {
+        auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+
+        auto flhs = flatten( lhs.data_p() );
+        auto frhs = flatten( rhs.data_p() );
+        auto fans = prot->matmul_pp( flhs, frhs, M, N, K );
+        ans.assign_p( unflatten(fans, {M, K}) );
+    }
 
     return ans;
 }
@@ -275,16 +287,28 @@ Value _matmul_sp(Context* ctx, Value const& lhs, Value const& rhs)
 {
     assert( lhs.is_share() && rhs.is_plain() );
 
-    auto* prot = ctx->prot<typename Value::Protocol>();
+    using Protocol = typename Value::Protocol;
+    using pdtype = typename Value::PlainType::value_type;
+    using sdtype = typename Value::ShareType::value_type;
 
-    auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+    auto* prot = ctx->prot<Protocol>();
 
     Value ans;
 
-    auto flhs = flatten( lhs.data_s() );
-    auto frhs = flatten( rhs.data_p() );
-    auto fans = prot->matmul_sp( flhs, frhs, M, N, K );
-    ans.assign_s( unflatten(fans, {M, K}) );
+    if constexpr ( protWithMethodStridedMatmul<Protocol, pdtype, sdtype> )
+    {
+        // transposed or sliced operands are read in place
+        ans.assign_s( prot->matmul_sp( lhs.data_s(), rhs.data_p() ) );
+    }
+    else
+    {
+        auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+
+        auto flhs = flatten( lhs.data_s() );
+        auto frhs = flatten( rhs.data_p() );
+        auto fans = prot->matmul_sp( flhs, frhs, M, N, K );
+        ans.assign_s( unflatten(fans, {M, K}) );
+    }
 
     return ans;
 }
@@ -299,16 +323,28 @@ Value _matmul_ps(Context* ctx, Value const& lhs, Value const& rhs)
 {
     assert( lhs.is_plain() && rhs.is_share() );
 
-    auto* prot = ctx->prot<typename Value::Protocol>();
+    using Protocol = typename Value::Protocol;
+    using pdtype = typename Value::PlainType::value_type;
+    using sdtype = typename Value::ShareType::value_type;
 
-    auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+    auto* prot = ctx->prot<Protocol>();
 
     Value ans;
 
-    auto flhs = flatten( lhs.data_p() );
-    auto frhs = flatten( rhs.data_s() );
-    auto fans = prot->matmul_ps( flhs, frhs, M, N, K );
-    ans.assign_s( unflatten(fans, {M, K}) );
+    if constexpr ( protWithMethodStridedMatmul<Protocol, pdtype, sdtype> )
+    {
+        // transposed or sliced operands are read in place
+        ans.assign_s( prot->matmul_ps( lhs.data_p(), rhs.data_s() ) );
+    }
+    else
+    {
+        auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+
+        auto flhs = flatten( lhs.data_p() );
+        auto frhs = flatten( rhs.data_s() );
+        auto fans = prot->matmul_ps( flhs, frhs, M, N, K );
+        ans.assign_s( unflatten(fans, {M, K}) );
+    }
 
     return ans;
 }
@@ -323,16 +359,28 @@ Value _matmul_ss(Context* ctx, Value const& lhs, Value const& rhs)
 {
     assert( lhs.is_share() && rhs.is_share() );
 
-    auto* prot = ctx->prot<typename Value::Protocol>();
+    using Protocol = typename Value::Protocol;
+    using pdtype = typename Value::PlainType::value_type;
+    using sdtype = typename Value::ShareType::value_type;
 
-    auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+    auto* prot = ctx->prot<Protocol>();
 
     Value ans;
 
-    auto flhs = flatten( lhs.data_s() );
-    auto frhs = flatten( rhs.data_s() );
-    auto fans = prot->matmul_ss( flhs, frhs, M, N, K );
-    ans.assign_s( unflatten(fans, {M, K}) );
+    if constexpr ( protWithMethodStridedMatmul<Protocol, pdtype, sdtype> )
+    {
+        // transposed or sliced operands are read in place
+        ans.assign_s( prot->matmul_ss( lhs.data_s(), rhs.data_s() ) );
+    }
+    else
+    {
+        auto [M, N, K] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
+
+        auto flhs = flatten( lhs.data_s() );
+        auto frhs = flatten( rhs.data_s() );
+        auto fans = prot->matmul_ss( flhs, frhs, M, N, K );
+        ans.assign_s( unflatten(fans, {M, K}) );
+    }
 
     return ans;
 }
@@ -49,4 +49,25 @@ core::NDArrayRef<T> decode(
     int64_t fracbits
 );
 
+/// @brief Encode builtin floating point values to fixed point integers, round(x * 2^fracbits) converted to U.
+/// @param U The integral type which Value used
+/// @param T The builtin floating point type
+/// @note Contiguous inputs are converted in blocks by encode_fixed, the result equals the one of encode.
+template <typename U, std::floating_point T>
+requires std::constructible_from<U, int64_t>
+core::NDArrayRef<U> encode_fixed_point(
+    core::NDArrayRef<T> const& input,
+    int64_t fracbits
+);
+
+/// @brief Decode fixed point integers which Value used to builtin floating point values, x * 2^-fracbits.
+/// @param T The builtin floating point type
+/// @param U The integral type which Value used
+/// @note Types whose values fit into int64_t are converted in blocks by decode_fixed, others one by one.
+template <std::floating_point T, typename U>
+core::NDArrayRef<T> decode_fixed_point(
+    core::NDArrayRef<U> const& input,
+    int64_t fracbits
+);
+
 } // namespace pppu::detail
@@ -4,6 +4,7 @@
 
 #include "ndarray/ndarray_ref.hpp"
 #include "ndarray/tools.hpp"
+#include "tools/fixed_point_codec.h"
 
 namespace pppu::detail
 {
@@ -70,4 +71,101 @@ core::NDArrayRef<T> decode(
     return output;
 }
 
+/// @brief Number of elements converted per block, the int64_t staging buffer stays in L1.
+inline constexpr int64_t FIXED_POINT_BLOCK = 1024;
+
+/// @brief Types whose values are read as an int64_t without loss.
+template <typename U>
+concept Int64Representable = requires { typename U::value_type; }
+    && std::integral<typename U::value_type>
+    && ( sizeof(typename U::value_type) < sizeof(int64_t)
+      || ( sizeof(typename U::value_type) == sizeof(int64_t) && std::is_signed_v<typename U::value_type> ) );
+
+/// @brief Encode builtin floating point values to fixed point integers, round(x * 2^fracbits) converted to U.
+/// @param U The integral type which Value used
+/// @param T The builtin floating point type
+/// @note Contiguous inputs are converted in blocks by encode_fixed, the result equals the one of encode.
+template <typename U, std::floating_point T>
+requires std::constructible_from<U, int64_t>
+core::NDArrayRef<U> encode_fixed_point(
+    core::NDArrayRef<T> const& input,
+    int64_t fracbits
+) {
+    auto scalar = [fracbits](T const& x){
+        return U( std::round( std::ldexp(x, fracbits) ) );
+    };
+
+    // broadcast arrays stay lazy, other layouts without a linear iterator are rare
+    auto const& shape   = input.shape();
+    auto const& strides = input.strides();
+    if( core::detail::isBroadcastStrides(strides) || !core::detail::isLinearStrides(strides, shape) )
+        return core::apply(scalar, input);
+
+    auto    output = core::make_ndarray<U>(shape);
+    int64_t numel  = input.numel();
+    int64_t stride = strides.empty() ? 1 : strides.back();
+    T const* src   = input.data() + input.offset();
+    U*       dest  = output.data();
+
+    int64_t block[FIXED_POINT_BLOCK];
+    for(int64_t i = 0; i < numel; i += FIXED_POINT_BLOCK) {
+        int64_t n = std::min(FIXED_POINT_BLOCK, numel - i);
+        if( encode_fixed(src + i * stride, stride, n, fracbits, block) ) {
+            for(int64_t j = 0; j < n; ++j)
+                dest[i + j] = U(block[j]);
+        }
+        else /* out of range, inf or nan somewhere in the block */ {
+            for(int64_t j = 0; j < n; ++j)
+                dest[i + j] = scalar(src[(i + j) * stride]);
+        }
+    }
+    return output;
+}
+
+/// @brief Decode fixed point integers which Value used to builtin floating point values, x * 2^-fracbits.
+/// @param T The builtin floating point type
+/// @param U The integral type which Value used
+/// @note Types whose values fit into int64_t are converted in blocks by decode_fixed, others one by one.
+template <std::floating_point T, typename U>
+core::NDArrayRef<T> decode_fixed_point(
+    core::NDArrayRef<U> const& input,
+    int64_t fracbits
+) {
+    auto scalar = [fracbits](U const& x){
+        if constexpr ( requires { static_cast<T>(x); } )
+            return std::ldexp(static_cast<T>(x), -fracbits);
+        else
+            return static_cast<T>( std::ldexp(static_cast<double>(x), -fracbits) );
+    };
+
+    auto const& shape   = input.shape();
+    auto const& strides = input.strides();
+    if constexpr ( !Int64Representable<U> ) {
+        return core::apply(scalar, input);
+    }
+    else {
+        if( core::detail::isBroadcastStrides(strides) || !core::detail::isLinearStrides(strides, shape) )
+            return core::apply(scalar, input);
+
+        using value_type = typename U::value_type;
+        auto    output = core::make_ndarray<T>(shape);
+        int64_t numel  = input.numel();
+        int64_t stride = strides.empty() ? 1 : strides.back();
+        U const* src   = input.data() + input.offset();
+        T*       dest  = output.data();
+
+        int64_t block[FIXED_POINT_BLOCK];
+        for(int64_t i = 0; i < numel; i += FIXED_POINT_BLOCK) {
+            int64_t n = std::min(FIXED_POINT_BLOCK, numel - i);
+            for(int64_t j = 0; j < n; ++j)
+                block[j] = static_cast<int64_t>( static_cast<value_type>(src[(i + j) * stride]) );
+            if( !decode_fixed(block, n, fracbits, dest + i) ) {
+                for(int64_t j = 0; j < n; ++j)
+                    dest[i + j] = scalar(src[(i + j) * stride]);
+            }
+        }
+        return output;
+    }
+}
+
 } // namespace pppu::detail
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
+#include <vector>
 
 #include "network/multi_party_player.h"
 #include "mpc/protocol.hpp"
@@ -63,6 +65,8 @@ private:
 
     Config _config;
 
+    std::vector<std::unique_ptr<Context>> _shards;
+
 public:
 
     /// @brief Constructor of Config.
@@ -103,6 +107,25 @@ public:
     /// @return The number of participants in communication
     std::size_t num_parties() const { return _netio->num_players(); }
 
+    /// @brief Attach the contexts used by sharded execution, see pppu::sharded.
+    /// @param shards Contexts with their own protocol, preprocessing and connections, every party must attach
+    ///        the same number of shards in the same order
+    void set_shards(std::vector<std::unique_ptr<Context>> shards) { _shards = std::move(shards); }
+
+    /// @brief Get the number of contexts used by sharded execution.
+    /// @return Number of shards, 0 if sharded execution is disabled
+    std::size_t num_shards() const { return _shards.size(); }
+
+    /// @brief Get a context used by sharded execution.
+    /// @param i Index of the shard
+    /// @return The i-th shard
+    Context* shard(std::size_t i) const
+    {
+        if( i >= _shards.size() )
+            throw std::out_of_range("shard index out of range");
+        return _shards[i].get();
+    }
+
 };
 
 } // namespace pppu
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "context/context.hpp"
+
+namespace pppu
+{
+
+/// @class LazyGraph
+/// @brief Opt-in lazy mode of Value operations, operations are recorded as a DAG and executed by run().
+/// @details Linear operations are evaluated locally as soon as their operands are known. All nonlinear
+///          nodes whose operands are known are ready at the same time, ready nodes of the same kind and
+///          operand signature are flattened, concatenated and evaluated by one call of the eager function,
+///          so they share its network rounds. The results are then split and reshaped back.
+/// @param Value The Value type of the graph
+template <typename Value>
+class LazyGraph
+{
+public:
+
+    /// @brief Handle of a recorded node.
+    using Node = std::size_t;
+
+    /// @brief Kind of a recorded node.
+    enum class Op { input, neg, add, sub, mul, square, msb, eqz };
+
+    /// @brief Record a known Value.
+    /// @param in The input Value object
+    /// @return Node holding in
+    Node input(Value const& in);
+
+    /// @brief Record the negation of a node.
+    Node neg(Node in);
+
+    /// @brief Record the sum of two nodes.
+    Node add(Node lhs, Node rhs);
+
+    /// @brief Record the difference of two nodes.
+    Node sub(Node lhs, Node rhs);
+
+    /// @brief Record the product of two nodes.
+    Node mul(Node lhs, Node rhs);
+
+    /// @brief Record the square of a node.
+    Node square(Node in);
+
+    /// @brief Record the most significant bit of a node.
+    Node msb(Node in);
+
+    /// @brief Record the equal to zero test of a node.
+    Node eqz(Node in);
+
+    /// @brief Record lhs < rhs, see pppu::less.
+    Node less(Node lhs, Node rhs);
+
+    /// @brief Record lhs > rhs, see pppu::greater.
+    Node greater(Node lhs, Node rhs);
+
+    /// @brief Record cond == 0 ? v0 : v1, see pppu::conditional.
+    Node conditional(Node cond, Node v0, Node v1);
+
+    /// @brief Execute every node not executed yet.
+    /// @param ctx The calculation settings
+    void run(Context* ctx);
+
+    /// @brief Get the Value of an executed node.
+    /// @param node The node
+    /// @return The Value of node
+    Value const& value(Node node) const;
+
+    /// @brief Get the number of nonlinear calls issued by run().
+    /// @return Number of batched nonlinear calls, each one costs the rounds of a single operation
+    std::size_t num_batches() const { return _num_batches; }
+
+private:
+
+    struct NodeInfo {
+        Op op;
+        std::array<Node, 2> args;
+        std::size_t nargs;
+        std::optional<Value> value;
+    };
+
+    std::vector<NodeInfo> _nodes;
+    std::size_t _num_batches = 0;
+
+    /// @brief Append a node, the operands must be recorded before.
+    Node record(Op op, std::array<Node, 2> args, std::size_t nargs);
+
+    /// @brief Evaluate op on the given operands eagerly.
+    static Value eval(Context* ctx, Op op, std::array<Value const*, 2> args);
+
+    /// @brief Evaluate a group of ready nodes of the same kind and operand signature with one call.
+    void run_batch(Context* ctx, std::vector<Node> const& nodes);
+};
+
+} // namespace pppu
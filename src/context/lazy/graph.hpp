@@ -0,0 +1,178 @@
+#pragma once
+
+#include <map>
+#include <stdexcept>
+
+#include "graph.h"
+
+#include "context/basic/basic.hpp"
+#include "context/shape/concatenate.hpp"
+
+namespace pppu
+{
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::record(Op op, std::array<Node, 2> args, std::size_t nargs)
+{
+    for(std::size_t i = 0; i < nargs; ++i)
+        if( args[i] >= _nodes.size() )
+            throw std::invalid_argument("unknown node");
+    _nodes.push_back( NodeInfo{op, args, nargs, std::nullopt} );
+    return _nodes.size() - 1;
+}
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::input(Value const& in)
+{
+    _nodes.push_back( NodeInfo{Op::input, {0, 0}, 0, in} );
+    return _nodes.size() - 1;
+}
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::neg(Node in)              { return record(Op::neg,    {in, 0},     1); }
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::add(Node lhs, Node rhs)   { return record(Op::add,    {lhs, rhs},  2); }
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::sub(Node lhs, Node rhs)   { return record(Op::sub,    {lhs, rhs},  2); }
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::mul(Node lhs, Node rhs)   { return record(Op::mul,    {lhs, rhs},  2); }
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::square(Node in)           { return record(Op::square, {in, 0},     1); }
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::msb(Node in)              { return record(Op::msb,    {in, 0},     1); }
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::eqz(Node in)              { return record(Op::eqz,    {in, 0},     1); }
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::less(Node lhs, Node rhs)
+{
+    return msb( sub(lhs, rhs) );
+}
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::greater(Node lhs, Node rhs)
+{
+    return less(rhs, lhs);
+}
+
+template <typename Value>
+typename LazyGraph<Value>::Node LazyGraph<Value>::conditional(Node cond, Node v0, Node v1)
+{
+    return add( v0, mul(cond, sub(v1, v0)) );
+}
+
+template <typename Value>
+Value const& LazyGraph<Value>::value(Node node) const
+{
+    if( node >= _nodes.size() || !_nodes[node].value )
+        throw std::runtime_error("node used before executed");
+    return *_nodes[node].value;
+}
+
+template <typename Value>
+Value LazyGraph<Value>::eval(Context* ctx, Op op, std::array<Value const*, 2> args)
+{
+    switch(op) {
+        case Op::neg:    return pppu::neg   (ctx, *args[0]);
+        case Op::add:    return pppu::add   (ctx, *args[0], *args[1]);
+        case Op::sub:    return pppu::sub   (ctx, *args[0], *args[1]);
+        case Op::mul:    return pppu::mul   (ctx, *args[0], *args[1]);
+        case Op::square: return pppu::square(ctx, *args[0]);
+        case Op::msb:    return pppu::msb   (ctx, *args[0]);
+        case Op::eqz:    return pppu::eqz   (ctx, *args[0]);
+        default:         throw std::invalid_argument("bad node kind");
+    }
+}
+
+template <typename Value>
+void LazyGraph<Value>::run_batch(Context* ctx, std::vector<Node> const& nodes)
+{
+    NodeInfo const& first = _nodes[nodes.front()];
+    ++_num_batches;
+
+    if( nodes.size() == 1 ) {
+        std::array<Value const*, 2> args{};
+        for(std::size_t i = 0; i < first.nargs; ++i)
+            args[i] = &*_nodes[first.args[i]].value;
+        _nodes[nodes.front()].value = eval(ctx, first.op, args);
+        return;
+    }
+
+    // operand i of every node is flattened and concatenated into one Value
+    std::array<Value, 2> batched;
+    for(std::size_t i = 0; i < first.nargs; ++i) {
+        std::vector<Value> parts;
+        for(Node node: nodes) {
+            Value const& x = *_nodes[_nodes[node].args[i]].value;
+            parts.push_back( x.reshape({x.numel()}) );
+        }
+        batched[i] = concatenate(ctx, std::move(parts), 0);
+    }
+
+    Value ans = eval(ctx, first.op, {&batched[0], &batched[1]});
+
+    int64_t offset = 0;
+    for(Node node: nodes) {
+        Value const& x = *_nodes[_nodes[node].args[0]].value;
+        int64_t numel = x.numel();
+        _nodes[node].value = ans.slice(std::vector<core::Slice>{ {offset, offset + numel, 1} }).reshape(x.shape());
+        offset += numel;
+    }
+}
+
+template <typename Value>
+void LazyGraph<Value>::run(Context* ctx)
+{
+    auto ready = [this](NodeInfo const& x) {
+        for(std::size_t i = 0; i < x.nargs; ++i)
+            if( !_nodes[x.args[i]].value )
+                return false;
+        return true;
+    };
+    auto is_local = [](Op op) { return op == Op::neg || op == Op::add || op == Op::sub; };
+
+    while( true ) {
+        // linear nodes cost no round, operands are always recorded before their users
+        for(auto& x: _nodes) {
+            if( !x.value && is_local(x.op) && ready(x) ) {
+                std::array<Value const*, 2> args{};
+                for(std::size_t i = 0; i < x.nargs; ++i)
+                    args[i] = &*_nodes[x.args[i]].value;
+                x.value = eval(ctx, x.op, args);
+            }
+        }
+
+        // group the ready nonlinear nodes, the key is ordered so every party issues the batches in the same order
+        std::map<std::vector<int64_t>, std::vector<Node>> groups;
+        for(Node node = 0; node < _nodes.size(); ++node) {
+            NodeInfo const& x = _nodes[node];
+            if( x.value || is_local(x.op) || !ready(x) )
+                continue;
+
+            std::vector<int64_t> key{ static_cast<int64_t>(x.op) };
+            for(std::size_t i = 0; i < x.nargs; ++i) {
+                Value const& arg = *_nodes[x.args[i]].value;
+                Visibility vis = arg.visibility();
+                key.push_back( vis.is_share() ? -2 : vis.is_public() ? -1 : vis.owner() );
+                key.push_back( arg.fracbits() );
+            }
+            // operands of different shapes are broadcast by the eager function, such nodes run alone
+            if( x.nargs == 2 && _nodes[x.args[0]].value->shape() != _nodes[x.args[1]].value->shape() )
+                key.push_back( static_cast<int64_t>(node) );
+            groups[key].push_back(node);
+        }
+
+        if( groups.empty() )
+            break;
+        for(auto const& [key, nodes]: groups)
+            run_batch(ctx, nodes);
+    }
+}
+
+} // namespace pppu
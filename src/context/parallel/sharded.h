@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+#include "context/context.hpp"
+
+namespace pppu
+{
+
+/// @brief Inputs are not split into shards smaller than this number of elements.
+inline constexpr int64_t SHARD_MIN_NUMEL = 1 << 15;
+
+/// @brief Run an elementwise function on slices of the input in parallel, one slice per shard of ctx.
+/// @param ctx The calculation settings, its shards are attached by Context::set_shards
+/// @param fn Elementwise function called as fn(Context*, Value const&) -> Value, concurrently on different contexts
+/// @param in The input Value object
+/// @return The result, equal to fn(ctx, in)
+/// @note The first slice runs on ctx in the calling thread, slice i > 0 runs on ctx->shard(i - 1) in its own thread,
+///       so each slice has its own protocol instance, preprocessing and connections. The slices share the threads of
+///       the ndarray kernels, see core::ThreadLimit.
+template <typename Value, typename Fn>
+Value sharded(Context* ctx, Fn&& fn, Value const& in);
+
+/// @brief Run an elementwise binary function on slices of the inputs in parallel, one slice per shard of ctx.
+/// @param ctx The calculation settings, its shards are attached by Context::set_shards
+/// @param fn Elementwise function called as fn(Context*, Value const&, Value const&) -> Value
+/// @param lhs The first input Value object
+/// @param rhs The second input Value object, of the same shape as lhs
+/// @return The result, equal to fn(ctx, lhs, rhs)
+template <typename Value, typename Fn>
+Value sharded(Context* ctx, Fn&& fn, Value const& lhs, Value const& rhs);
+
+} // namespace pppu
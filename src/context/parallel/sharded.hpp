@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "sharded.h"
+
+#include "context/shape/concatenate.hpp"
+#include "ndarray/parallel.hpp"
+
+namespace pppu
+{
+
+namespace detail
+{
+
+/// @brief Split the flattened inputs into nshards contiguous slices, run call on each of them and concatenate the results.
+/// @param call Called as call(Context*, std::vector<Value> const& slices) -> Value
+template <typename Value, typename Call>
+Value run_sharded(Context* ctx, std::vector<Value> const& flat, int64_t nshards, Call const& call)
+{
+    int64_t numel = flat.front().numel();
+
+    auto slices = [&](int64_t s) {
+        std::vector<core::Slice> range{ {numel * s / nshards, numel * (s + 1) / nshards, 1} };
+        std::vector<Value> ans;
+        for(auto const& x: flat)
+            ans.push_back( x.slice(range) );
+        return ans;
+    };
+
+    // the shards split the threads of the ndarray kernels instead of each using all of them
+    int64_t nthreads = std::max<int64_t>( core::get_num_threads() / nshards, 1 );
+
+    std::vector<Value> parts(nshards);
+    std::vector<std::exception_ptr> errors(nshards);
+    {
+        std::vector<std::jthread> workers;
+        for(int64_t s = 1; s < nshards; ++s) {
+            workers.emplace_back( [&, s] {
+                core::ThreadLimit limit(nthreads);
+                try { parts[s] = call(ctx->shard(s - 1), slices(s)); }
+                catch(...) { errors[s] = std::current_exception(); }
+            } );
+        }
+        core::ThreadLimit limit(nthreads);
+        try { parts[0] = call(ctx, slices(0)); }
+        catch(...) { errors[0] = std::current_exception(); }
+    }
+    for(auto const& e: errors)
+        if( e ) std::rethrow_exception(e);
+
+    for(int64_t s = 0; s < nshards; ++s)
+        if( parts[s].numel() != numel * (s + 1) / nshards - numel * s / nshards )
+            throw std::invalid_argument("sharded function is not elementwise");
+
+    return concatenate(ctx, std::move(parts), 0);
+}
+
+/// @brief Number of slices of numel elements, every party derives the same number from its own ctx.
+inline int64_t num_slices(Context* ctx, int64_t numel)
+{
+    return std::min<int64_t>( ctx->num_shards() + 1, numel / SHARD_MIN_NUMEL );
+}
+
+} // namespace detail
+
+/// @brief Run an elementwise function on slices of the input in parallel, one slice per shard of ctx.
+/// @param ctx The calculation settings, its shards are attached by Context::set_shards
+/// @param fn Elementwise function called as fn(Context*, Value const&) -> Value, concurrently on different contexts
+/// @param in The input Value object
+/// @return The result, equal to fn(ctx, in)
+template <typename Value, typename Fn>
+Value sharded(Context* ctx, Fn&& fn, Value const& in)
+{
+    int64_t nshards = detail::num_slices(ctx, in.numel());
+    if( nshards <= 1 )
+        return std::invoke(fn, ctx, in);
+
+    std::vector<Value> flat{ in.reshape({in.numel()}) };
+    auto call = [&fn](Context* c, std::vector<Value> const& x) { return std::invoke(fn, c, x[0]); };
+    return detail::run_sharded(ctx, flat, nshards, call).reshape(in.shape());
+}
+
+/// @brief Run an elementwise binary function on slices of the inputs in parallel, one slice per shard of ctx.
+/// @param ctx The calculation settings, its shards are attached by Context::set_shards
+/// @param fn Elementwise function called as fn(Context*, Value const&, Value const&) -> Value
+/// @param lhs The first input Value object
+/// @param rhs The second input Value object, of the same shape as lhs
+/// @return The result, equal to fn(ctx, lhs, rhs)
+template <typename Value, typename Fn>
+Value sharded(Context* ctx, Fn&& fn, Value const& lhs, Value const& rhs)
+{
+    int64_t nshards = detail::num_slices(ctx, lhs.numel());
+    if( nshards <= 1 || lhs.shape() != rhs.shape() )
+        return std::invoke(fn, ctx, lhs, rhs);
+
+    std::vector<Value> flat{ lhs.reshape({lhs.numel()}), rhs.reshape({rhs.numel()}) };
+    auto call = [&fn](Context* c, std::vector<Value> const& x) { return std::invoke(fn, c, x[0], x[1]); };
+    return detail::run_sharded(ctx, flat, nshards, call).reshape(lhs.shape());
+}
+
+} // namespace pppu
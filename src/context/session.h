@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+
+#include "context/context.hpp"
+#include "network/channel.h"
+
+namespace pppu
+{
+
+/// @class Session
+/// @brief Long-lived parties which run many independent jobs over the same connections.
+/// @details The connections of the session player are set up once, every job gets a context of its own on a
+///          channel of them, with its own protocol instance and preprocessing, so starting a job sends nothing.
+///          Jobs of different channels may run concurrently from different threads. The netio of a job context
+///          is a network::ChannelMultiPartyPlayer, network conditions are set on the player of mux().
+/// @param ProtocolType The protocol of the job contexts, constructed from a player and its ProtocolType::Preprocessing
+template <typename ProtocolType>
+class Session
+{
+public:
+    using channel_type = network::ChannelMux::channel_type;
+
+    /// @brief Constructor, keep the connections of a player for the jobs.
+    /// @param config Fixed-point settings of the job contexts
+    /// @param netio Connected player of the session
+    Session(Config config, std::unique_ptr<network::MultiPartyPlayer> netio);
+
+    /// @brief Open the context of a job.
+    /// @param channel Id of the job, every party must use the same id for the same job, and an id can be
+    ///        reused once its previous context is destroyed on every party
+    /// @return Context of the job, it must be destroyed before the session
+    std::unique_ptr<Context> open(channel_type channel);
+
+    /// @brief Run a job in the calling thread.
+    /// @param channel Id of the job, see open
+    /// @param fn Function called as fn(Context*)
+    /// @return The result of fn
+    template <typename Fn>
+    auto run(channel_type channel, Fn&& fn);
+
+    /// @brief Finish the session, blocks until every party finishes it.
+    void close() { _mux.close(); }
+
+    /// @brief Get the participant ID of this party.
+    playerid_t pid() const { return _mux.id(); }
+
+    /// @brief Get the number of participants.
+    std::size_t num_parties() const { return _mux.num_players(); }
+
+    /// @brief Get the fixed-point settings of the job contexts.
+    Config* config() { return &_config; }
+
+    /// @brief Get the channel mux of the session player, such as for emulating network conditions.
+    network::ChannelMux* mux() { return &_mux; }
+
+private:
+    Config _config;
+    network::ChannelMux _mux;
+};
+
+} // namespace pppu
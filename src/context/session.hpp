@@ -0,0 +1,43 @@
+#pragma once
+
+#include <utility>
+
+#include "session.h"
+
+namespace pppu
+{
+
+/// @brief Constructor, keep the connections of a player for the jobs.
+/// @param config Fixed-point settings of the job contexts
+/// @param netio Connected player of the session
+template <typename ProtocolType>
+Session<ProtocolType>::Session(Config config, std::unique_ptr<network::MultiPartyPlayer> netio)
+    : _config( std::move(config) ), _mux( std::move(netio) )
+{
+}
+
+/// @brief Open the context of a job.
+/// @param channel Id of the job, every party must use the same id for the same job
+/// @return Context of the job, it must be destroyed before the session
+template <typename ProtocolType>
+std::unique_ptr<Context> Session<ProtocolType>::open(channel_type channel)
+{
+    std::unique_ptr<network::MultiPartyPlayer> netio = _mux.open(channel);
+    auto prep = std::make_unique<typename ProtocolType::Preprocessing>();
+    auto prot = std::make_unique<ProtocolType>(netio.get(), prep.get());
+    return std::make_unique<Context>(_config, std::move(prot), std::move(prep), std::move(netio));
+}
+
+/// @brief Run a job in the calling thread.
+/// @param channel Id of the job, see open
+/// @param fn Function called as fn(Context*)
+/// @return The result of fn
+template <typename ProtocolType>
+template <typename Fn>
+auto Session<ProtocolType>::run(channel_type channel, Fn&& fn)
+{
+    auto ctx = open(channel);
+    return std::forward<Fn>(fn)(ctx.get());
+}
+
+} // namespace pppu
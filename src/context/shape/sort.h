@@ -3,6 +3,7 @@
 #include "context/context.hpp"
 #include "context/basic/basic.hpp"
 #include "context/compare/compare.hpp"
+#include "context/lazy/graph.hpp"
 
 namespace pppu
 {
@@ -23,22 +23,26 @@ Value odd_even_merge_sort(Context* ctx, Value const& arr)
     if(arr.ndim() > 1)
         throw std::invalid_argument("not implemented");
 
-    int64_t numel = arr.numel();
+    Value ans = arr;
+    int64_t numel = ans.numel();
     for(auto stage: OddEvenSortStages(numel)) {
         auto [idx1, idx2] = OddEvenSortSequence(stage);
 
-        Value x = arr.permute(idx1);
-        Value y = arr.permute(idx2);
+        // both conditionals of a stage are multiplied in one batch
+        LazyGraph<Value> graph;
+        auto x = graph.input( ans.permute(idx1) );
+        auto y = graph.input( ans.permute(idx2) );
 
-        Value gt = greater(ctx, x, y);
+        auto gt = graph.greater(x, y);
 
-        Value xx = conditional(ctx, gt, x, y);
-        Value yy = conditional(ctx, gt, y, x);
+        auto xx = graph.conditional(gt, x, y);
+        auto yy = graph.conditional(gt, y, x);
 
-        arr = arr.substitute(idx1, xx).substitute(idx2, yy);        
+        graph.run(ctx);
+        ans = ans.substitute(idx1, graph.value(xx), idx2, graph.value(yy));
     }
 
-    return arr;
+    return ans;
 }
 
 
@@ -52,20 +56,23 @@ void odd_even_merge_sort(Context* ctx, Value1& arr1,Value2& arr2)
     for(auto stage: OddEvenSortStages(numel)) {
         auto [idx1, idx2] = OddEvenSortSequence(stage);
 
-        Value x1 = arr1.permute(idx1);
-        Value y1 = arr1.permute(idx2);
-        Value x2 = arr2.permute(idx1);
-        Value y2 = arr2.permute(idx2);
+        // the four conditionals of a stage are multiplied in one batch
+        LazyGraph<Value1> graph;
+        auto x1 = graph.input( arr1.permute(idx1) );
+        auto y1 = graph.input( arr1.permute(idx2) );
+        auto x2 = graph.input( arr2.permute(idx1) );
+        auto y2 = graph.input( arr2.permute(idx2) );
 
-        Value gt = greater(ctx, x1, y1);
+        auto gt = graph.greater(x1, y1);
 
-        Value xx1 = conditional(ctx, gt, x1, y1);
-        Value yy1 = conditional(ctx, gt, y1, x1);
-        Value xx2 = conditional(ctx, gt, x2, y2);
-        Value yy2 = conditional(ctx, gt, y2, x2);
+        auto xx1 = graph.conditional(gt, x1, y1);
+        auto yy1 = graph.conditional(gt, y1, x1);
+        auto xx2 = graph.conditional(gt, x2, y2);
+        auto yy2 = graph.conditional(gt, y2, x2);
 
-        arr1 = arr1.substitute(idx1, xx1).substitute(idx2, yy1);
-        arr2 = arr2.substitute(idx1, xx2).substitute(idx2, yy2);                
+        graph.run(ctx);
+        arr1 = arr1.substitute(idx1, graph.value(xx1), idx2, graph.value(yy1));
+        arr2 = arr2.substitute(idx1, graph.value(xx2), idx2, graph.value(yy2));
     }
 }
 } // namespace detail
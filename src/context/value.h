@@ -186,6 +186,11 @@ class Value
     /// @return This Value object
     Value substitute(std::span<const int64_t> indicies, Value const& value) const;
 
+    /// @brief Used to replace the contents at two sets of indices in a single copy.
+    /// @return This Value object, equal to substitute(indicies1, value1).substitute(indicies2, value2)
+    Value substitute(std::span<const int64_t> indicies1, Value const& value1,
+                     std::span<const int64_t> indicies2, Value const& value2) const;
+
     /// @brief Used to print the stored data of a Value object.
     /// @return The stored data of this Value object
     std::string to_string() const;
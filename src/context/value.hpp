@@ -190,4 +190,29 @@ Value<Protocol, pdtype, sdtype> Value<Protocol, pdtype, sdtype>::substitute(
     }
 }
 
+/// @brief Used to replace the contents at two sets of indices in a single copy.
+/// @return This Value object, equal to substitute(indicies1, value1).substitute(indicies2, value2)
+template <typename Protocol, typename pdtype, typename sdtype>
+Value<Protocol, pdtype, sdtype> Value<Protocol, pdtype, sdtype>::substitute(
+    std::span<const int64_t> indicies1,
+    Value<Protocol, pdtype, sdtype> const& value1,
+    std::span<const int64_t> indicies2,
+    Value<Protocol, pdtype, sdtype> const& value2
+) const {
+
+    if(value1.is_plain() && value2.is_plain()) {
+        return _visit2([indicies1, indicies2, data1 = value1.data_p(), data2 = value2.data_p()](auto const& x){
+            return x.substitute(indicies1, data1, indicies2, data2);
+        });
+    }
+    else if(value1.is_share() && value2.is_share()) {
+        return _visit2([indicies1, indicies2, data1 = value1.data_s(), data2 = value2.data_s()](auto const& x){
+            return x.substitute(indicies1, data1, indicies2, data2);
+        });
+    }
+    else {
+        return this->substitute(indicies1, value1).substitute(indicies2, value2);
+    }
+}
+
 } // namespace pppu
@@ -62,6 +62,9 @@ protected:
 public:
     static constexpr bool trivially_serializable = true;
 
+    /// @brief Signed and unsigned Z2 of the same K store the same bits, arrays are reinterpreted between them.
+    using representation_type = Z2<K, false>;
+
     static constexpr Z2 zero() { return Z2(0); }
     static constexpr Z2 one()  { return Z2(1); }
     static constexpr Z2 min();
@@ -225,6 +228,12 @@ protected:
 public:
     static constexpr bool trivially_serializable = true;
 
+    /// @brief Signed and unsigned Z2 of the same K store the same bits, arrays are reinterpreted between them.
+    using representation_type = Z2<K, false>;
+
+    /// @brief Number of significant bits, arrays are packed to wire_bits per element when serialized.
+    static constexpr size_type wire_bits = K;
+
     static constexpr Z2 zero() { return Z2(0); }
     static constexpr Z2 one()  { return Z2(1); }
     static constexpr Z2 min()  { return Z2(std::numeric_limits<value_type>::min()); }
@@ -317,6 +326,19 @@ public:
 
 };
 
+/// @brief Batch arithmetic over n contiguous elements, r[i] = a[i] + b[i], r may alias a or b.
+/// @note Found by argument dependent lookup from the element wise operations of ArrayRef.
+template <size_t K, bool S> requires detail::large<K>
+void add_n(Z2<K, S>* r, Z2<K, S> const* a, Z2<K, S> const* b, size_t n);
+
+/// @brief Batch arithmetic over n contiguous elements, r[i] = a[i] - b[i], r may alias a or b.
+template <size_t K, bool S> requires detail::large<K>
+void sub_n(Z2<K, S>* r, Z2<K, S> const* a, Z2<K, S> const* b, size_t n);
+
+/// @brief Batch arithmetic over n contiguous elements, r[i] = a[i] * b[i], r may alias a or b.
+template <size_t K, bool S> requires detail::large<K>
+void mul_n(Z2<K, S>* r, Z2<K, S> const* a, Z2<K, S> const* b, size_t n);
+
 /// @brief Calculate the multiplicative inverse of a given unsigned binary integer.
 template <size_t K>
 UnsignedZ2<K> inv(UnsignedZ2<K> const& x);
@@ -617,6 +617,31 @@ std::strong_ordering Z2<K, S>::operator<=>(const Z2<K, S> &rhs) const
         return std::strong_ordering::greater;
 }
 
+/************************ batch arithmetic ************************/
+
+// an array of Z2<K> is a contiguous array of limbs, so the batch kernels run over the limbs directly
+
+template <size_t K, bool S> requires detail::large<K>
+void add_n(Z2<K, S>* r, Z2<K, S> const* a, Z2<K, S> const* b, size_t n)
+{
+    static_assert( sizeof(Z2<K, S>) == Z2<K, S>::size_in_bytes() );
+    detail::mpx2k_add_n<K>(r->data(), a->data(), b->data(), n);
+}
+
+template <size_t K, bool S> requires detail::large<K>
+void sub_n(Z2<K, S>* r, Z2<K, S> const* a, Z2<K, S> const* b, size_t n)
+{
+    static_assert( sizeof(Z2<K, S>) == Z2<K, S>::size_in_bytes() );
+    detail::mpx2k_sub_n<K>(r->data(), a->data(), b->data(), n);
+}
+
+template <size_t K, bool S> requires detail::large<K>
+void mul_n(Z2<K, S>* r, Z2<K, S> const* a, Z2<K, S> const* b, size_t n)
+{
+    static_assert( sizeof(Z2<K, S>) == Z2<K, S>::size_in_bytes() );
+    detail::mpx2k_mul_n<K>(r->data(), a->data(), b->data(), n);
+}
+
 /************************ math ************************/
 
 /// @brief Calculate the multiplicative inverse of a given unsigned binary integer.
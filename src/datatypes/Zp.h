@@ -13,9 +13,17 @@
 /// @brief The 'Zp' class represents a finite field whose modulus is prime,
 ///        and provides basic operations and operations on finite fields.
 /// @tparam N_BITS is a number of bits to represent the modulus p.
+/// @details Elements are stored in Montgomery form, so multiplication needs no division.
+///          The Mersenne primes 2^61 - 1 and 2^127 - 1 are detected by init and use a folding
+///          reduction on elements in standard form instead.
+///          The stored form is what gets serialized, all parties must init the same modulus.
 template <size_t N_BITS>
 class Zp {
 
+    template <size_t M> friend void add_n(Zp<M>*, Zp<M> const*, Zp<M> const*, size_t);
+    template <size_t M> friend void sub_n(Zp<M>*, Zp<M> const*, Zp<M> const*, size_t);
+    template <size_t M> friend void mul_n(Zp<M>*, Zp<M> const*, Zp<M> const*, size_t);
+
 protected:
 
     /// @details For an array of type mp_limb_t, the least significant byte 
@@ -24,8 +32,8 @@ protected:
     /// @brief N_LIMBS calculates the number of limbs required to represent N_BITS in bits.
     static constexpr std::size_t N_LIMBS = detail::ZP_LIMBS<N_BITS>;
 
-    /// @brief Modulus of the mp_limb_t array representation.
-    static mp_limb_t _modulus[N_LIMBS];
+    /// @brief Modulus of the mp_limb_t array representation, with the constants of its reductions.
+    static detail::ZpModulus<N_BITS> _modulus;
     /// @brief Modulus of the mpz_class representation.
     static mpz_class _modulus_class;
 
@@ -33,14 +41,31 @@ protected:
     /// @note only positive number, which is different from Z2k.
     mp_limb_t _data[N_LIMBS];
 
+    /// @brief rp = s1p * s2p for elements in stored form.
+    static void _mul(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p);
+
+    /// @brief Convert a value below the modulus from standard form into stored form.
+    static void _to_stored(mp_limb_t* rp, const mp_limb_t* sp);
+
+    /// @brief Convert an element from stored form into standard form.
+    static void _to_standard(mp_limb_t* rp, const mp_limb_t* sp);
+
 public:
     static constexpr bool trivially_serializable = true;
 
     /// @brief Initializes the modulus of a finite field.
-    ///        modulus is assigned to _modulus_class and _modulus[N_LIMBS].
+    ///        modulus is assigned to _modulus_class and _modulus, with the constants of its reductions.
     /// @param modulus The mpz_class representation
+    /// @note Elements created before a call of init are invalid afterwards.
     static void init(mpz_class const& modulus);
 
+    /// @brief Determine whether the modulus is a Mersenne prime reduced by folding.
+    static bool is_mersenne() { return _modulus.mersenne; }
+
+    /// @brief Return the multiplicative inverse.
+    /// @note Throws std::invalid_argument for zero.
+    Zp inv() const;
+
     ~Zp()                    = default;
     Zp(Zp&&)                 = default;
     Zp(const Zp&)            = default;
@@ -56,6 +81,11 @@ public:
     /// @brief Constructs finite field elements using strings and bases(default decimal).
     explicit Zp(std::string const&, int base = 10);
     
+    /// @brief Get the pointer of underlying data, in stored form.
+    /// @return The pointer of underlying data
+    mp_limb_t const* data() const { return _data; }
+    mp_limb_t*       data()       { return _data; }
+
     /// @brief Converts a finite field element to a string representation(default decimal).
     std::string to_string(int base = 10) const;
     /// @brief Converts a finite field element to an mpz_class type representation.
@@ -68,6 +98,7 @@ public:
     /// @brief Assigns to finite field elements using strings and bases(default decimal).
     void assign(std::string const&, int base);
 
+    Zp  operator- ()          const;
     Zp  operator+ (const Zp&) const;
     Zp  operator- (const Zp&) const;
     Zp  operator* (const Zp&) const;
@@ -86,3 +117,22 @@ public:
     std::strong_ordering operator<=>(const Zp&) const;
 
 };
+
+/// @brief Batch arithmetic over n contiguous elements, r[i] = a[i] + b[i], r may alias a or b.
+/// @note Found by argument dependent lookup from the element wise operations of ArrayRef.
+template <size_t N>
+void add_n(Zp<N>* r, Zp<N> const* a, Zp<N> const* b, size_t n);
+
+/// @brief Batch arithmetic over n contiguous elements, r[i] = a[i] - b[i], r may alias a or b.
+template <size_t N>
+void sub_n(Zp<N>* r, Zp<N> const* a, Zp<N> const* b, size_t n);
+
+/// @brief Batch arithmetic over n contiguous elements, r[i] = a[i] * b[i], r may alias a or b.
+template <size_t N>
+void mul_n(Zp<N>* r, Zp<N> const* a, Zp<N> const* b, size_t n);
+
+/// @brief Batch inversion over n contiguous elements, r[i] = 1 / a[i], r may alias a.
+/// @details Montgomery's trick: one inversion and 3(n - 1) multiplications.
+/// @note Throws std::invalid_argument if any element is zero.
+template <size_t N>
+void inv_n(Zp<N>* r, Zp<N> const* a, size_t n);
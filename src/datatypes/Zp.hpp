@@ -1,19 +1,20 @@
 #pragma once
 
 #include <stdexcept>
+#include <vector>
 
 #include "Zp.h"
 
-/// @brief Modulus of the mp_limb_t array representation.
+/// @brief Modulus of the mp_limb_t array representation, with the constants of its reductions.
 template <size_t N>
-mp_limb_t Zp<N>::_modulus[Zp<N>::N_LIMBS];
+detail::ZpModulus<N> Zp<N>::_modulus;
 
 /// @brief Modulus of the mpz_class representation.
 template <size_t N>
 mpz_class Zp<N>::_modulus_class;
 
 /// @brief Initializes the modulus of a finite field.
-///        modulus is assigned to _modulus_class and _modulus[N_LIMBS].
+///        modulus is assigned to _modulus_class and _modulus, with the constants of its reductions.
 /// @param modulus The mpz_class representation
 template <size_t N>
 void Zp<N>::init(mpz_class const& modulus) {
@@ -33,24 +34,83 @@ void Zp<N>::init(mpz_class const& modulus) {
         throw std::invalid_argument("modulus is not a prime");
     }
 
-    // Check whether modulus is prime
+    // Montgomery reduction needs an odd modulus
+    if( modulus == 2 ) {
+        throw std::invalid_argument("modulus must be odd");
+    }
+
     _modulus_class = modulus;
 
-    //Fill _modulus with word data from modulus.get_mpz_t().
-    mpz_export(
-        _modulus,
-        nullptr,
-        -1,
-        sizeof(mp_limb_t),
-        0, 0,
-        modulus.get_mpz_t()
-    );
+    // Fill limbs with word data from a value below 2^(N_LIMBS * 64), extra limbs are set to zero
+    auto export_limbs = [](mp_limb_t* rp, mpz_class const& val) {
+        std::size_t count = 0;
+        mpz_export(rp, &count, -1, sizeof(mp_limb_t), 0, 0, val.get_mpz_t());
+        mpn_zero(rp + count, N_LIMBS - count);
+    };
+
+    mpz_class R = mpz_class(1) << (N_LIMBS * detail::ZP_BITS_PER_LIMB);
+    mpz_class R2 = (R * R) % modulus;
+    mpz_class R3 = (R2 * R) % modulus;
+
+    export_limbs(_modulus.p,  modulus);
+    export_limbs(_modulus.r2, R2);
+    export_limbs(_modulus.r3, R3);
+
+    // -p^(-1) mod 2^64 by Newton iteration, each step doubles the number of correct bits
+    mp_limb_t p0  = _modulus.p[0];
+    mp_limb_t inv = p0;
+    for(int i = 0; i < 6; ++i)
+        inv *= 2 - p0 * inv;
+    _modulus.pinv = -inv;
+
+    if constexpr ( N <= 64 ) {
+        mpz_class mu = (mpz_class(1) << 64) / modulus;
+        export_limbs(&_modulus.barrett, mu);
+    }
 
+    _modulus.mersenne = detail::MERSENNE_CANDIDATE<N> && ( modulus == (mpz_class(1) << N) - 1 );
 }
 
+/************************ representation ************************/
+
+/// @brief rp = s1p * s2p for elements in stored form.
+template <size_t N>
+void Zp<N>::_mul(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p) {
+    if constexpr ( detail::MERSENNE_CANDIDATE<N> ) {
+        if( _modulus.mersenne ) {
+            detail::mpxp_mersenne_mul<N>(rp, s1p, s2p);
+            return;
+        }
+    }
+    detail::mpxp_mont_mul<N>(rp, s1p, s2p, _modulus);
+}
+
+/// @brief Convert a value below the modulus from standard form into stored form, x -> x * R.
+template <size_t N>
+void Zp<N>::_to_stored(mp_limb_t* rp, const mp_limb_t* sp) {
+    if( _modulus.mersenne ) {
+        mpn_copyi(rp, sp, N_LIMBS);
+    } else {
+        detail::mpxp_mont_mul<N>(rp, sp, _modulus.r2, _modulus);
+    }
+}
+
+/// @brief Convert an element from stored form into standard form, x * R -> x.
+template <size_t N>
+void Zp<N>::_to_standard(mp_limb_t* rp, const mp_limb_t* sp) {
+    if( _modulus.mersenne ) {
+        mpn_copyi(rp, sp, N_LIMBS);
+    } else {
+        mp_limb_t one[N_LIMBS] = { 1 };
+        detail::mpxp_mont_mul<N>(rp, sp, one, _modulus);
+    }
+}
+
+/************************ ctor, conversion ************************/
+
 /// @note All computation's correctness counts on correct input, thus proper initialization is required.
 template <size_t N>
-Zp<N>::Zp() { this->assign(0); }
+Zp<N>::Zp() { mpn_zero(_data, N_LIMBS); }
 
 /// @brief Constructs finite field elements using unsigned long integer values.
 template <size_t N>
@@ -67,14 +127,15 @@ Zp<N>::Zp(const std::string& str, int base) { this->assign(str, base); }
 /// @brief Assigns a value of type unsigned long to a finite field element. 
 template <size_t N>
 void Zp<N>::assign(unsigned long val) {
-    mpn_zero(_data, N_LIMBS);
+    mp_limb_t tp[N_LIMBS] = {};
 
-    // Check whether val is greater than modulus
+    // Reduce val below the modulus, only moduli of at most 64 bits can be exceeded
     if constexpr( N <= 64 ) {
-        val %= _modulus[0];
+        val = detail::mpxp_barrett_reduce<N>(val, _modulus);
     }
 
-    _data[0] = val;
+    tp[0] = val;
+    _to_stored(_data, tp);
 }
 
 /// @brief Assigns a value of type mpz_class to a finite field element.
@@ -105,9 +166,12 @@ void Zp<N>::assign(mpz_class const& val) {
         true_val
     );
 
+    mpz_clear(true_val);
+
     if( count > N_LIMBS )  throw "write too much";
     // set extra bits to zero
     mpn_zero(_data + count, N_LIMBS - count);
+    _to_stored(_data, _data);
 }
 
 /// @brief Assigns to finite field elements using strings and bases(default decimal).
@@ -129,6 +193,8 @@ std::string Zp<N>::to_string(int base) const {
 template <size_t N>
 mpz_class Zp<N>::to_mpz() const {
     mpz_class ans;
+    mp_limb_t tp[N_LIMBS];
+    _to_standard(tp, _data);
 
     // Set ans from an array of word data at _data.
     mpz_import(
@@ -137,77 +203,151 @@ mpz_class Zp<N>::to_mpz() const {
         -1,
         sizeof(mp_limb_t),
         0, 0,
-        _data
+        tp
     );
 
     return ans;
 }
 
+/************************ operators ************************/
+
+template <size_t N>
+Zp<N> Zp<N>::operator-() const {
+    Zp<N> ans;
+    detail::mpxp_neg<N>(ans._data, _data, _modulus.p);
+    return ans;
+}
+
 template <size_t N>
 Zp<N> Zp<N>::operator+(const Zp<N>& rhs) const {
     Zp<N> ans;
-    detail::mpxp_add<N>(ans._data, _data, rhs._data, _modulus);
+    detail::mpxp_add<N>(ans._data, _data, rhs._data, _modulus.p);
     return ans;
 }
 
 template <size_t N>
 Zp<N> Zp<N>::operator-(const Zp<N>& rhs) const {
     Zp<N> ans;
-    detail::mpxp_sub<N>(ans._data, _data, rhs._data, _modulus);
+    detail::mpxp_sub<N>(ans._data, _data, rhs._data, _modulus.p);
     return ans;
 }
 
 template <size_t N>
 Zp<N> Zp<N>::operator*(const Zp<N>& rhs) const {
     Zp<N> ans;
-    detail::mpxp_mul<N>(ans._data, _data, rhs._data, _modulus);
+    _mul(ans._data, _data, rhs._data);
     return ans;
 }
 
 template <size_t N>
 Zp<N> Zp<N>::operator/(const Zp<N>& rhs) const {
-    Zp<N> ans;
-    detail::mpxp_div<N>(ans._data, _data, rhs._data, _modulus);
-    return ans;
+    return *this * rhs.inv();
 }
 
 template <size_t N>
 Zp<N>& Zp<N>::operator+=(const Zp<N>& rhs) {
-    detail::mpxp_add<N>(_data, _data, rhs._data, _modulus);
+    detail::mpxp_add<N>(_data, _data, rhs._data, _modulus.p);
     return *this;
 }
 
 template <size_t N>
 Zp<N>& Zp<N>::operator-=(const Zp<N>& rhs) {
-    detail::mpxp_sub<N>(_data, _data, rhs._data, _modulus);
+    detail::mpxp_sub<N>(_data, _data, rhs._data, _modulus.p);
     return *this;
 }
 
 template <size_t N>
 Zp<N>& Zp<N>::operator*=(const Zp<N>& rhs) {
-    detail::mpxp_mul<N>(_data, _data, rhs._data, _modulus);
+    _mul(_data, _data, rhs._data);
     return *this;
 }
 
 template <size_t N>
 Zp<N>& Zp<N>::operator/=(const Zp<N>& rhs) {
-    detail::mpxp_div<N>(_data, _data, rhs._data, _modulus);
-    return *this;
+    return *this *= rhs.inv();
+}
+
+/// @brief Return the multiplicative inverse.
+/// @details In Montgomery form the inverse of x * R is x^(-1) * R^(-1), multiplying by R^3 restores x^(-1) * R.
+template <size_t N>
+Zp<N> Zp<N>::inv() const {
+    Zp<N> ans;
+    detail::mpxp_inv<N>(ans._data, _data, _modulus.p);
+    if( !_modulus.mersenne ) {
+        detail::mpxp_mont_mul<N>(ans._data, ans._data, _modulus.r3, _modulus);
+    }
+    return ans;
 }
 
 template <size_t N>
 bool Zp<N>::operator==(const Zp<N>& rhs) const {
-    return detail::mpxp_cmp<N>(_data, rhs._data, _modulus) == 0;
+    return detail::mpxp_cmp<N>(_data, rhs._data, _modulus.p) == 0;
 }
 
 /// @brief Compare this with input.
 /// @return if *this < param, return std::strong_ordering::less
 ///         if *this = param, return std::strong_ordering::equal
 ///         if *this > param, return std::strong_ordering::greater
+/// @note Elements are compared in standard form.
 template <size_t N>
 std::strong_ordering Zp<N>::operator<=>(const Zp<N>& rhs) const {
-    auto cmp = detail::mpxp_cmp<N>(_data, rhs._data, _modulus);
+    mp_limb_t lp[N_LIMBS], rp[N_LIMBS];
+    _to_standard(lp, _data);
+    _to_standard(rp, rhs._data);
+
+    auto cmp = detail::mpxp_cmp<N>(lp, rp, _modulus.p);
     if(cmp < 0)        return std::strong_ordering::less;
     else if(cmp == 0)  return std::strong_ordering::equal;
     else               return std::strong_ordering::greater;
 }
+
+/************************ batch arithmetic ************************/
+
+template <size_t N>
+void add_n(Zp<N>* r, Zp<N> const* a, Zp<N> const* b, size_t n) {
+    auto pp = Zp<N>::_modulus.p;
+    for(size_t i = 0; i < n; ++i)
+        detail::mpxp_add<N>(r[i].data(), a[i].data(), b[i].data(), pp);
+}
+
+template <size_t N>
+void sub_n(Zp<N>* r, Zp<N> const* a, Zp<N> const* b, size_t n) {
+    auto pp = Zp<N>::_modulus.p;
+    for(size_t i = 0; i < n; ++i)
+        detail::mpxp_sub<N>(r[i].data(), a[i].data(), b[i].data(), pp);
+}
+
+template <size_t N>
+void mul_n(Zp<N>* r, Zp<N> const* a, Zp<N> const* b, size_t n) {
+    if constexpr ( detail::MERSENNE_CANDIDATE<N> ) {
+        if( Zp<N>::_modulus.mersenne ) {
+            for(size_t i = 0; i < n; ++i)
+                detail::mpxp_mersenne_mul<N>(r[i].data(), a[i].data(), b[i].data());
+            return;
+        }
+    }
+    auto const& m = Zp<N>::_modulus;
+    for(size_t i = 0; i < n; ++i)
+        detail::mpxp_mont_mul<N>(r[i].data(), a[i].data(), b[i].data(), m);
+}
+
+/// @brief Batch inversion over n contiguous elements, r[i] = 1 / a[i], r may alias a.
+/// @details Montgomery's trick: prefix[i] = a[0] * ... * a[i], a single inversion of prefix[n - 1],
+///          then walking back 1 / a[i] = prefix[i - 1] / prefix[i] and 1 / prefix[i - 1] = a[i] / prefix[i].
+template <size_t N>
+void inv_n(Zp<N>* r, Zp<N> const* a, size_t n) {
+    if( n == 0 )  return;
+
+    std::vector<Zp<N>> prefix(n);
+    prefix[0] = a[0];
+    for(size_t i = 1; i < n; ++i)
+        prefix[i] = prefix[i - 1] * a[i];
+
+    Zp<N> acc = prefix[n - 1].inv();
+    for(size_t i = n - 1; i > 0; --i) {
+        Zp<N> ai = a[i];
+        r[i] = acc * prefix[i - 1];
+        acc *= ai;
+    }
+    r[0] = acc;
+}
@@ -92,6 +92,27 @@ void mpx2k_sub(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p);
 template <size_t K>
 void mpx2k_mul(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p);
 
+/// @brief rp[i] = (s1p[i] + s2p[i]) mod 2k for n contiguous values of N_LIMBS<K> limbs each.
+/// @param rp Pointer to the destination array for the results
+/// @param s1p @param s2p Pointer to the source arrays containing the input values
+/// @param n Number of values
+template <size_t K>
+void mpx2k_add_n(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, size_t n);
+
+/// @brief rp[i] = (s1p[i] - s2p[i]) mod 2k for n contiguous values of N_LIMBS<K> limbs each.
+/// @param rp Pointer to the destination array for the results
+/// @param s1p @param s2p Pointer to the source arrays containing the input values
+/// @param n Number of values
+template <size_t K>
+void mpx2k_sub_n(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, size_t n);
+
+/// @brief rp[i] = (s1p[i] * s2p[i]) mod 2k for n contiguous values of N_LIMBS<K> limbs each.
+/// @param rp Pointer to the destination array for the results
+/// @param s1p @param s2p Pointer to the source arrays containing the input values
+/// @param n Number of values
+template <size_t K>
+void mpx2k_mul_n(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, size_t n);
+
 /// @brief rp = (sp * sp) mod 2k.
 /// @param rp Pointer to the destination array for the result
 /// @param s1p @param s2p PointerPointer to the source array containing the input value
@@ -2,6 +2,11 @@
 
 #include <cmath>
 #include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 #include "mpx2k.h"
 
@@ -163,6 +168,107 @@ void mpx2k_one(mp_limb_t* rp) {
     memset(rp, 0xff, N_LIMBS<K> * sizeof(mp_limb_t));
 }
 
+/************************ fixed limb kernels ************************/
+
+/// @brief Values of up to FIXED_LIMBS_MAX limbs use the unrolled kernels below instead of mpn calls.
+constexpr size_t FIXED_LIMBS_MAX = 4;
+
+/// @brief Determine whether K bits are handled by the fixed limb kernels.
+template <size_t K>
+constexpr bool FIXED_LIMBS = ( N_LIMBS<K> <= FIXED_LIMBS_MAX );
+
+/// @brief *rp = a + b + c, return the carry out.
+inline unsigned char addcarry(unsigned char c, mp_limb_t a, mp_limb_t b, mp_limb_t* rp) {
+#if defined(__x86_64__)
+    unsigned long long r;
+    c   = _addcarry_u64(c, a, b, &r);
+    *rp = r;
+    return c;
+#else
+    mp_limb_t s  = a + c;
+    mp_limb_t c1 = (s < a);
+    *rp = s + b;
+    return c1 | (*rp < b);
+#endif
+}
+
+/// @brief *rp = a - b - c, return the borrow out.
+inline unsigned char subborrow(unsigned char c, mp_limb_t a, mp_limb_t b, mp_limb_t* rp) {
+#if defined(__x86_64__)
+    unsigned long long r;
+    c   = _subborrow_u64(c, a, b, &r);
+    *rp = r;
+    return c;
+#else
+    mp_limb_t d  = a - b;
+    mp_limb_t c1 = (a < b);
+    *rp = d - c;
+    return c1 | (d < c);
+#endif
+}
+
+/// @brief rp = s1p + s2p over N limbs, the carry chain is unrolled at compile time.
+/// @note rp may alias s1p or s2p.
+template <size_t N>
+[[gnu::always_inline]] inline void fixed_add(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p) {
+    unsigned char c = 0;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ( (c = addcarry(c, s1p[I], s2p[I], rp + I)), ... );
+    }(std::make_index_sequence<N>{});
+}
+
+/// @brief rp = s1p - s2p over N limbs, the borrow chain is unrolled at compile time.
+/// @note rp may alias s1p or s2p.
+template <size_t N>
+[[gnu::always_inline]] inline void fixed_sub(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p) {
+    unsigned char c = 0;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ( (c = subborrow(c, s1p[I], s2p[I], rp + I)), ... );
+    }(std::make_index_sequence<N>{});
+}
+
+/// @brief rp = -sp over N limbs.
+template <size_t N>
+[[gnu::always_inline]] inline void fixed_neg(mp_limb_t* rp, const mp_limb_t* sp) {
+    unsigned char c = 0;
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ( (c = subborrow(c, 0, sp[I], rp + I)), ... );
+    }(std::make_index_sequence<N>{});
+}
+
+/// @brief t[I..N) += s1p * b truncated to the low N limbs, one row of the schoolbook product.
+/// @details The top limb only needs the low half of a 64x64 multiplication.
+template <size_t N, size_t I>
+[[gnu::always_inline]] inline void fixed_mul_row(mp_limb_t* t, const mp_limb_t* s1p, mp_limb_t b) {
+    using wide_t = __uint128_t;
+    static_assert( sizeof(mp_limb_t) * 2 == sizeof(wide_t) );
+
+    mp_limb_t carry = 0;
+    [&]<size_t... J>(std::index_sequence<J...>) {
+        ( ( [&] {
+            wide_t p = static_cast<wide_t>(s1p[J]) * b + t[I + J] + carry;
+            t[I + J] = static_cast<mp_limb_t>(p);
+            carry    = static_cast<mp_limb_t>(p >> MP_BITS_PER_LIMB);
+        }() ), ... );
+    }(std::make_index_sequence<N - I - 1>{});
+    t[N - 1] += s1p[N - 1 - I] * b + carry;
+}
+
+/// @brief rp = s1p * s2p truncated to the low N limbs.
+/// @details Schoolbook product skipping every partial product above limb N - 1, fully unrolled
+///          at compile time so that the partial sums stay in registers.
+/// @note rp may alias s1p or s2p.
+template <size_t N>
+[[gnu::always_inline]] inline void fixed_mul(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p) {
+    mp_limb_t t[N] = {};
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        ( fixed_mul_row<N, I>(t, s1p, s2p[I]), ... );
+        ( (rp[I] = t[I]), ... );
+    }(std::make_index_sequence<N>{});
+}
+
+/************************ arithmetic ************************/
+
 /// @brief rp = (-sp) mod 2k.
 /// @param rp Pointer to the destination array for the result
 /// @param sp Pointer to the source array containing the input value
@@ -171,7 +277,11 @@ void mpx2k_neg(
     mp_limb_t*       rp,
     const mp_limb_t* sp
 ) {
-    mpn_neg(rp, sp, N_LIMBS<K>);
+    if constexpr ( FIXED_LIMBS<K> ) {
+        fixed_neg<N_LIMBS<K>>(rp, sp);
+    } else {
+        mpn_neg(rp, sp, N_LIMBS<K>);
+    }
     mpx2k_norm<K>(rp);
 }
 
@@ -184,7 +294,11 @@ void mpx2k_add(
     const mp_limb_t* s1p,
     const mp_limb_t* s2p
 ) {
-    mpn_add_n(rp, s1p, s2p, N_LIMBS<K>);
+    if constexpr ( FIXED_LIMBS<K> ) {
+        fixed_add<N_LIMBS<K>>(rp, s1p, s2p);
+    } else {
+        mpn_add_n(rp, s1p, s2p, N_LIMBS<K>);
+    }
     mpx2k_norm<K>(rp);
 }
 
@@ -197,7 +311,11 @@ void mpx2k_sub(
     const mp_limb_t* s1p,
     const mp_limb_t* s2p
 ) {
-    mpn_sub_n(rp, s1p, s2p, N_LIMBS<K>);
+    if constexpr ( FIXED_LIMBS<K> ) {
+        fixed_sub<N_LIMBS<K>>(rp, s1p, s2p);
+    } else {
+        mpn_sub_n(rp, s1p, s2p, N_LIMBS<K>);
+    }
     mpx2k_norm<K>(rp);
 }
 
@@ -210,16 +328,19 @@ void mpx2k_mul(
     const mp_limb_t* s1p,
     const mp_limb_t* s2p
 ) {
-    // an informal test suggests that option1 is slightly faster
-    constexpr size_t option = 1;
+    // fixed size values use the unrolled truncated product, larger ones the full mpn product truncated to K bits
+    constexpr size_t option = FIXED_LIMBS<K> ? 0 : 1;
 
-    if constexpr(option == 1) {
-        static mp_limb_t buffer[2*N_LIMBS<K>];
+    if constexpr(option == 0) {
+        fixed_mul<N_LIMBS<K>>(rp, s1p, s2p);
+    }
+    else if constexpr(option == 1) {
+        mp_limb_t buffer[2*N_LIMBS<K>];
         mpn_mul_n(buffer, s1p, s2p, N_LIMBS<K>);
         mpn_copyi(rp, buffer, N_LIMBS<K>);
     }
     else if constexpr (option == 2) {
-        static mp_limb_t buffer[N_LIMBS<K>];
+        mp_limb_t buffer[N_LIMBS<K>];
         mpn_zero(buffer, N_LIMBS<K>);
         for(size_t i = 0; i < N_LIMBS<K>; ++i) {
             mpn_addmul_1(buffer + i, s1p, N_LIMBS<K> - i, s2p[i]);
@@ -233,6 +354,36 @@ void mpx2k_mul(
     mpx2k_norm<K>(rp);
 }
 
+/// @brief rp[i] = (s1p[i] + s2p[i]) mod 2k for n contiguous values of N_LIMBS<K> limbs each.
+/// @param rp Pointer to the destination array for the results
+/// @param s1p @param s2p Pointer to the source arrays containing the input values
+/// @param n Number of values
+template <size_t K>
+void mpx2k_add_n(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, size_t n) {
+    for(size_t i = 0; i < n * N_LIMBS<K>; i += N_LIMBS<K>)
+        mpx2k_add<K>(rp + i, s1p + i, s2p + i);
+}
+
+/// @brief rp[i] = (s1p[i] - s2p[i]) mod 2k for n contiguous values of N_LIMBS<K> limbs each.
+/// @param rp Pointer to the destination array for the results
+/// @param s1p @param s2p Pointer to the source arrays containing the input values
+/// @param n Number of values
+template <size_t K>
+void mpx2k_sub_n(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, size_t n) {
+    for(size_t i = 0; i < n * N_LIMBS<K>; i += N_LIMBS<K>)
+        mpx2k_sub<K>(rp + i, s1p + i, s2p + i);
+}
+
+/// @brief rp[i] = (s1p[i] * s2p[i]) mod 2k for n contiguous values of N_LIMBS<K> limbs each.
+/// @param rp Pointer to the destination array for the results
+/// @param s1p @param s2p Pointer to the source arrays containing the input values
+/// @param n Number of values
+template <size_t K>
+void mpx2k_mul_n(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, size_t n) {
+    for(size_t i = 0; i < n * N_LIMBS<K>; i += N_LIMBS<K>)
+        mpx2k_mul<K>(rp + i, s1p + i, s2p + i);
+}
+
 /// @brief rp = s1p & s2p.
 /// @param rp Pointer to the destination array for the result
 /// @param s1p @param s2p PointerPointer to the source array containing the input value
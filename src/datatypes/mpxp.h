@@ -33,13 +33,6 @@ void mpxp_add(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, const m
 template <size_t N>
 void mpxp_sub(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, const mp_limb_t* pp);
 
-/// @brief rp = (s1p * s2p) mod pp.
-/// @param rp Pointer to the destination array for the result
-/// @param s1p @param s2p PointerPointer to the source array containing the input value
-/// @param pp Pointer to the source array containing the modulus
-template <size_t N>
-void mpxp_mul(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, const mp_limb_t* pp);
-
 /// @brief rp = (sp * sp) mod pp.
 /// @param rp Pointer to the destination array for the result
 /// @param sp Pointer to the source array containing the input value
@@ -54,13 +47,6 @@ void mpxp_sqr(mp_limb_t* rp, const mp_limb_t* sp, const mp_limb_t* pp);
 template <size_t N>
 void mpxp_inv(mp_limb_t* rp, const mp_limb_t* sp, const mp_limb_t* pp);
 
-/// @brief rp = (s1p / s2p) mod pp.
-/// @param rp Pointer to the destination array for the result
-/// @param s1p @param s2p PointerPointer to the source array containing the input value
-/// @param pp Pointer to the source array containing the modulus
-template <size_t N>
-void mpxp_div(mp_limb_t* rp, const mp_limb_t* s1p, const mp_limb_t* s2p, const mp_limb_t* pp);
-
 /// @brief return s1p <=> s2p.
 /// @param s1p @param s2p PointerPointer to the source array containing the input value
 /// @param pp Pointer to the source array containing the modulus
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <stdexcept>
+
 #include "../tools/math.h"
 
 #include "mpxp.h"
+#include "mpx2k.hpp"
 
 namespace detail
 {
@@ -12,6 +15,45 @@ constexpr size_t ZP_BITS_PER_LIMB = 8 * sizeof(mp_limb_t);
 template <size_t K>
 constexpr size_t ZP_LIMBS = ceildiv(K, ZP_BITS_PER_LIMB);
 
+/// @struct ZpModulus
+/// @brief Precomputed constants of a prime modulus p of N bits.
+/// @details Elements are kept in Montgomery form x * R mod p with R = 2^(ZP_BITS_PER_LIMB * ZP_LIMBS<N>),
+///          except for the Mersenne primes 2^61 - 1 and 2^127 - 1, whose elements are kept in standard form
+///          and reduced by folding the high half of a product onto the low half.
+template <size_t N>
+struct ZpModulus {
+    mp_limb_t p [ZP_LIMBS<N>];  // modulus
+    mp_limb_t r2[ZP_LIMBS<N>];  // R^2 mod p, converts into Montgomery form
+    mp_limb_t r3[ZP_LIMBS<N>];  // R^3 mod p, restores Montgomery form after an inversion
+    mp_limb_t pinv     = 0;     // -p^(-1) mod 2^ZP_BITS_PER_LIMB
+    mp_limb_t barrett  = 0;     // floor(2^64 / p), only for N <= 64
+    bool      mersenne = false; // p = 2^N - 1
+};
+
+/// @brief Determine whether N bits may hold a Mersenne prime with a folding fast path.
+template <size_t N>
+constexpr bool MERSENNE_CANDIDATE = (N == 61 || N == 127);
+
+/// @brief rp = tp - pp if the N limbs value hi:tp is at least pp, otherwise rp = tp.
+/// @param hi Carry limb above tp, requires hi:tp < 2 * pp
+template <size_t N>
+void mpxp_reduce_once(
+    mp_limb_t*       rp,
+    const mp_limb_t* tp,
+    mp_limb_t        hi,
+    const mp_limb_t* pp
+) {
+    mp_limb_t     up[ZP_LIMBS<N>];
+    unsigned char b = 0;
+    for(size_t i = 0; i < ZP_LIMBS<N>; ++i)
+        b = subborrow(b, tp[i], pp[i], up + i);
+
+    // select without a branch, the outcome is data dependent and unpredictable
+    mp_limb_t mask = mp_limb_t(0) - static_cast<mp_limb_t>(hi != 0 || b == 0);
+    for(size_t i = 0; i < ZP_LIMBS<N>; ++i)
+        rp[i] = (up[i] & mask) | (tp[i] & ~mask);
+}
+
 /// @brief rp = (-sp) mod pp.
 /// @param rp Pointer to the destination array for the result
 /// @param sp Pointer to the source array containing the input value
@@ -27,6 +69,8 @@ void mpxp_neg(
         // 0 <= sp < pp
         // (-sp) mod pp = pp - sp
         mpn_sub_n(rp, pp, sp, ZP_LIMBS<N>);
+    } else {
+        mpn_zero(rp, ZP_LIMBS<N>);
     }
 }
 
@@ -41,20 +85,13 @@ void mpxp_add(
     const mp_limb_t* s2p,
     const mp_limb_t* pp
 ) {
-    static mp_limb_t tp[ZP_LIMBS<N>];
-
-    //carry = (s1p + s2p) > 2^(ZP_LIMBS<N> * ZP_BITS_PER_LIMB) ?1:0
-    auto carry = mpn_add_n(rp, s1p, s2p, ZP_LIMBS<N>);
-    auto cmp   = mpn_cmp(rp, pp, ZP_LIMBS<N>);
+    mp_limb_t     tp[ZP_LIMBS<N>];
+    unsigned char c = 0;
+    for(size_t i = 0; i < ZP_LIMBS<N>; ++i)
+        c = addcarry(c, s1p[i], s2p[i], tp + i);
 
-    if(cmp < 0) {
-        /* do nothing */;
-    } else if(carry == 0) {
-        mpn_sub_n(rp, rp, pp, ZP_LIMBS<N>);
-    } else {
-        mpn_com(tp, pp, ZP_LIMBS<N>);  // potentially optimizable
-        mpn_add_n(rp, rp, tp, ZP_LIMBS<N>);
-    }
+    // s1p + s2p < 2 * pp, one conditional subtraction
+    mpxp_reduce_once<N>(rp, tp, c, pp);
 }
 
 /// @brief rp = (s1p - s2p) mod pp.
@@ -68,91 +105,150 @@ void mpxp_sub(
     const mp_limb_t* s2p,
     const mp_limb_t* pp
 ) {
-    static mp_limb_t tp[ZP_LIMBS<N>];
+    mp_limb_t     tp[ZP_LIMBS<N>];
+    unsigned char b = 0;
+    for(size_t i = 0; i < ZP_LIMBS<N>; ++i)
+        b = subborrow(b, s1p[i], s2p[i], tp + i);
 
-    auto cmp = mpn_cmp(s1p, s2p, ZP_LIMBS<N>);
-
-    if(cmp >= 0)
-        mpn_sub_n(rp, s1p, s2p, ZP_LIMBS<N>);
-    else {
-        // when s1p < s2p, (s1p - s2p) mod pp = pp - s2p + s1p
-        mpn_sub_n(tp, pp,  s2p, ZP_LIMBS<N>);
-        mpn_add_n(rp, tp,  s1p, ZP_LIMBS<N>);
-    }
+    // when s1p < s2p, (s1p - s2p) mod pp = s1p - s2p + pp, the carry out cancels the borrow
+    mp_limb_t     mask = mp_limb_t(0) - b;
+    unsigned char c    = 0;
+    for(size_t i = 0; i < ZP_LIMBS<N>; ++i)
+        c = addcarry(c, tp[i], pp[i] & mask, rp + i);
 }
 
-/// @brief rp = (s1p * s2p) mod pp.
-/// @param rp Pointer to the destination array for the result
-/// @param s1p @param s2p PointerPointer to the source array containing the input value
-/// @param pp Pointer to the source array containing the modulus
+/// @brief rp = (s1p * s2p / R) mod p, Montgomery multiplication.
+/// @param rp Pointer to the destination array for the result, may alias s1p or s2p
+/// @param s1p @param s2p Pointer to the source arrays containing values below p
+/// @param m Constants of the modulus
+/// @details Coarsely integrated operand scanning: each row of the product is followed by one
+///          reduction step, so the partial result never exceeds ZP_LIMBS<N> + 2 limbs.
 template <size_t N>
-void mpxp_mul(
-    mp_limb_t*       rp,
-    const mp_limb_t* s1p,
-    const mp_limb_t* s2p,
-    const mp_limb_t* pp
+void mpxp_mont_mul(
+    mp_limb_t*          rp,
+    const mp_limb_t*    s1p,
+    const mp_limb_t*    s2p,
+    ZpModulus<N> const& m
 ) {
-    static mp_limb_t qp[ZP_LIMBS<N>+1];
-    static mp_limb_t tp[2*ZP_LIMBS<N>];
+    using wide_t = __uint128_t;
+    constexpr size_t NL = ZP_LIMBS<N>;
 
-    // How does the performance compare with NTL_ZZ p?
-    mpn_mul_n(tp, s1p, s2p, ZP_LIMBS<N>);
-    // tp / pp = qp, tp % pp = rp
-    mpn_tdiv_qr(qp, rp, 0, tp, 2*ZP_LIMBS<N>, pp, ZP_LIMBS<N>);
+    mp_limb_t t[NL + 2] = {};
+
+    #pragma GCC unroll 8
+    for(size_t i = 0; i < NL; ++i) {
+        // t += s1p * s2p[i]
+        mp_limb_t c = 0;
+        #pragma GCC unroll 8
+        for(size_t j = 0; j < NL; ++j) {
+            wide_t x = static_cast<wide_t>(s1p[j]) * s2p[i] + t[j] + c;
+            t[j] = static_cast<mp_limb_t>(x);
+            c    = static_cast<mp_limb_t>(x >> ZP_BITS_PER_LIMB);
+        }
+        wide_t x = static_cast<wide_t>(t[NL]) + c;
+        t[NL]     = static_cast<mp_limb_t>(x);
+        t[NL + 1] = static_cast<mp_limb_t>(x >> ZP_BITS_PER_LIMB);
+
+        // t = (t + u * p) / 2^64, u is chosen such that the lowest limb vanishes
+        mp_limb_t u = t[0] * m.pinv;
+        x = static_cast<wide_t>(u) * m.p[0] + t[0];
+        c = static_cast<mp_limb_t>(x >> ZP_BITS_PER_LIMB);
+        #pragma GCC unroll 8
+        for(size_t j = 1; j < NL; ++j) {
+            x        = static_cast<wide_t>(u) * m.p[j] + t[j] + c;
+            t[j - 1] = static_cast<mp_limb_t>(x);
+            c        = static_cast<mp_limb_t>(x >> ZP_BITS_PER_LIMB);
+        }
+        x         = static_cast<wide_t>(t[NL]) + c;
+        t[NL - 1] = static_cast<mp_limb_t>(x);
+        t[NL]     = t[NL + 1] + static_cast<mp_limb_t>(x >> ZP_BITS_PER_LIMB);
+    }
+
+    // t < 2p
+    mpxp_reduce_once<N>(rp, t, t[NL], m.p);
 }
 
-/// @brief rp = (1 / sp) mod pp.
-/// @param rp Pointer to the destination array for the result
-/// @param sp Pointer to the source array containing the input value
-/// @param pp Pointer to the source array containing the modulus
-template <size_t N>
-void mpxp_inv(
+/// @brief rp = (s1p * s2p) mod (2^N - 1) for the Mersenne primes 2^61 - 1 and 2^127 - 1.
+/// @param rp Pointer to the destination array for the result, may alias s1p or s2p
+/// @param s1p @param s2p Pointer to the source arrays containing values below 2^N - 1
+/// @details The product is split at bit N and both halves are added, since 2^N = 1 mod p.
+template <size_t N> requires MERSENNE_CANDIDATE<N>
+void mpxp_mersenne_mul(
     mp_limb_t*       rp,
-    const mp_limb_t* ap,
-    const mp_limb_t* pp
+    const mp_limb_t* s1p,
+    const mp_limb_t* s2p
 ) {
-    static mp_limb_t gp[ZP_LIMBS<N>];
-    static mp_limb_t up[ZP_LIMBS<N>];
-    static mp_limb_t vp[ZP_LIMBS<N>];
-    static mp_limb_t sp[ZP_LIMBS<N>+1];  // The manual says we need one more.
+    using wide_t = __uint128_t;
 
-    mp_size_t sn;
+    if constexpr ( ZP_LIMBS<N> == 1 ) {
+        constexpr mp_limb_t P = (mp_limb_t(1) << N) - 1;
 
-    // Because gcdext modifies the parameters passed in, a copy is required.
-    mpn_copyi(up, ap, ZP_LIMBS<N>);
-    mpn_copyi(vp, pp, ZP_LIMBS<N>);
+        wide_t    x = static_cast<wide_t>(s1p[0]) * s2p[0];
+        mp_limb_t r = (static_cast<mp_limb_t>(x) & P) + static_cast<mp_limb_t>(x >> N);
+        rp[0] = (r >= P) ? r - P : r;
+    } else {
+        constexpr wide_t P = (wide_t(1) << N) - 1;
 
-    // The mpn_gcdext function calculates the gcd by up and vp and stores the result in the array gp. 
-    // sp is the coefficient of up, sn is a Pointer to the number of limbs of sp.
-    mpn_gcdext(gp, sp, &sn, up, ZP_LIMBS<N>, vp, ZP_LIMBS<N>);
+        // 256 bit product r3:r2:r1:r0 of two 128 bit values
+        wide_t p00 = static_cast<wide_t>(s1p[0]) * s2p[0];
+        wide_t p01 = static_cast<wide_t>(s1p[0]) * s2p[1];
+        wide_t p10 = static_cast<wide_t>(s1p[1]) * s2p[0];
+        wide_t p11 = static_cast<wide_t>(s1p[1]) * s2p[1];
 
-    // When sn < 0, rp is negative, mod p operation is required.
-    if(sn < 0) {
-        sn = -sn;
-        mpn_sub(rp, pp, ZP_LIMBS<N>, sp, sn);
-    } else {
-        mpn_copyi(rp, sp, sn);
-        // The high level of the rp is set to 0
-        mpn_zero(rp + sn, ZP_LIMBS<N> - sn);
+        wide_t mid = (p00 >> 64) + static_cast<mp_limb_t>(p01) + static_cast<mp_limb_t>(p10);
+        wide_t top = (mid >> 64) + (p01 >> 64) + (p10 >> 64) + p11;
+
+        wide_t lo = (mid << 64) | static_cast<mp_limb_t>(p00);
+        wide_t hi = (top << 1) | (lo >> 127);
+
+        wide_t r = (lo & P) + hi;
+        r = (r >= P) ? r - P : r;
+        rp[0] = static_cast<mp_limb_t>(r);
+        rp[1] = static_cast<mp_limb_t>(r >> 64);
     }
+}
+
+/// @brief Reduce a single limb value modulo p with a precomputed reciprocal, avoiding a division.
+/// @param x Value to be reduced
+/// @param m Constants of the modulus, requires N <= 64
+/// @return x mod p
+/// @details q = floor(x * floor(2^64 / p) / 2^64) underestimates x / p by less than 2, so x - q * p < 2p.
+template <size_t N> requires (N <= 64)
+mp_limb_t mpxp_barrett_reduce(mp_limb_t x, ZpModulus<N> const& m)
+{
+    using wide_t = __uint128_t;
 
+    mp_limb_t q = static_cast<mp_limb_t>( (static_cast<wide_t>(x) * m.barrett) >> ZP_BITS_PER_LIMB );
+    mp_limb_t r = x - q * m.p[0];
+    return (r >= m.p[0]) ? r - m.p[0] : r;
 }
 
-/// @brief rp = (s1p / s2p) mod pp.
+/// @brief rp = (1 / sp) mod pp.
 /// @param rp Pointer to the destination array for the result
-/// @param s1p @param s2p PointerPointer to the source array containing the input value
+/// @param sp Pointer to the source array containing the input value
 /// @param pp Pointer to the source array containing the modulus
 template <size_t N>
-void mpxp_div(
+void mpxp_inv(
     mp_limb_t*       rp,
-    const mp_limb_t* s1p,
-    const mp_limb_t* s2p,
+    const mp_limb_t* ap,
     const mp_limb_t* pp
 ) {
-    static mp_limb_t tp[ZP_LIMBS<N>];
+    mpz_t a, p, r;
+    mpz_init(r);
+
+    // read only views of the limbs, no copy
+    mpz_roinit_n(a, ap, ZP_LIMBS<N>);
+    mpz_roinit_n(p, pp, ZP_LIMBS<N>);
+
+    if( mpz_invert(r, a, p) == 0 ) {
+        mpz_clear(r);
+        throw std::invalid_argument("inverse of zero");
+    }
 
-    mpxp_inv<N>(tp, s2p, pp);
-    mpxp_mul<N>(rp, s1p, tp, pp);
+    size_t count = 0;
+    mpz_export(rp, &count, -1, sizeof(mp_limb_t), 0, 0, r);
+    mpn_zero(rp + count, ZP_LIMBS<N> - count);
+    mpz_clear(r);
 }
 
 /// @brief Return s1p <=> s2p.
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "network/profile.h"
+
+#include "example/utils.h"
+#include "example/utils.hpp"
+
+#include <benchmark/benchmark.h>
+
+/// @brief First port of the loopback parties, parties of n players listen on LOOPBACK_BASE_PORT + 16 * n + pid.
+inline constexpr int LOOPBACK_BASE_PORT = 17777;
+
+/// @brief Sizes of the array benchmarks, as log2 of the number of elements.
+inline constexpr int64_t BENCHMARK_MIN_LOG_NUMEL = 10;
+inline constexpr int64_t BENCHMARK_MAX_LOG_NUMEL = 16;
+
+/// @class LoopbackParties
+/// @brief Parties of one process, connected over loopback and kept alive for every benchmark of the binary.
+/// @details Party 0 runs in the calling thread, so the benchmark loop times it. The other parties wait in
+///          their own thread and run every job posted by run() in lockstep with party 0.
+class LoopbackParties
+{
+public:
+    using Job = std::function<void(pppu::Context*)>;
+
+    LoopbackParties(LoopbackParties const&)            = delete;
+    LoopbackParties& operator=(LoopbackParties const&) = delete;
+
+    /// @brief Constructor, connect num_parties parties on the given ports.
+    /// @param num_parties Number of parties
+    /// @param base_port Port of party 0, party i listens on base_port + i
+    LoopbackParties(std::size_t num_parties, int base_port)
+        : _contexts(num_parties)
+    {
+        if( num_parties == 0 )
+            throw std::invalid_argument("at least one party is required");
+
+        // every player blocks in connect() until all of them are up
+        std::vector<std::thread> connecting;
+        for(std::size_t pid = 0; pid < num_parties; ++pid) {
+            connecting.emplace_back([this, pid, num_parties, base_port] {
+                auto netio = make_netio(pid, num_parties, "", base_port);
+                auto [prot, prep] = make_protocol<mpc::Semi2k, mpc::Semi2kTriple>(netio.get());
+                _contexts[pid] = make_context(make_config(3, 40), std::move(prot), std::move(prep), std::move(netio));
+            });
+        }
+        for(auto& t: connecting)
+            t.join();
+
+        for(std::size_t pid = 1; pid < num_parties; ++pid)
+            _workers.emplace_back([this, pid] { work(pid); });
+    }
+
+    /// @brief Destructor, stop the waiting parties.
+    ~LoopbackParties()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _posted.notify_all();
+        for(auto& t: _workers)
+            t.join();
+    }
+
+    /// @brief Get the parties of a size, connected at the first call.
+    /// @param num_parties Number of parties
+    /// @return Parties shared by every benchmark of the binary
+    static LoopbackParties& get(std::size_t num_parties)
+    {
+        static std::map<std::size_t, std::unique_ptr<LoopbackParties>> parties;
+        auto& ans = parties[num_parties];
+        if( !ans )
+            ans = std::make_unique<LoopbackParties>(num_parties, LOOPBACK_BASE_PORT + 16 * static_cast<int>(num_parties));
+        return *ans;
+    }
+
+    /// @brief Return the number of parties.
+    std::size_t num_parties() const { return _contexts.size(); }
+
+    /// @brief Return the context of a party.
+    pppu::Context* context(std::size_t pid) const { return _contexts.at(pid).get(); }
+
+    /// @brief Run a job on every party and wait for all of them.
+    /// @param job Function called with the context of each party, party 0 runs in the calling thread
+    /// @note The first exception thrown by a party is rethrown.
+    void run(Job const& job)
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _job     = &job;
+            _pending = _workers.size();
+            ++_generation;
+        }
+        _posted.notify_all();
+
+        std::exception_ptr error;
+        try {
+            job(_contexts[0].get());
+        } catch(...) {
+            error = std::current_exception();
+        }
+
+        std::unique_lock lock(_mutex);
+        _finished.wait(lock, [this] { return _pending == 0; });
+        if( !error )
+            error = std::exchange(_error, nullptr);
+        if( error )
+            std::rethrow_exception(error);
+    }
+
+    /// @brief Run a function on every party and collect the results.
+    /// @param fn Function called with the context of each party
+    /// @return Results indexed by party id
+    template <typename F>
+    auto map(F&& fn)
+    {
+        using R = std::invoke_result_t<F&, pppu::Context*>;
+        // results such as arrays have no default constructor
+        std::vector<std::optional<R>> results(num_parties());
+        run([&](pppu::Context* ctx) { results[ctx->pid()].emplace( fn(ctx) ); });
+
+        std::vector<R> ans;
+        for(auto& x: results)
+            ans.push_back( std::move(*x) );
+        return ans;
+    }
+
+private:
+    std::vector<std::shared_ptr<pppu::Context>> _contexts;
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _posted;
+    std::condition_variable _finished;
+    Job const* _job = nullptr;
+    uint64_t _generation = 0;
+    std::size_t _pending = 0;
+    bool _stop = false;
+    std::exception_ptr _error;
+
+    void work(std::size_t pid)
+    {
+        uint64_t seen = 0;
+        while( true ) {
+            std::unique_lock lock(_mutex);
+            _posted.wait(lock, [&] { return _stop || _generation != seen; });
+            if( _stop )
+                return;
+            seen = _generation;
+            Job const* job = _job;
+            lock.unlock();
+
+            std::exception_ptr error;
+            try {
+                (*job)(_contexts[pid].get());
+            } catch(...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            if( error && !_error )
+                _error = error;
+            if( --_pending == 0 )
+                _finished.notify_one();
+        }
+    }
+};
+
+/// @brief Set the elements per second counter of a benchmark.
+/// @param state Benchmark state, after the benchmark loop
+/// @param numel Number of elements processed by one iteration
+inline void set_throughput_counters(benchmark::State& state, int64_t numel)
+{
+    state.counters["elems_per_sec"] = benchmark::Counter(static_cast<double>(numel), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+/// @brief Network profile emulated by the loopback parties, set by --network_profile on the command line.
+inline network::NetworkProfile& loopback_profile()
+{
+    static network::NetworkProfile profile = network::find_network_profile("none");
+    return profile;
+}
+
+/// @brief Cost of one job of party 0.
+struct JobCost {
+    double rounds;  // communication rounds, see Statistics::rounds
+    double bytes;   // bytes sent to all the other parties
+};
+
+/// @brief Time a job of every party and set the rounds, bytes per element and elements per second counters.
+/// @param state Benchmark state
+/// @param parties Parties running the job
+/// @param numel Number of elements processed by one job
+/// @param job Function called with the context of each party
+/// @param profile Network profile emulated while running the job
+/// @return Average cost of one job
+/// @note Rounds and bytes are those of party 0, bytes are the bytes it sends to all the other parties.
+///       With an emulated profile, the modelled latency and transfer times of a job are reported too,
+///       the larger one labels the case round-bound or bandwidth-bound.
+inline JobCost run_parties(benchmark::State& state, LoopbackParties& parties, int64_t numel, LoopbackParties::Job const& job,
+                           network::NetworkProfile const& profile = loopback_profile())
+{
+    for(std::size_t pid = 0; pid < parties.num_parties(); ++pid)
+        apply_network_profile(parties.context(pid), profile);
+
+    auto netio = parties.context(0)->netio_p();
+    auto total_bytes = [](network::Statistics const& stat) {
+        std::size_t ans = 0;
+        for(auto bytes: stat.bytes_send)
+            ans += bytes;
+        return ans;
+    };
+
+    auto before = netio->get_statistics();
+    for(auto _: state)
+        parties.run(job);
+    auto after  = netio->get_statistics();
+
+    double iterations = static_cast<double>(state.iterations());
+    JobCost cost{
+        static_cast<double>(after.rounds - before.rounds) / iterations,
+        static_cast<double>(total_bytes(after) - total_bytes(before)) / iterations
+    };
+    state.counters["rounds"]         = cost.rounds;
+    state.counters["bytes_per_elem"] = cost.bytes / static_cast<double>(numel);
+    set_throughput_counters(state, numel);
+
+    if( profile.rtt != network::NetworkProfile::DurationType::zero()
+     || profile.bitrate != network::NetworkProfile::BitrateType::unlimited() ) {
+        // party 0 sends to the other parties over separate links in parallel
+        double links = static_cast<double>(parties.num_parties() - 1);
+        std::chrono::duration<double, std::milli> latency  = profile.latency(cost.rounds);
+        std::chrono::duration<double, std::milli> transfer = profile.transfer(cost.bytes / links);
+        state.counters["latency_ms"]  = latency.count();
+        state.counters["transfer_ms"] = transfer.count();
+        state.SetLabel( latency >= transfer ? "round-bound" : "bandwidth-bound" );
+    }
+    return cost;
+}
+
+/// @brief Make an array of uniformly random ring elements.
+/// @param numel Number of elements
+/// @param seed Seed of the generator, parties use their id so they hold different shares
+template <typename dtype>
+core::ArrayRef<dtype> random_array(int64_t numel, uint64_t seed = 0)
+{
+    std::mt19937_64 gen(seed);
+    auto ans = core::make_array<dtype>(numel);
+    for(int64_t i = 0; i < numel; ++i)
+        ans[i] = dtype( static_cast<unsigned long>(gen()) );
+    return ans;
+}
+
+/// @brief Make a vector of uniformly random doubles.
+/// @param numel Number of elements
+/// @param lo Lower bound of the values
+/// @param hi Upper bound of the values
+inline std::vector<double> random_doubles(int64_t numel, double lo, double hi)
+{
+    std::mt19937_64 gen(0);
+    std::uniform_real_distribution<double> dis(lo, hi);
+    std::vector<double> ans(numel);
+    for(auto& x: ans)
+        x = dis(gen);
+    return ans;
+}
+
+/// @brief Arguments of the multi party benchmarks, {number of parties, log2 of the number of elements}.
+inline void party_args(benchmark::internal::Benchmark* b)
+{
+    for(int64_t parties: {2, 3})
+        for(int64_t n = BENCHMARK_MIN_LOG_NUMEL; n <= BENCHMARK_MAX_LOG_NUMEL; n += 3)
+            b->Args({parties, n});
+    b->ArgNames({"parties", "log_numel"})->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+/// @brief Arguments of the local benchmarks, {log2 of the number of elements}.
+inline void local_args(benchmark::internal::Benchmark* b)
+{
+    for(int64_t n = BENCHMARK_MIN_LOG_NUMEL; n <= BENCHMARK_MAX_LOG_NUMEL; n += 3)
+        b->Args({n});
+    b->ArgNames({"log_numel"})->Unit(benchmark::kMicrosecond);
+}
+
+/// @brief Remove a flag of the form --name=value or --name from the arguments.
+/// @param name Name of the flag
+/// @return Value of the flag, empty for --name, or nullopt if the flag is not given
+inline std::optional<std::string> take_flag(int& argc, char** argv, std::string const& name)
+{
+    std::optional<std::string> ans;
+    std::string flag = "--" + name;
+    int kept = 1;
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if( arg == flag )
+            ans = "";
+        else if( arg.rfind(flag + "=", 0) == 0 )
+            ans = arg.substr(flag.size() + 1);
+        else
+            argv[kept++] = argv[i];
+    }
+    argc = kept;
+    return ans;
+}
+
+/// @brief Parse the flags of the benchmarks, --network_profile=<spec> sets the profile of the loopback parties,
+///        see network::parse_network_profile, the remaining flags are those of google benchmark.
+/// @return If the remaining flags are valid, return true
+inline bool init_benchmark(int& argc, char** argv)
+{
+    if( auto spec = take_flag(argc, argv, "network_profile") )
+        loopback_profile() = network::parse_network_profile(*spec);
+    benchmark::Initialize(&argc, argv);
+    return !benchmark::ReportUnrecognizedArguments(argc, argv);
+}
+
+/// @brief main() of the benchmarks, BENCHMARK_MAIN with the flags of init_benchmark.
+#define PPPU_BENCHMARK_MAIN()                       \
+int main(int argc, char** argv)                     \
+{                                                   \
+    if( !init_benchmark(argc, argv) )               \
+        return 1;                                   \
+    benchmark::RunSpecifiedBenchmarks();            \
+    benchmark::Shutdown();                          \
+    return 0;                                       \
+}
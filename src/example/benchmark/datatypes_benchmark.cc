@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <string>
+
+#include "datatypes/Z2k.hpp"
+#include "datatypes/Zp.hpp"
+#include "ndarray/array_ref.hpp"
+#include "ndarray/operations.hpp"
+
+#include "example/benchmark/benchmark_utils.h"
+
+/// @brief Benchmarks of the ring and field element types, scalar loops and ArrayRef kernels.
+
+using Z64  = Z2<64, true>;
+using Z128 = Z2<128, true>;
+using P61  = Zp<61>;
+using P127 = Zp<127>;
+using P255 = Zp<255>;
+
+/// @brief Initialize the moduli of the field benchmarks, the Mersenne primes and the prime 2^255 - 19.
+static void init_moduli()
+{
+    P61::init( (mpz_class(1) << 61) - 1 );
+    P127::init( (mpz_class(1) << 127) - 1 );
+    P255::init( (mpz_class(1) << 255) - 19 );
+}
+
+/// @brief Dependent chain of scalar multiply-adds, measures the latency of one element operation.
+template <typename dtype>
+static void BM_ScalarMulAdd(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(0);
+    auto in = random_array<dtype>(numel, 1);
+    dtype acc(1ul);
+    for(auto _: state) {
+        for(int64_t i = 0; i < numel; ++i)
+            acc = acc * in[i] + in[i];
+        benchmark::DoNotOptimize(acc);
+    }
+    set_throughput_counters(state, numel);
+}
+
+template <typename dtype>
+static void BM_ArrayAdd(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(0);
+    auto lhs = random_array<dtype>(numel, 1);
+    auto rhs = random_array<dtype>(numel, 2);
+    for(auto _: state)
+        benchmark::DoNotOptimize( core::add(lhs, rhs) );
+    set_throughput_counters(state, numel);
+}
+
+template <typename dtype>
+static void BM_ArrayMul(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(0);
+    auto lhs = random_array<dtype>(numel, 1);
+    auto rhs = random_array<dtype>(numel, 2);
+    for(auto _: state)
+        benchmark::DoNotOptimize( core::mul(lhs, rhs) );
+    set_throughput_counters(state, numel);
+}
+
+template <typename dtype>
+static void BM_ArrayInv(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(0);
+    auto in  = random_array<dtype>(numel, 1);
+    auto out = core::make_array<dtype>(numel);
+    for(auto _: state) {
+        inv_n(out.data(), in.data(), numel);
+        benchmark::DoNotOptimize( out.data() );
+    }
+    set_throughput_counters(state, numel);
+}
+
+BENCHMARK_TEMPLATE(BM_ScalarMulAdd, Z64) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ScalarMulAdd, Z128)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ScalarMulAdd, P61) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ScalarMulAdd, P127)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ScalarMulAdd, P255)->Apply(local_args);
+
+BENCHMARK_TEMPLATE(BM_ArrayAdd, Z64) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayAdd, Z128)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayAdd, P61) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayAdd, P127)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayAdd, P255)->Apply(local_args);
+
+BENCHMARK_TEMPLATE(BM_ArrayMul, Z64) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayMul, Z128)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayMul, P61) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayMul, P127)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayMul, P255)->Apply(local_args);
+
+BENCHMARK_TEMPLATE(BM_ArrayInv, P61) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayInv, P127)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_ArrayInv, P255)->Apply(local_args);
+
+int main(int argc, char** argv)
+{
+    init_moduli();
+    benchmark::Initialize(&argc, argv);
+    if( benchmark::ReportUnrecognizedArguments(argc, argv) )
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <cstdint>
+#include <vector>
+
+// div, exp and sigmoid come with the example utilities
+#include "example/benchmark/benchmark_utils.h"
+
+#include "context/shape/sort.hpp"
+
+/// @brief Benchmarks of the context math functions on secret shared fixed point values.
+
+using Value = pppu::Value<mpc::Semi2k, Z2<128, true>, Z2<128, true>>;
+
+/// @brief Secret share random values of [lo, hi) as every party's input of a benchmark.
+static std::vector<Value> random_shares(LoopbackParties& parties, int64_t numel, double lo, double hi)
+{
+    auto data = random_doubles(numel, lo, hi);
+    return parties.map([&](pppu::Context* ctx) {
+        return make_value_vec<std::vector<double>, Value>(ctx, ctx->pid(), data, pppu::Visibility::Share(), -1);
+    });
+}
+
+static void BM_Div(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(1);
+    auto& parties = LoopbackParties::get(state.range(0));
+    auto a = random_shares(parties, numel, -16.0, 16.0);
+    auto b = random_shares(parties, numel, 0.5, 16.0);
+    run_parties(state, parties, numel, [&](pppu::Context* ctx) {
+        benchmark::DoNotOptimize( pppu::div(ctx, a[ctx->pid()], b[ctx->pid()]) );
+    });
+}
+
+static void BM_Exp(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(1);
+    auto& parties = LoopbackParties::get(state.range(0));
+    auto x = random_shares(parties, numel, -4.0, 4.0);
+    run_parties(state, parties, numel, [&](pppu::Context* ctx) {
+        benchmark::DoNotOptimize( pppu::exp(ctx, x[ctx->pid()]) );
+    });
+}
+
+static void BM_Sigmoid(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(1);
+    auto& parties = LoopbackParties::get(state.range(0));
+    auto x = random_shares(parties, numel, -4.0, 4.0);
+    run_parties(state, parties, numel, [&](pppu::Context* ctx) {
+        benchmark::DoNotOptimize( pppu::sigmoid(ctx, x[ctx->pid()]) );
+    });
+}
+
+static void BM_Sort(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(1);
+    auto& parties = LoopbackParties::get(state.range(0));
+    auto x = random_shares(parties, numel, -1024.0, 1024.0);
+    run_parties(state, parties, numel, [&](pppu::Context* ctx) {
+        benchmark::DoNotOptimize( pppu::sort(ctx, x[ctx->pid()]) );
+    });
+}
+
+/// @brief Arguments of the math benchmarks, iterative functions are run on fewer elements.
+static void math_args(benchmark::internal::Benchmark* b)
+{
+    for(int64_t parties: {2, 3})
+        for(int64_t n: {6, 10, 14})
+            b->Args({parties, n});
+    b->ArgNames({"parties", "log_numel"})->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+/// @brief Arguments of the sort benchmark, a sorting network needs O(n log^2 n) comparisons.
+static void sort_args(benchmark::internal::Benchmark* b)
+{
+    for(int64_t parties: {2, 3})
+        for(int64_t n: {4, 7, 10})
+            b->Args({parties, n});
+    b->ArgNames({"parties", "log_numel"})->UseRealTime()->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_Div)    ->Apply(math_args);
+BENCHMARK(BM_Exp)    ->Apply(math_args);
+BENCHMARK(BM_Sigmoid)->Apply(math_args);
+BENCHMARK(BM_Sort)   ->Apply(sort_args);
+
+PPPU_BENCHMARK_MAIN()
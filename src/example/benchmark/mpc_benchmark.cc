@@ -0,0 +1,107 @@
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "datatypes/Z2k.hpp"
+#include "mpc/semi2k/semi2k.hpp"
+
+#include "example/benchmark/benchmark_utils.h"
+
+/// @brief Benchmarks of the Semi2k primitives on shares, called on the protocol directly without the Value layers.
+/// @details With --network_sweep, every primitive is run under each emulated network profile but none, and
+///          labelled round-bound or bandwidth-bound, e.g. msb_s, bitdec_s and eqz_s are dominated by the rounds of
+///          their ripple carry adder while large mul_ss are dominated by the bytes of their openings.
+
+using Z64 = Z2<64, true>;
+using Shares = core::ArrayRef<Z64>;
+using Primitive = void (*)(benchmark::State&, network::NetworkProfile const&);
+
+/// @brief Fracbits of the truncations.
+inline constexpr std::size_t TRUNC_BITS = 40;
+
+/// @brief Run a Semi2k primitive on random shares of every party.
+/// @param fn Function called with the protocol and the shares of a party
+template <typename F>
+static void run_semi2k(benchmark::State& state, network::NetworkProfile const& profile, int64_t numel, F&& fn)
+{
+    auto& parties = LoopbackParties::get(state.range(0));
+    auto shares = parties.map([numel](pppu::Context* ctx) {
+        return random_array<Z64>(numel, ctx->pid());
+    });
+    run_parties(state, parties, numel, [&](pppu::Context* ctx) {
+        fn(ctx->prot<mpc::Semi2k>(), shares[ctx->pid()]);
+    }, profile);
+}
+
+#define SEMI2K_BENCHMARK(name, expr)                                                                  \
+static void BM_Semi2k_##name(benchmark::State& state, network::NetworkProfile const& profile)         \
+{                                                                                                     \
+    run_semi2k(state, profile, int64_t(1) << state.range(1), [](mpc::Semi2k* prot, Shares const& x) { \
+        benchmark::DoNotOptimize( expr );                                                             \
+    });                                                                                               \
+}
+
+SEMI2K_BENCHMARK(open_s,       prot->open_s(x))
+SEMI2K_BENCHMARK(mul_ss,       prot->mul_ss(x, x))
+SEMI2K_BENCHMARK(square_s,     prot->square_s(x))
+SEMI2K_BENCHMARK(trunc_s,      prot->trunc_s(x, TRUNC_BITS))
+SEMI2K_BENCHMARK(msb_s,        prot->msb_s(x))
+SEMI2K_BENCHMARK(eqz_s,        prot->eqz_s(x))
+SEMI2K_BENCHMARK(bitdec_s,     prot->bitdec_s(x, 64))
+
+/// @brief Product of a (numel / 64) x 64 and a 64 x 64 share matrix, elements are those of the left operand.
+static void BM_Semi2k_matmul_ss(benchmark::State& state, network::NetworkProfile const& profile)
+{
+    int64_t numel = int64_t(1) << state.range(1);
+    auto& parties = LoopbackParties::get(state.range(0));
+    auto shares = parties.map([numel](pppu::Context* ctx) {
+        return std::make_pair( random_array<Z64>(numel, ctx->pid()), random_array<Z64>(64 * 64, ctx->pid() + 16) );
+    });
+    run_parties(state, parties, numel, [&](pppu::Context* ctx) {
+        auto const& [lhs, rhs] = shares[ctx->pid()];
+        benchmark::DoNotOptimize( ctx->prot<mpc::Semi2k>()->matmul_ss(lhs, rhs, numel / 64, 64, 64) );
+    }, profile);
+}
+
+static const std::vector<std::pair<std::string, Primitive>> PRIMITIVES = {
+    { "open_s",       BM_Semi2k_open_s       },
+    { "mul_ss",       BM_Semi2k_mul_ss       },
+    { "square_s",     BM_Semi2k_square_s     },
+    { "trunc_s",      BM_Semi2k_trunc_s      },
+    { "msb_s",        BM_Semi2k_msb_s        },
+    { "eqz_s",        BM_Semi2k_eqz_s        },
+    { "bitdec_s",     BM_Semi2k_bitdec_s     },
+    { "matmul_ss",    BM_Semi2k_matmul_ss    },
+};
+
+/// @brief Register a primitive under a network profile.
+static void register_primitive(std::string const& name, Primitive fn, network::NetworkProfile const& profile, bool sweep)
+{
+    std::string full_name = "BM_Semi2k_" + name + (sweep ? "/" + profile.name : "");
+    benchmark::RegisterBenchmark(full_name.c_str(), [fn, profile](benchmark::State& state) {
+        fn(state, profile);
+    })->Apply(party_args);
+}
+
+/// @brief Besides the flags of init_benchmark, --network_sweep runs every primitive under each network profile.
+int main(int argc, char** argv)
+{
+    bool sweep = take_flag(argc, argv, "network_sweep").has_value();
+    if( !init_benchmark(argc, argv) )
+        return 1;
+
+    for(auto const& [name, fn]: PRIMITIVES) {
+        if( !sweep ) {
+            register_primitive(name, fn, loopback_profile(), false);
+            continue;
+        }
+        for(auto const& profile: network::network_profiles())
+            if( profile.name != "none" )
+                register_primitive(name, fn, profile, true);
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
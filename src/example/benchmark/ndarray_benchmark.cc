@@ -0,0 +1,98 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "datatypes/Z2k.hpp"
+#include "ndarray/concatenate.hpp"
+#include "ndarray/ndarray_ref.hpp"
+#include "ndarray/operations.hpp"
+#include "ndarray/packbits.hpp"
+
+#include "example/benchmark/benchmark_utils.h"
+
+/// @brief Benchmarks of the NDArrayRef layout operations and kernels.
+
+using Z64 = Z2<64, true>;
+
+/// @brief Make a random array of the given shape.
+static core::NDArrayRef<Z64> random_ndarray(std::vector<int64_t> shape, uint64_t seed)
+{
+    auto ans  = core::make_ndarray<Z64>(shape);
+    auto flat = random_array<Z64>(ans.numel(), seed);
+    for(int64_t i = 0; i < ans.numel(); ++i)
+        ans.data()[i] = flat[i];
+    return ans;
+}
+
+/// @brief Copy of a transposed view, the strided gather behind most layout changes.
+static void BM_TransposeCopy(benchmark::State& state)
+{
+    int64_t side = int64_t(1) << (state.range(0) / 2);
+    auto in = random_ndarray({side, side}, 1);
+    for(auto _: state)
+        benchmark::DoNotOptimize( in.transpose().copy() );
+    set_throughput_counters(state, side * side);
+}
+
+/// @brief Reshape of a transposed view, which has no linear strides and is copied.
+static void BM_ReshapeStrided(benchmark::State& state)
+{
+    int64_t side = int64_t(1) << (state.range(0) / 2);
+    auto in = random_ndarray({side, side}, 1).transpose();
+    for(auto _: state)
+        benchmark::DoNotOptimize( in.reshape({side * side}) );
+    set_throughput_counters(state, side * side);
+}
+
+static void BM_Concatenate(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(0);
+    std::vector<core::NDArrayRef<Z64>> parts;
+    for(int64_t i = 0; i < 8; ++i)
+        parts.push_back( random_ndarray({numel / 8}, i) );
+    for(auto _: state)
+        benchmark::DoNotOptimize( core::concatenate(std::span(parts), 0) );
+    set_throughput_counters(state, numel);
+}
+
+/// @brief Square matrix product, elements per second counts multiply-adds.
+static void BM_Matmul(benchmark::State& state)
+{
+    int64_t side = int64_t(1) << (state.range(0) / 3);
+    auto lhs = random_ndarray({side, side}, 1);
+    auto rhs = random_ndarray({side, side}, 2);
+    for(auto _: state)
+        benchmark::DoNotOptimize( core::matmul(lhs, rhs) );
+    set_throughput_counters(state, side * side * side);
+}
+
+static void BM_Packbits(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(0);
+    auto in = core::make_ndarray<uint8_t>(std::vector<int64_t>{numel});
+    for(int64_t i = 0; i < numel; ++i)
+        in.data()[i] = (i * 7) & 1;
+    for(auto _: state)
+        benchmark::DoNotOptimize( core::packbits(in) );
+    set_throughput_counters(state, numel);
+}
+
+static void BM_Unpackbits(benchmark::State& state)
+{
+    int64_t numel = int64_t(1) << state.range(0);
+    auto in = core::make_ndarray<uint8_t>(std::vector<int64_t>{numel / 8});
+    for(int64_t i = 0; i < numel / 8; ++i)
+        in.data()[i] = static_cast<uint8_t>(i * 37);
+    for(auto _: state)
+        benchmark::DoNotOptimize( core::unpackbits(in) );
+    set_throughput_counters(state, numel);
+}
+
+BENCHMARK(BM_TransposeCopy) ->Apply(local_args);
+BENCHMARK(BM_ReshapeStrided)->Apply(local_args);
+BENCHMARK(BM_Concatenate)   ->Apply(local_args);
+BENCHMARK(BM_Matmul)        ->Apply(local_args);
+BENCHMARK(BM_Packbits)      ->Apply(local_args);
+BENCHMARK(BM_Unpackbits)    ->Apply(local_args);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,45 @@
+#include <cstdint>
+
+#include "network/multi_party_player.h"
+
+#include "example/benchmark/benchmark_utils.h"
+
+/// @brief Benchmarks of the loopback network, elements are bytes of a message.
+
+/// @brief Latency of one round, every party broadcasts a word and waits for the words of the others.
+static void BM_RoundTrip(benchmark::State& state)
+{
+    auto& parties = LoopbackParties::get(state.range(0));
+    run_parties(state, parties, 8, [](pppu::Context* ctx) {
+        benchmark::DoNotOptimize( ctx->netio()->broadcast_recv(ByteVector(8)) );
+    });
+}
+
+/// @brief Throughput of the exchange between two parties.
+static void BM_Exchange(benchmark::State& state)
+{
+    auto& parties = LoopbackParties::get(state.range(0));
+    int64_t nbytes = int64_t(8) << state.range(1);
+    run_parties(state, parties, nbytes, [nbytes](pppu::Context* ctx) {
+        // the other parties take part in no exchange
+        if( ctx->pid() < 2 )
+            benchmark::DoNotOptimize( ctx->netio()->exchange(1 - ctx->pid(), ByteVector(nbytes)) );
+    });
+}
+
+/// @brief Throughput of the broadcast of every party to all the others, the pattern of opening shares.
+static void BM_BroadcastRecv(benchmark::State& state)
+{
+    auto& parties = LoopbackParties::get(state.range(0));
+    int64_t nbytes = int64_t(8) << state.range(1);
+    run_parties(state, parties, nbytes, [nbytes](pppu::Context* ctx) {
+        benchmark::DoNotOptimize( ctx->netio()->broadcast_recv(ByteVector(nbytes)) );
+    });
+}
+
+BENCHMARK(BM_RoundTrip)
+    ->ArgName("parties")->DenseRange(2, 3)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Exchange)     ->Apply(party_args);
+BENCHMARK(BM_BroadcastRecv)->Apply(party_args);
+
+PPPU_BENCHMARK_MAIN()
@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <vector>
+
+#include "datatypes/Z2k.hpp"
+#include "ndarray/ndarray_ref.hpp"
+#include "ndarray/serialization.hpp"
+#include "serialization/serialization.hpp"
+
+#include "example/benchmark/benchmark_utils.h"
+
+/// @brief Benchmarks of serializing arrays to messages and back, bytes per element is the message size.
+
+/// @brief Make a random one dimensional array, or a transposed square view when strided is set.
+template <typename dtype>
+static core::NDArrayRef<dtype> random_ndarray(int64_t log_numel, bool strided)
+{
+    int64_t numel = int64_t(1) << log_numel;
+    std::vector<int64_t> shape{numel};
+    if( strided )
+        shape = {int64_t(1) << (log_numel / 2), int64_t(1) << (log_numel - log_numel / 2)};
+
+    auto ans  = core::make_ndarray<dtype>(shape);
+    auto flat = random_array<dtype>(numel, 1);
+    for(int64_t i = 0; i < numel; ++i)
+        ans.data()[i] = flat[i];
+    return strided ? ans.transpose() : ans;
+}
+
+template <typename dtype, bool Strided>
+static void BM_Serialize(benchmark::State& state)
+{
+    auto in = random_ndarray<dtype>(state.range(0), Strided);
+    std::size_t nbytes = 0;
+    for(auto _: state) {
+        Serializer sr;
+        sr << in;
+        ByteVector msg = sr.finalize();
+        nbytes = msg.size();
+        benchmark::DoNotOptimize( msg.data() );
+    }
+    state.counters["bytes_per_elem"] = static_cast<double>(nbytes) / static_cast<double>(in.numel());
+    set_throughput_counters(state, in.numel());
+}
+
+template <typename dtype>
+static void BM_Deserialize(benchmark::State& state)
+{
+    auto in = random_ndarray<dtype>(state.range(0), false);
+    Serializer sr;
+    sr << in;
+    ByteVector msg = sr.finalize();
+    for(auto _: state) {
+        state.PauseTiming();
+        ByteVector copy = msg.copy();
+        state.ResumeTiming();
+        Deserializer dr(std::move(copy));
+        benchmark::DoNotOptimize( dr.get<core::NDArrayRef<dtype>>() );
+    }
+    state.counters["bytes_per_elem"] = static_cast<double>(msg.size()) / static_cast<double>(in.numel());
+    set_throughput_counters(state, in.numel());
+}
+
+BENCHMARK_TEMPLATE(BM_Serialize, Z2<64, true>, false) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_Serialize, Z2<64, true>, true)  ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_Serialize, Z2<40, true>, false) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_Serialize, Z2<128, true>, false)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_Serialize, Z2<1, false>, false) ->Apply(local_args);
+
+BENCHMARK_TEMPLATE(BM_Deserialize, Z2<64, true>) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_Deserialize, Z2<40, true>) ->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_Deserialize, Z2<128, true>)->Apply(local_args);
+BENCHMARK_TEMPLATE(BM_Deserialize, Z2<1, false>) ->Apply(local_args);
+
+BENCHMARK_MAIN();
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <barrier>
 #include <iostream>
 #include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
 #include <vector>
 #include <string>
 #include <thread>
@@ -10,8 +14,12 @@
 #include "context/value.hpp"
 #include "context/basic/basic.hpp"
 #include "context/basic/raw.hpp"
+#include "context/basic/util.hpp"
+#include "context/lazy/graph.hpp"
+#include "context/parallel/sharded.hpp"
 #include "datatypes/Z2k.hpp"
 #include "mpc/semi2k/semi2k.hpp"
+#include "ndarray/buffer_pool.hpp"
 #include "ndarray/ndarray_ref.hpp"
 
 #include "example/utils.hpp"
@@ -303,3 +311,270 @@ TEST_MATRIX_FUNC(matmul, pr, sh)
 TEST_MATRIX_FUNC(matmul, sh, pu)
 TEST_MATRIX_FUNC(matmul, sh, pr)
 TEST_MATRIX_FUNC(matmul, sh, sh)
+
+/// @brief Inputs of the fixed point codec, ties of every sign around zero, random values and a few blocks.
+std::vector<double> codec_inputs(int64_t n, int64_t fracbits, double range, uint64_t seed)
+{
+    std::vector<double> res;
+    for(int k = -6; k <= 6; ++k)
+        res.push_back( std::ldexp(k + 0.5, -fracbits) );
+    res.push_back( 0.0 );
+    res.push_back( -0.0 );
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(-range, range);
+    while( static_cast<int64_t>(res.size()) < n )
+        res.push_back( dist(gen) );
+    return res;
+}
+
+/// @brief Compare encode_fixed_point and decode_fixed_point with the scalar encode and decode.
+template <typename U>
+void check_fixed_point_codec(core::NDArrayRef<double> const& input, int64_t fracbits)
+{
+    auto to_ring   = [](double x){ return U(x); };
+    auto to_double = [](U const& x){ return double(x); };
+
+    auto encoded  = pppu::detail::encode_fixed_point<U>(input, fracbits);
+    auto expected = pppu::detail::encode(to_ring, input, fracbits);
+    ASSERT_EQ(encoded.shape(), expected.shape());
+    auto ie = expected.begin();
+    for(auto it = encoded.begin(); it != encoded.end(); ++it, ++ie)
+        ASSERT_EQ(*it, *ie);
+
+    auto decoded = pppu::detail::decode_fixed_point<double>(encoded, fracbits);
+    auto scalar  = pppu::detail::decode(to_double, encoded, fracbits);
+    ASSERT_EQ(decoded.shape(), scalar.shape());
+    auto is = scalar.begin();
+    for(auto it = decoded.begin(); it != decoded.end(); ++it, ++is) {
+        double x = *it, y = *is;
+        ASSERT_EQ(std::memcmp(&x, &y, sizeof(double)), 0) << x << " != " << y;
+    }
+}
+
+TEST(FixedPointCodecTest, TiesRoundAwayFromZero) {
+    int64_t fracbits = 8;
+    auto input   = core::make_ndarray(codec_inputs(13, fracbits, 0, 0));
+    auto encoded = pppu::detail::encode_fixed_point<Z2<64, true>>(input, fracbits);
+    auto it = encoded.begin();
+    for(int k = -6; k <= 6; ++k, ++it) {
+        int64_t expected = k < 0 ? k : k + 1;
+        EXPECT_EQ(int64_t(*it), expected) << "k = " << k;
+    }
+    check_fixed_point_codec<Z2<64, true>>(input, fracbits);
+}
+
+TEST(FixedPointCodecTest, MatchesScalarConversion) {
+    for(int64_t n: {1, 15, 1024, 2500}) {
+        auto input = core::make_ndarray(codec_inputs(n, 40, 1000, n));
+        check_fixed_point_codec<Z2<64, true>>(input, 40);
+        check_fixed_point_codec<Z2<128, true>>(input, 40);
+        check_fixed_point_codec<Z2<64, true>>(input, 0);
+        check_fixed_point_codec<Z2<64, true>>(input, -4);
+        check_fixed_point_codec<Z2<32, true>>(core::make_ndarray(codec_inputs(n, 16, 1000, n)), 16);
+    }
+}
+
+TEST(FixedPointCodecTest, OutOfRangeFallsBack) {
+    // a value of 2^51 and more, inf and nan each spoil one block only
+    int64_t fracbits = 40;
+    auto values = codec_inputs(3500, fracbits, 1000, 7);
+    values[1100] = std::ldexp(1.0, 12);
+    values[1101] = -std::ldexp(1.0, 11) - 0.5;
+    values[2200] = std::numeric_limits<double>::infinity();
+    values[2201] = -std::numeric_limits<double>::infinity();
+    values[3300] = std::numeric_limits<double>::quiet_NaN();
+    check_fixed_point_codec<Z2<64, true>>(core::make_ndarray(values), fracbits);
+
+    // decoding alone, with integers of 2^51 and more
+    std::vector<Z2<64, true>> ring;
+    for(int64_t i = 0; i < 2100; ++i)
+        ring.push_back( Z2<64, true>(i % 2 ? (int64_t(1) << 51) + i : -i) );
+    ring.push_back( Z2<64, true>(std::numeric_limits<int64_t>::min()) );
+    auto encoded = core::make_ndarray(ring);
+    auto decoded = pppu::detail::decode_fixed_point<double>(encoded, fracbits);
+    auto scalar  = pppu::detail::decode([](auto x){ return double(x); }, encoded, fracbits);
+    auto is = scalar.begin();
+    for(auto it = decoded.begin(); it != decoded.end(); ++it, ++is)
+        ASSERT_EQ(*it, *is);
+}
+
+TEST(FixedPointCodecTest, StridedInputs) {
+    int64_t n = 1500, fracbits = 40;
+    auto base = core::make_ndarray(codec_inputs(3*n + 1, fracbits, 1000, 11));
+
+    // every third element from the second one, a linear stride other than 1
+    core::NDArrayRef<double> strided(base.sptr(), {n}, {3}, 1);
+    check_fixed_point_codec<Z2<64, true>>(strided, fracbits);
+
+    // a matrix of strided rows, and a broadcast which takes the scalar path
+    core::NDArrayRef<double> matrix(base.sptr(), {30, 50}, {150, 3}, 2);
+    check_fixed_point_codec<Z2<64, true>>(matrix, fracbits);
+    check_fixed_point_codec<Z2<64, true>>(core::make_ndarray(2.5, {4, 5}), fracbits);
+}
+
+/// @brief Open a Value and decode it to doubles.
+std::vector<double> open_values(pppu::Context* ctx, Value const& x)
+{
+    Value opened = x.is_share() ? pppu::open(ctx, x) : x;
+    auto data = pppu::detail::decode([](auto x){return double(x);}, opened.data_p(), opened.fracbits());
+    std::vector<double> res;
+    for(auto it = data.begin(); it != data.end(); ++it)
+        res.push_back(*it);
+    return res;
+}
+
+TEST(LazyGraphTest, BatchesIndependentNodes) {
+    std::vector<double> x_data{ 1.5, -2.25, 3.0 };
+    std::vector<double> y_data{ 0.5, 4.0, -1.0 };
+    std::vector<double> z_data{ 2.0, -3.0 };
+
+    std::size_t num_batches = 0;
+    std::vector<std::vector<double>> results;
+    auto party = [&](std::size_t pid) {
+        auto context = run_player(pid, 2);
+        pppu::Context* ctx = context.get();
+        Value x = make_value_vec<std::vector<double>, Value>(ctx, pid, x_data, get_sh_vis());
+        Value y = make_value_vec<std::vector<double>, Value>(ctx, pid, y_data, get_sh_vis());
+        Value z = make_value_vec<std::vector<double>, Value>(ctx, pid, z_data, get_sh_vis());
+
+        pppu::LazyGraph<Value> graph;
+        auto nx = graph.input(x), ny = graph.input(y), nz = graph.input(z);
+        // one round of independent nodes, the two products of shares share a batch, so do the two msb
+        auto xy   = graph.mul(nx, ny);
+        auto zz   = graph.mul(nz, nz);
+        auto sq   = graph.square(nz);
+        auto neg  = graph.msb(nx);
+        auto less = graph.less(nx, ny);
+        // then the nodes which depend on them
+        auto xyy  = graph.mul(xy, ny);
+        auto sum  = graph.add(zz, graph.neg(sq));
+        graph.run(ctx);
+
+        std::vector<std::vector<double>> res;
+        for(auto node: {xy, zz, sq, neg, less, xyy, sum})
+            res.push_back( open_values(ctx, graph.value(node)) );
+        if( pid == 0 ) {
+            num_batches = graph.num_batches();
+            results = std::move(res);
+        }
+    };
+    auto thread_player1 = std::thread([&]() { party(1); });
+    party(0);
+    thread_player1.join();
+
+    EXPECT_EQ(num_batches, 4);
+    ASSERT_EQ(results.size(), 7);
+    for(std::size_t i = 0; i < x_data.size(); ++i) {
+        double x = x_data[i], y = y_data[i];
+        EXPECT_NEAR(results[0][i], x * y, 1e-6);
+        EXPECT_EQ(results[3][i], x < 0 ? 1 : 0);
+        EXPECT_EQ(results[4][i], x < y ? 1 : 0);
+        EXPECT_NEAR(results[5][i], x * y * y, 1e-6);
+    }
+    for(std::size_t i = 0; i < z_data.size(); ++i) {
+        double z = z_data[i];
+        EXPECT_NEAR(results[1][i], z * z, 1e-6);
+        EXPECT_NEAR(results[2][i], z * z, 1e-6);
+        EXPECT_NEAR(results[6][i], 0, 1e-6);
+    }
+}
+
+TEST(ShardedTest, MatchesUnsharded) {
+    // three slices which do not divide evenly, the last shard gets one element more
+    int64_t numel = 3 * pppu::SHARD_MIN_NUMEL + 7;
+    std::vector<double> x_data(numel), y_data(numel);
+    std::mt19937_64 gen(46);
+    std::uniform_real_distribution<double> dist(-100, 100);
+    for(int64_t i = 0; i < numel; ++i) {
+        x_data[i] = dist(gen);
+        y_data[i] = dist(gen);
+    }
+
+    std::vector<std::vector<double>> results;
+    auto party = [&](std::size_t pid) {
+        auto context = run_sharded_player(pid, 2, 2);
+        pppu::Context* ctx = context.get();
+        Value x = make_value_vec<std::vector<double>, Value>(ctx, pid, x_data, get_sh_vis());
+        Value y = make_value_vec<std::vector<double>, Value>(ctx, pid, y_data, get_sh_vis());
+
+        auto mul    = [](pppu::Context* c, Value const& a, Value const& b) { return pppu::mul(c, a, b); };
+        auto square = [](pppu::Context* c, Value const& a) { return pppu::square(c, a); };
+        std::vector<std::vector<double>> res;
+        res.push_back( open_values(ctx, pppu::sharded(ctx, mul, x, y)) );
+        res.push_back( open_values(ctx, pppu::mul(ctx, x, y)) );
+        res.push_back( open_values(ctx, pppu::sharded(ctx, square, x)) );
+        res.push_back( open_values(ctx, pppu::square(ctx, x)) );
+        if( pid == 0 )
+            results = std::move(res);
+    };
+    auto thread_player1 = std::thread([&]() { party(1); });
+    party(0);
+    thread_player1.join();
+
+    ASSERT_EQ(results.size(), 4);
+    for(auto const& r: results)
+        ASSERT_EQ(r.size(), numel);
+    for(int64_t i = 0; i < numel; ++i) {
+        // truncation of the shares may differ by one unit in the last place between runs
+        ASSERT_NEAR(results[0][i], results[1][i], 1e-9) << "mul element " << i;
+        ASSERT_NEAR(results[2][i], results[3][i], 1e-9) << "square element " << i;
+        ASSERT_NEAR(results[1][i], x_data[i] * y_data[i], 1e-6) << "element " << i;
+    }
+}
+
+TEST(MatmulViewTest, TransposedOperandIsNotCopied) {
+    // x is 3 x 4, its transpose is multiplied by y, a 3 x 2 matrix
+    std::vector<double> x_data{ 1.5, -2.0, 0.25, 3.0, -1.0, 0.5, 2.0, -0.75, 4.0, 1.25, -3.5, 0.5 };
+    std::vector<double> y_data{ 0.5, -1.5, 2.0, 1.0, -0.25, 3.0 };
+    std::vector<double> xt_data(12);
+    for(int64_t i = 0; i < 3; ++i)
+        for(int64_t j = 0; j < 4; ++j)
+            xt_data[j * 3 + i] = x_data[i * 4 + j];
+
+    // buffers taken from the pool by both parties, snapshot while both wait at the barrier
+    std::vector<int64_t> acquired;
+    std::barrier phase(2, [&]() noexcept {
+        auto stats = core::buffer_pool_stats();
+        acquired.push_back(stats.allocations + stats.reuses);
+    });
+
+    std::vector<std::vector<double>> results;
+    auto party = [&](std::size_t pid) {
+        auto context = run_player(pid, 2);
+        pppu::Context* ctx = context.get();
+        Value x  = make_value_vec<std::vector<double>, Value>(ctx, pid, x_data, get_sh_vis()).reshape({3, 4});
+        Value xt = make_value_vec<std::vector<double>, Value>(ctx, pid, xt_data, get_sh_vis()).reshape({4, 3});
+        Value y  = make_value_vec<std::vector<double>, Value>(ctx, pid, y_data, get_sh_vis()).reshape({3, 2});
+        Value view = x.transpose();
+
+        phase.arrive_and_wait();
+        Value compact_product = pppu::matmul(ctx, xt, y);
+        phase.arrive_and_wait();
+        Value view_product = pppu::matmul(ctx, view, y);
+        phase.arrive_and_wait();
+
+        auto compact_res = open_values(ctx, compact_product);
+        auto view_res    = open_values(ctx, view_product);
+        if( pid == 0 )
+            results = { compact_res, view_res };
+    };
+    auto thread_player1 = std::thread([&]() { party(1); });
+    party(0);
+    thread_player1.join();
+
+    // the view takes no buffer more than the compact operand, so it is read in place
+    ASSERT_EQ(acquired.size(), 3);
+    EXPECT_EQ(acquired[2] - acquired[1], acquired[1] - acquired[0]);
+
+    ASSERT_EQ(results.size(), 2);
+    ASSERT_EQ(results[1].size(), 8);
+    for(int64_t i = 0; i < 4; ++i) {
+        for(int64_t j = 0; j < 2; ++j) {
+            double expected = 0;
+            for(int64_t k = 0; k < 3; ++k)
+                expected += x_data[k * 4 + i] * y_data[k * 2 + j];
+            EXPECT_NEAR(results[0][i * 2 + j], expected, 1e-6);
+            EXPECT_NEAR(results[1][i * 2 + j], expected, 1e-6);
+        }
+    }
+}
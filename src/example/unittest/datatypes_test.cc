@@ -0,0 +1,287 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gmpxx.h>
+
+#include "datatypes/mpx2k.hpp"
+#include "datatypes/Zp.hpp"
+
+#include <gtest/gtest.h>
+
+/// @brief Limb patterns that start or stop carry and borrow chains.
+std::vector<mp_limb_t> edge_limbs()
+{
+    return { 0, 1, 2, ~mp_limb_t(0), ~mp_limb_t(0) - 1, mp_limb_t(1) << 63, (mp_limb_t(1) << 63) - 1 };
+}
+
+/// @brief Values of N limbs mixing edge limbs and random limbs.
+template <size_t N>
+std::vector<std::array<mp_limb_t, N>> limb_values(size_t count, uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    auto edges = edge_limbs();
+    std::vector<std::array<mp_limb_t, N>> res;
+
+    // every limb equal to the same edge pattern, e.g. all ones carries through every limb
+    for(auto e: edges) {
+        std::array<mp_limb_t, N> x;
+        x.fill(e);
+        res.push_back(x);
+    }
+    while( res.size() < count ) {
+        std::array<mp_limb_t, N> x;
+        for(auto& limb: x)
+            limb = (gen() % 3 == 0) ? gen() : edges[gen() % edges.size()];
+        res.push_back(x);
+    }
+    return res;
+}
+
+/// @brief Read n limbs as a non-negative integer.
+mpz_class from_limbs(const mp_limb_t* p, size_t n)
+{
+    mpz_class z;
+    mpz_import(z.get_mpz_t(), n, -1, sizeof(mp_limb_t), 0, 0, p);
+    return z;
+}
+
+/// @brief Reduce z modulo 2^bits into n limbs.
+std::vector<mp_limb_t> to_limbs(mpz_class z, size_t bits, size_t n)
+{
+    mpz_fdiv_r_2exp(z.get_mpz_t(), z.get_mpz_t(), bits);
+    std::vector<mp_limb_t> res(n, 0);
+    mpz_export(res.data(), nullptr, -1, sizeof(mp_limb_t), 0, 0, z.get_mpz_t());
+    return res;
+}
+
+template <size_t N>
+void check_fixed_kernels()
+{
+    constexpr size_t BITS = N * sizeof(mp_limb_t) * 8;
+    auto values = limb_values<N>(60, N);
+
+    for(auto const& a: values) {
+        for(auto const& b: values) {
+            auto za = from_limbs(a.data(), N);
+            auto zb = from_limbs(b.data(), N);
+            std::array<mp_limb_t, N> r;
+
+            detail::fixed_add<N>(r.data(), a.data(), b.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za + zb, BITS, N));
+
+            detail::fixed_sub<N>(r.data(), a.data(), b.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za - zb, BITS, N));
+
+            detail::fixed_mul<N>(r.data(), a.data(), b.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za * zb, BITS, N));
+
+            // the result may alias an operand
+            r = a;
+            detail::fixed_mul<N>(r.data(), r.data(), b.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za * zb, BITS, N));
+            r = b;
+            detail::fixed_add<N>(r.data(), a.data(), r.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za + zb, BITS, N));
+        }
+
+        std::array<mp_limb_t, N> r;
+        detail::fixed_neg<N>(r.data(), a.data());
+        ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(-from_limbs(a.data(), N), BITS, N));
+    }
+}
+
+TEST(Mpx2kTest, FixedKernelsMatchGmp) {
+    check_fixed_kernels<1>();
+    check_fixed_kernels<2>();
+    check_fixed_kernels<3>();
+    check_fixed_kernels<4>();
+}
+
+template <size_t K>
+void check_mpx2k()
+{
+    constexpr size_t N = detail::N_LIMBS<K>;
+    auto values = limb_values<N>(40, K);
+    for(auto& x: values)
+        detail::mpx2k_norm<K>(x.data());
+
+    std::vector<mp_limb_t> flat_a, flat_b;
+    std::vector<mpz_class> sums, diffs, prods;
+
+    for(auto const& a: values) {
+        for(auto const& b: values) {
+            auto za = from_limbs(a.data(), N);
+            auto zb = from_limbs(b.data(), N);
+            std::array<mp_limb_t, N> r;
+
+            detail::mpx2k_add<K>(r.data(), a.data(), b.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za + zb, K, N)) << "K=" << K;
+            detail::mpx2k_sub<K>(r.data(), a.data(), b.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za - zb, K, N)) << "K=" << K;
+            detail::mpx2k_mul<K>(r.data(), a.data(), b.data());
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(za * zb, K, N)) << "K=" << K;
+
+            flat_a.insert(flat_a.end(), a.begin(), a.end());
+            flat_b.insert(flat_b.end(), b.begin(), b.end());
+            sums.push_back(za + zb);
+            diffs.push_back(za - zb);
+            prods.push_back(za * zb);
+        }
+
+        std::array<mp_limb_t, N> r;
+        detail::mpx2k_neg<K>(r.data(), a.data());
+        ASSERT_EQ(std::vector<mp_limb_t>(r.begin(), r.end()), to_limbs(-from_limbs(a.data(), N), K, N)) << "K=" << K;
+    }
+
+    // the batch kernels walk contiguous values
+    size_t n = sums.size();
+    std::vector<mp_limb_t> r(n * N);
+    auto check_batch = [&](std::vector<mpz_class> const& expected) {
+        for(size_t i = 0; i < n; ++i)
+            ASSERT_EQ(std::vector<mp_limb_t>(r.begin() + i*N, r.begin() + (i+1)*N), to_limbs(expected[i], K, N)) << "K=" << K;
+    };
+    detail::mpx2k_add_n<K>(r.data(), flat_a.data(), flat_b.data(), n);
+    check_batch(sums);
+    detail::mpx2k_sub_n<K>(r.data(), flat_a.data(), flat_b.data(), n);
+    check_batch(diffs);
+    detail::mpx2k_mul_n<K>(r.data(), flat_a.data(), flat_b.data(), n);
+    check_batch(prods);
+}
+
+TEST(Mpx2kTest, ArithmeticMatchesGmp) {
+    check_mpx2k<65>();
+    check_mpx2k<100>();
+    check_mpx2k<128>();
+    check_mpx2k<129>();
+    check_mpx2k<192>();
+    check_mpx2k<200>();
+    check_mpx2k<255>();
+    check_mpx2k<256>();
+    check_mpx2k<257>();
+    check_mpx2k<320>();
+}
+
+/// @brief Values around 0, p and 2^64 multiples, reduced or not, and random values of up to 2 * bits bits.
+std::vector<mpz_class> field_inputs(mpz_class const& p, size_t bits, uint64_t seed)
+{
+    std::vector<mpz_class> res { 0, 1, 2, p - 2, p - 1, p, p + 1, 2*p - 1 };
+    for(size_t limb = 64; limb < 2 * bits; limb += 64) {
+        mpz_class x = mpz_class(1) << limb;
+        res.push_back(x - 1);
+        res.push_back(x);
+    }
+
+    gmp_randclass rand(gmp_randinit_default);
+    rand.seed(seed);
+    for(int i = 0; i < 50; ++i)
+        res.push_back( rand.get_z_bits(i % 2 ? bits : 2 * bits) );
+    return res;
+}
+
+template <size_t N>
+void check_field(mpz_class const& p, bool mersenne)
+{
+    using Field = Zp<N>;
+    Field::init(p);
+    ASSERT_EQ(Field::is_mersenne(), mersenne);
+
+    constexpr size_t NL = detail::ZP_LIMBS<N>;
+    mpz_class R = mpz_class(1) << (64 * NL);
+
+    auto inputs = field_inputs(p, N, N);
+    for(auto const& x: inputs) {
+        mpz_class xr = x % p;
+
+        // in and out of the stored form
+        Field a(x);
+        ASSERT_EQ(a.to_mpz(), xr) << x;
+        mpz_class stored = mersenne ? xr : mpz_class(xr * R % p);
+        ASSERT_EQ(from_limbs(a.data(), NL), stored) << x;
+        ASSERT_EQ(Field(a.to_mpz()), a);
+        ASSERT_EQ(Field(x.get_str(16), 16), a);
+
+        for(auto const& y: inputs) {
+            mpz_class yr = y % p;
+            Field b(y);
+            ASSERT_EQ((a * b).to_mpz(), mpz_class(xr * yr % p)) << x << " * " << y;
+            ASSERT_EQ((a + b).to_mpz(), mpz_class((xr + yr) % p)) << x << " + " << y;
+            mpz_class diff = (xr - yr) % p;
+            if( diff < 0 ) diff += p;
+            ASSERT_EQ((a - b).to_mpz(), diff) << x << " - " << y;
+        }
+
+        if( xr == 0 ) {
+            EXPECT_THROW(a.inv(), std::invalid_argument);
+            continue;
+        }
+        mpz_class expected;
+        mpz_invert(expected.get_mpz_t(), xr.get_mpz_t(), p.get_mpz_t());
+        ASSERT_EQ(a.inv().to_mpz(), expected) << x;
+        ASSERT_EQ((a * a.inv()).to_mpz(), 1) << x;
+        ASSERT_EQ((Field(7) / a).to_mpz(), mpz_class(7 * expected % p)) << x;
+    }
+
+    // batch kernels agree with the element wise operators
+    std::vector<Field> xs, ys;
+    for(auto const& x: inputs) {
+        if( x % p == 0 ) continue;
+        xs.emplace_back(x);
+        ys.emplace_back(x * 3 + 1);
+    }
+    std::vector<Field> r(xs.size());
+    mul_n(r.data(), xs.data(), ys.data(), xs.size());
+    for(size_t i = 0; i < xs.size(); ++i)
+        ASSERT_EQ(r[i], xs[i] * ys[i]);
+    inv_n(r.data(), xs.data(), xs.size());
+    for(size_t i = 0; i < xs.size(); ++i)
+        ASSERT_EQ(r[i], xs[i].inv());
+}
+
+TEST(ZpTest, MersenneModuli) {
+    check_field<61>((mpz_class(1) << 61) - 1, true);
+    check_field<127>((mpz_class(1) << 127) - 1, true);
+}
+
+TEST(ZpTest, MontgomeryModuli) {
+    mpz_class p61, p127;
+    mpz_nextprime(p61.get_mpz_t(),  mpz_class(mpz_class(1) << 60).get_mpz_t());
+    mpz_nextprime(p127.get_mpz_t(), mpz_class(mpz_class(1) << 126).get_mpz_t());
+
+    check_field<61>(p61, false);
+    check_field<64>((mpz_class(1) << 64) - 59, false);
+    check_field<127>(p127, false);
+    check_field<128>((mpz_class(1) << 128) - 159, false);
+    check_field<255>((mpz_class(1) << 255) - 19, false);
+}
+
+template <size_t N>
+void check_barrett(mp_limb_t p)
+{
+    detail::ZpModulus<N> m;
+    m.p[0]    = p;
+    m.barrett = static_cast<mp_limb_t>( (static_cast<__uint128_t>(1) << 64) / p );
+
+    std::vector<mp_limb_t> xs { 0, 1, p - 1, p, p + 1, ~mp_limb_t(0), ~mp_limb_t(0) - p, ~mp_limb_t(0) / p * p - 1, ~mp_limb_t(0) / p * p };
+    if( p <= ~mp_limb_t(0) / 2 ) {
+        xs.push_back(2 * p - 1);
+        xs.push_back(2 * p);
+    }
+    for(auto x: xs)
+        ASSERT_EQ(detail::mpxp_barrett_reduce<N>(x, m), x % p) << "p=" << p << " x=" << x;
+
+    // assign(unsigned long) takes the Barrett path
+    Zp<N>::init(mpz_class(std::to_string(p)));
+    for(auto x: xs)
+        ASSERT_EQ(Zp<N>(static_cast<unsigned long>(x)).to_mpz(), mpz_class(std::to_string(x % p)));
+}
+
+TEST(ZpTest, BarrettReductionBoundaries) {
+    check_barrett<2>(3);
+    check_barrett<61>((mp_limb_t(1) << 61) - 1);
+    check_barrett<62>(4611686018427387847ull);    // largest 62 bit prime
+    check_barrett<64>(~mp_limb_t(0) - 58);         // 2^64 - 59
+}
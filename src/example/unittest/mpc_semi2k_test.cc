@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <cstdio>
+#include <random>
 #include <vector>
 #include <string>
 #include <thread>
@@ -67,11 +68,57 @@ core::ArrayRef<Z> make_array_gamma(int pid) {
     }
 }
 
+/// @brief Run fn(pid, semi2k, player) on two parties whose preprocessing is dealt from the same seed, return the result of party 0.
+template <typename Fn>
+auto run_with_random_preprocessing(Fn&& fn)
+{
+    int base_port = 8888;
+    std::vector<tcp::endpoint> endpoints;
+    for(int i = 0; i < 2; ++i)
+        endpoints.emplace_back(address::from_string("127.0.0.1"), base_port+i);
+
+    auto party = [&](int pid) {
+        network::PlainMultiPartyPlayer player(pid, 2);
+        player.run(2);
+        player.connect(endpoints);
+        mpc::Semi2kTriple semi2k_triple(pid, 2, 20240601);
+        mpc::Semi2k semi2k(pid, 2, &player, &semi2k_triple);
+        return fn(pid, semi2k, player);
+    };
+    auto thread_player1 = std::thread([&]() { party(1); });
+    auto res = party(0);
+    thread_player1.join();
+    return res;
+}
+
+/// @brief Values with both signs and every bit in use.
+std::vector<Z> random_values(int64_t n, uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    std::vector<Z> res;
+    for(int64_t i = 0; i < n; ++i)
+        res.push_back( (Z(gen()) << 64) + Z(gen()) );
+    res.push_back( Z(0) );
+    res.push_back( Z(-3) );
+    return res;
+}
+
+/// @brief Additive share of values held by party pid.
+core::ArrayRef<Z> share_of(std::vector<Z> const& values, int pid)
+{
+    auto masks = random_values(values.size() - 2, 99);
+    auto res = core::make_array<Z>(values.size());
+    for(std::size_t i = 0; i != values.size(); ++i)
+        res[i] = pid == 0 ? values[i] - masks[i] : masks[i];
+    return res;
+}
+
 float get_input_ans(float x) { return x; }
 float get_open_ans(float x) { return 30; }
 float get_neg_ans(float x) { return -x; }
 float get_msb_ans(float x) { if(x < 0) return 1; else return 0; }
 float get_eqz_ans(float x) { if(x == 0) return 1; else return 0; }
+float get_square_ans(float x) { return x * x; }
 
 #define TEST_UNARY_FUNC(op, vis)                                                                           \
 TEST(MPCSemi2kUnaryTest, op_##op##_##vis) {                                                                \
@@ -122,6 +169,7 @@ TEST_UNARY_FUNC(msb, p)
 TEST_UNARY_FUNC(msb, s)
 TEST_UNARY_FUNC(eqz, p)
 TEST_UNARY_FUNC(eqz, s)
+TEST_UNARY_FUNC(square, p)
 
 float get_add_pp_ans(int pid, float x, float y) { return x + y; }
 float get_add_sp_ans(int pid, float x, float y) { if(pid == 0) return x + y; else return x; }
@@ -339,4 +387,64 @@ TEST(MPCSemi2kMatrixTest, op_##op##_##vis1##vis2) {
 
 TEST_MATRIX_FUNC(matmul, p, p)
 TEST_MATRIX_FUNC(matmul, s, p)
-TEST_MATRIX_FUNC(matmul, s, s)
\ No newline at end of file
+TEST_MATRIX_FUNC(matmul, s, s)
+
+TEST(MPCSemi2kPreprocessingTest, SquareWithRandomPairs) {
+    auto x = random_values(30, 1);
+    auto ans = run_with_random_preprocessing([&](int pid, mpc::Semi2k& semi2k, network::PlainMultiPartyPlayer&) {
+        return semi2k.open_s(semi2k.square_s(share_of(x, pid)));
+    });
+    ASSERT_EQ(ans.numel(), static_cast<int64_t>(x.size()));
+    for(std::size_t i = 0; i != x.size(); ++i)
+        EXPECT_EQ(ans[i], x[i] * x[i]) << "element " << i;
+}
+
+TEST(MPCSemi2kPreprocessingTest, MulWithRandomTriples) {
+    auto x = random_values(30, 2);
+    auto y = random_values(30, 3);
+    auto ans = run_with_random_preprocessing([&](int pid, mpc::Semi2k& semi2k, network::PlainMultiPartyPlayer&) {
+        return semi2k.open_s(semi2k.mul_ss(share_of(x, pid), share_of(y, pid)));
+    });
+    for(std::size_t i = 0; i != x.size(); ++i)
+        EXPECT_EQ(ans[i], x[i] * y[i]) << "element " << i;
+}
+
+TEST(MPCSemi2kPreprocessingTest, MatmulWithRandomTriples) {
+    // 4x8 times 8x4
+    auto x = random_values(30, 4);
+    auto y = random_values(30, 5);
+    auto ans = run_with_random_preprocessing([&](int pid, mpc::Semi2k& semi2k, network::PlainMultiPartyPlayer&) {
+        return semi2k.open_s(semi2k.matmul_ss(share_of(x, pid), share_of(y, pid), 4, 8, 4));
+    });
+    for(int64_t i = 0; i < 4; ++i)
+        for(int64_t j = 0; j < 4; ++j) {
+            Z expected(0);
+            for(int64_t k = 0; k < 8; ++k)
+                expected = expected + x[i*8 + k] * y[k*4 + j];
+            EXPECT_EQ(ans[i*4 + j], expected) << "element " << i << ", " << j;
+        }
+}
+
+TEST(MPCSemi2kPreprocessingTest, MulThenTruncRounds) {
+    // products below 2^80, so the local truncation of two parties is off by one at most
+    std::size_t nbits = 20;
+    auto x = random_values(30, 6);
+    auto y = random_values(30, 7);
+    for(std::size_t i = 0; i != x.size(); ++i) {
+        x[i] = x[i] >> 88;
+        y[i] = y[i] >> 88;
+    }
+    auto ans = run_with_random_preprocessing([&](int pid, mpc::Semi2k& semi2k, network::PlainMultiPartyPlayer& player) {
+        auto rounds = player.get_statistics().rounds;
+        auto z = semi2k.mul_ss(share_of(x, pid), share_of(y, pid));
+        // both masked operands are opened in one round, two parties truncate locally
+        EXPECT_EQ(player.get_statistics().rounds - rounds, 1);
+        auto t = semi2k.trunc_s(z, nbits);
+        EXPECT_EQ(player.get_statistics().rounds - rounds, 1);
+        return semi2k.open_s(t);
+    });
+    for(std::size_t i = 0; i != x.size(); ++i) {
+        Z diff = ans[i] - ( (x[i] * y[i]) >> nbits );
+        EXPECT_TRUE( diff == Z(0) || diff == Z(1) || diff == Z(-1) ) << "element " << i;
+    }
+}
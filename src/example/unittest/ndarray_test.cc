@@ -0,0 +1,597 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "datatypes/Z2k.hpp"
+#include "ndarray/array_ref.hpp"
+#include "ndarray/buffer_pool.hpp"
+#include "ndarray/expression.hpp"
+#include "ndarray/ndarray_ref.hpp"
+#include "ndarray/operations.hpp"
+#include "ndarray/packbits.hpp"
+#include "ndarray/parallel.hpp"
+#include "ndarray/tools.hpp"
+
+#include <gtest/gtest.h>
+
+template <typename dtype>
+std::vector<dtype> random_vector(int64_t n, uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    std::vector<dtype> res;
+    res.reserve(n);
+    for(int64_t i = 0; i < n; ++i)
+        res.push_back( dtype(gen()) );
+    return res;
+}
+
+/// @brief Reference row major product with the plain triple loop.
+template <typename dtype>
+std::vector<dtype> naive_matmul(std::vector<dtype> const& lhs, std::vector<dtype> const& rhs, int64_t M, int64_t N, int64_t K)
+{
+    std::vector<dtype> res(M*K, dtype(0));
+    for(int64_t i = 0; i < M; ++i)
+        for(int64_t j = 0; j < K; ++j) {
+            dtype acc = dtype(0);
+            for(int64_t k = 0; k < N; ++k)
+                acc = acc + lhs[i*N + k] * rhs[k*K + j];
+            res[i*K + j] = acc;
+        }
+    return res;
+}
+
+template <typename dtype>
+void check_matmul(int64_t M, int64_t N, int64_t K)
+{
+    auto lhs = random_vector<dtype>(M*N, M*1000003 + N);
+    auto rhs = random_vector<dtype>(N*K, K*1000033 + N);
+    auto expected = naive_matmul(lhs, rhs, M, N, K);
+
+    auto res = core::matmul(core::make_array(lhs), core::make_array(rhs), M, N, K);
+    ASSERT_EQ(res.numel(), M*K);
+    for(int64_t i = 0; i < M*K; ++i)
+        ASSERT_TRUE(res[i] == expected[i]) << "M=" << M << " N=" << N << " K=" << K << " at " << i;
+}
+
+class GemmTest : public ::testing::Test
+{
+  protected:
+    void SetUp()    override { core::set_num_threads(4); }
+    void TearDown() override { core::set_num_threads(0); }
+};
+
+TEST_F(GemmTest, NonSquare) {
+    check_matmul<uint32_t>(3, 5, 7);
+    check_matmul<uint64_t>(7, 5, 3);
+    check_matmul<Z2<64, true>>(13, 9, 21);
+    check_matmul<Z2<128, false>>(21, 9, 13);
+}
+
+TEST_F(GemmTest, UnevenBlocks) {
+    // not multiples of the register tile nor of the cache blocks, large enough to be split across threads
+    check_matmul<uint64_t>(67, 259, 131);
+    check_matmul<uint64_t>(131, 259, 67);
+    check_matmul<Z2<64, true>>(65, 513, 70);
+    check_matmul<uint16_t>(5, 3, 9);
+}
+
+TEST_F(GemmTest, VectorShapes) {
+    check_matmul<uint64_t>(1, 300, 1);
+    check_matmul<uint64_t>(1, 300, 517);
+    check_matmul<uint64_t>(517, 300, 1);
+    check_matmul<uint64_t>(1, 1, 1029);
+    check_matmul<uint64_t>(1029, 1, 1);
+    check_matmul<Z2<64, true>>(1, 7, 5);
+    check_matmul<Z2<64, true>>(5, 7, 1);
+}
+
+TEST_F(GemmTest, TransposedView) {
+    int64_t M = 37, N = 70, K = 45;
+    auto lhs = random_vector<uint64_t>(M*N, 1);
+    auto rhs = random_vector<uint64_t>(N*K, 2);
+    auto expected = naive_matmul(lhs, rhs, M, N, K);
+
+    // multiply the transposed copies of the transposed operands
+    std::vector<uint64_t> lhs_t(N*M), rhs_t(K*N);
+    for(int64_t i = 0; i < M; ++i)
+        for(int64_t k = 0; k < N; ++k)
+            lhs_t[k*M + i] = lhs[i*N + k];
+    for(int64_t k = 0; k < N; ++k)
+        for(int64_t j = 0; j < K; ++j)
+            rhs_t[j*N + k] = rhs[k*K + j];
+
+    auto a = core::make_ndarray(lhs_t).reshape({N, M}).transpose();
+    auto b = core::make_ndarray(rhs_t).reshape({K, N}).transpose();
+    auto res = core::matmul(a, b);
+    ASSERT_EQ(res.shape(), (std::vector<int64_t>{M, K}));
+    for(int64_t i = 0; i < M; ++i)
+        for(int64_t j = 0; j < K; ++j)
+            ASSERT_EQ(res.elem({i, j}), expected[i*K + j]);
+}
+
+TEST(ParallelTest, CoversRangeOnce) {
+    core::set_num_threads(4);
+    std::vector<std::atomic<int>> hits(10007);
+    for(int repeat = 0; repeat < 20; ++repeat)
+        core::detail::parallel_for(0, hits.size(), 17, [&](int64_t begin, int64_t end) {
+            for(int64_t i = begin; i < end; ++i)
+                ++hits[i];
+        });
+    core::set_num_threads(0);
+    for(auto const& h: hits)
+        ASSERT_EQ(h.load(), 20);
+}
+
+TEST(ParallelTest, Nested) {
+    core::set_num_threads(4);
+    std::atomic<int64_t> sum = 0;
+    core::detail::parallel_for(0, 8, 1, [&](int64_t begin, int64_t end) {
+        for(int64_t i = begin; i < end; ++i)
+            core::detail::parallel_for(0, 1000, 1, [&](int64_t b, int64_t e) { sum += e - b; });
+    });
+    core::set_num_threads(0);
+    EXPECT_EQ(sum.load(), 8000);
+}
+
+TEST(ParallelTest, WorkerExceptionReachesCaller) {
+    core::set_num_threads(4);
+    for(int repeat = 0; repeat < 10; ++repeat) {
+        EXPECT_THROW(
+            core::detail::parallel_for(0, 1000, 1, [](int64_t begin, int64_t) {
+                if( begin != 0 )
+                    throw std::runtime_error("worker failed");
+            }),
+            std::runtime_error);
+    }
+    // the pool stays usable afterwards
+    std::atomic<int64_t> count = 0;
+    core::detail::parallel_for(0, 1000, 1, [&](int64_t begin, int64_t end) { count += end - begin; });
+    core::set_num_threads(0);
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(ParallelTest, ThreadLimit) {
+    core::set_num_threads(8);
+    {
+        core::ThreadLimit outer(3);
+        EXPECT_EQ(core::get_num_threads(), 3);
+        {
+            // nested limits only lower the number
+            core::ThreadLimit inner(5);
+            EXPECT_EQ(core::get_num_threads(), 3);
+            core::ThreadLimit lower(2);
+            EXPECT_EQ(core::get_num_threads(), 2);
+        }
+        EXPECT_EQ(core::get_num_threads(), 3);
+
+        // the pool threads running the tasks inherit the limit of the caller
+        std::atomic<int64_t> wrong = 0;
+        core::detail::parallel_for(0, 64, 1, [&](int64_t, int64_t) {
+            if( core::get_num_threads() != 3 )
+                ++wrong;
+        });
+        EXPECT_EQ(wrong.load(), 0);
+    }
+    EXPECT_EQ(core::get_num_threads(), 8);
+    EXPECT_THROW(core::ThreadLimit(0), std::invalid_argument);
+    core::set_num_threads(0);
+}
+
+class BufferPoolTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        core::clear_buffer_pool();
+        core::reset_buffer_pool_stats();
+    }
+
+    void TearDown() override
+    {
+        core::set_buffer_pool_capacity(int64_t(1) << 30);
+        core::set_buffer_pool_enabled(true);
+        core::clear_buffer_pool();
+    }
+};
+
+TEST_F(BufferPoolTest, ReusesReleasedBuffers) {
+    uint64_t* first;
+    {
+        auto buffer = core::make_buffer<uint64_t>(1000);
+        first = buffer->data();
+    }
+    auto stats = core::buffer_pool_stats();
+    EXPECT_EQ(stats.allocations, 1);
+    EXPECT_EQ(stats.releases, 1);
+    EXPECT_EQ(stats.cached_buffers, 1);
+
+    // the same size class is served from the pool, value-initialized again
+    auto buffer = core::make_buffer<uint64_t>(990);
+    EXPECT_EQ(buffer->data(), first);
+    EXPECT_EQ(buffer->size(), 990u);
+    for(auto x: *buffer)
+        ASSERT_EQ(x, 0u);
+    stats = core::buffer_pool_stats();
+    EXPECT_EQ(stats.reuses, 1);
+    EXPECT_EQ(stats.cached_buffers, 0);
+    EXPECT_EQ(stats.cached_bytes, 0);
+}
+
+TEST_F(BufferPoolTest, ArraysFromVectorsArePooled) {
+    {
+        auto a = core::make_ndarray(std::vector<uint64_t>(100, 7));
+        auto b = core::make_ndarray({uint64_t(1), uint64_t(2), uint64_t(3)});
+        auto c = core::make_array(std::vector<uint64_t>(100, 7));
+        auto d = core::arange<int64_t>(0, 100, 3);
+        EXPECT_EQ(b.elem({2}), 3u);
+        EXPECT_EQ(d.elem({33}), 99);
+    }
+    EXPECT_EQ(core::buffer_pool_stats().releases, 4);
+}
+
+TEST_F(BufferPoolTest, RespectsCapacity) {
+    core::set_buffer_pool_capacity(1000 * sizeof(uint64_t));
+    {
+        auto a = core::make_buffer<uint64_t>(800);
+        auto b = core::make_buffer<uint64_t>(800);
+    }
+    auto stats = core::buffer_pool_stats();
+    EXPECT_EQ(stats.releases, 1);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_LE(stats.cached_bytes, core::buffer_pool_capacity());
+
+    core::set_buffer_pool_enabled(false);
+    stats = core::buffer_pool_stats();
+    EXPECT_EQ(stats.cached_buffers, 0);
+    EXPECT_EQ(stats.cached_bytes, 0);
+    {
+        auto a = core::make_buffer<uint64_t>(10);
+    }
+    EXPECT_EQ(core::buffer_pool_stats().cached_buffers, 0);
+}
+
+TEST_F(BufferPoolTest, ConcurrentAcquireRelease) {
+    int64_t capacity = 64 * 1024;
+    core::set_buffer_pool_capacity(capacity);
+
+    std::atomic<bool> over_capacity = false;
+    std::atomic<bool> corrupted     = false;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937_64 gen(t);
+            for(int i = 0; i < 2000; ++i) {
+                std::size_t numel = 1 + gen() % 2048;
+                auto buffer = core::make_buffer<uint32_t>(numel, uint32_t(t));
+                for(auto x: *buffer)
+                    if( x != uint32_t(t) )
+                        corrupted = true;
+                if( core::buffer_pool_stats().cached_bytes > capacity )
+                    over_capacity = true;
+            }
+        });
+    }
+    for(auto& t: threads)
+        t.join();
+
+    auto stats = core::buffer_pool_stats();
+    EXPECT_FALSE(over_capacity.load());
+    EXPECT_FALSE(corrupted.load());
+    EXPECT_EQ(stats.allocations + stats.reuses, 8 * 2000);
+    EXPECT_EQ(stats.releases + stats.evictions, 8 * 2000);
+    EXPECT_EQ(stats.cached_buffers, stats.releases - stats.reuses);
+    EXPECT_LE(stats.cached_bytes, capacity);
+
+    core::clear_buffer_pool();
+    stats = core::buffer_pool_stats();
+    EXPECT_EQ(stats.cached_buffers, 0);
+    EXPECT_EQ(stats.cached_bytes, 0);
+}
+
+/// @brief Reference result of an element wise operation computed element by element.
+template <typename dtype, typename Fn>
+std::vector<dtype> naive_apply(Fn&& fn, core::ArrayRef<dtype> const& lhs, core::ArrayRef<dtype> const& rhs)
+{
+    std::vector<dtype> res;
+    for(int64_t i = 0; i < lhs.numel(); ++i)
+        res.push_back( fn(lhs[i], rhs[i]) );
+    return res;
+}
+
+template <typename dtype>
+void expect_array_eq(core::ArrayRef<dtype> const& arr, std::vector<dtype> const& expected)
+{
+    ASSERT_EQ(arr.numel(), static_cast<int64_t>(expected.size()));
+    for(int64_t i = 0; i < arr.numel(); ++i)
+        ASSERT_TRUE(arr[i] == expected[i]) << "at " << i;
+}
+
+template <typename dtype>
+void check_inplace_ops(int64_t numel)
+{
+    auto lhs = core::make_array( random_vector<dtype>(numel, numel + 1) );
+    auto rhs = core::make_array( random_vector<dtype>(numel, numel + 2) );
+    auto sum  = naive_apply(std::plus<>{},       lhs, rhs);
+    auto diff = naive_apply(std::minus<>{},      lhs, rhs);
+    auto prod = naive_apply(std::multiplies<>{}, lhs, rhs);
+
+    auto a = core::make_array( random_vector<dtype>(numel, numel + 1) );
+    expect_array_eq(core::add_inplace(a, rhs), sum);
+    a = core::make_array( random_vector<dtype>(numel, numel + 1) );
+    expect_array_eq(core::sub_inplace(a, rhs), diff);
+    a = core::make_array( random_vector<dtype>(numel, numel + 1) );
+    expect_array_eq(core::mul_inplace(a, rhs), prod);
+
+    std::vector<dtype> negated;
+    for(int64_t i = 0; i < numel; ++i)
+        negated.push_back( -lhs[i] );
+    a = core::make_array( random_vector<dtype>(numel, numel + 1) );
+    expect_array_eq(core::neg_inplace(a), negated);
+
+    // temporaries give the same results as constant operands, whichever side is moved
+    expect_array_eq(core::add(core::make_array( random_vector<dtype>(numel, numel + 1) ), rhs), sum);
+    expect_array_eq(core::sub(lhs, core::make_array( random_vector<dtype>(numel, numel + 2) )), diff);
+    expect_array_eq(core::mul(core::make_array( random_vector<dtype>(numel, numel + 1) ),
+                              core::make_array( random_vector<dtype>(numel, numel + 2) )), prod);
+    expect_array_eq(core::neg(core::make_array( random_vector<dtype>(numel, numel + 1) )), negated);
+
+    // the operands passed by reference are untouched
+    expect_array_eq(lhs, random_vector<dtype>(numel, numel + 1));
+    expect_array_eq(rhs, random_vector<dtype>(numel, numel + 2));
+}
+
+TEST(InplaceOpsTest, MatchesElementwise) {
+    for(int64_t numel: {0, 1, 7, 33, 1000}) {
+        check_inplace_ops<int64_t>(numel);
+        check_inplace_ops<int32_t>(numel);
+        check_inplace_ops<Z2<64, true>>(numel);
+        check_inplace_ops<Z2<32, true>>(numel);
+        check_inplace_ops<Z2<128, true>>(numel);
+        check_inplace_ops<Z2<100, false>>(numel);
+    }
+}
+
+TEST(InplaceOpsTest, SharedTemporaryIsNotOverwritten) {
+    auto lhs = core::make_array<int64_t>({-3, -2, -1, 0, 1, 2, 3});
+    auto rhs = core::make_array<int64_t>({5, 5, 5, 5, 5, 5, 5});
+    auto alias = lhs;
+
+    auto res = core::add(std::move(lhs), rhs);
+    expect_array_eq(res,   std::vector<int64_t>{2, 3, 4, 5, 6, 7, 8});
+    expect_array_eq(alias, std::vector<int64_t>{-3, -2, -1, 0, 1, 2, 3});
+}
+
+TEST(InplaceOpsTest, StridedAndBroadcastOperands) {
+    auto base = core::make_array<int64_t>({-4, 1, -3, 1, -2, 1, -1, 1, 0});
+    auto even = core::ArrayRef<int64_t>(base.sptr(), 5, 2, 0);
+    auto five = core::make_array<int64_t>(int64_t(-5), 5);
+
+    expect_array_eq(core::add(core::ArrayRef<int64_t>(even), five), std::vector<int64_t>{-9, -8, -7, -6, -5});
+    expect_array_eq(core::mul(core::make_array<int64_t>(int64_t(3), 5), core::ArrayRef<int64_t>(even)),
+                    std::vector<int64_t>{-12, -9, -6, -3, 0});
+
+    core::sub_inplace(even, five);
+    expect_array_eq(base, std::vector<int64_t>{1, 1, 2, 1, 3, 1, 4, 1, 5});
+}
+
+template <typename dtype>
+void check_expression(int64_t numel)
+{
+    auto a = core::make_array( random_vector<dtype>(numel, 11) );
+    auto b = core::make_array( random_vector<dtype>(numel, 12) );
+    auto c = core::make_array( random_vector<dtype>(numel, 13) );
+    auto s = core::make_array( dtype(-7), numel );
+
+    std::vector<dtype> expected;
+    for(int64_t i = 0; i < numel; ++i)
+        expected.push_back( a[i]*b[i] - (-c[i]) + a[i]*s[i] );
+
+    auto res = core::evaluate( a*b - (-c) + a*s );
+    expect_array_eq(res, expected);
+
+    // evaluating into one of the operands reads each element before overwriting it
+    core::evaluate_into(c, a*b - (-c) + a*s);
+    expect_array_eq(c, expected);
+}
+
+TEST(ExpressionTest, MatchesElementwise) {
+    for(int64_t numel: {0, 1, 5, 64, 1001}) {
+        check_expression<int64_t>(numel);
+        check_expression<Z2<64, true>>(numel);
+        check_expression<Z2<128, true>>(numel);
+        check_expression<Z2<17, false>>(numel);
+    }
+}
+
+TEST(ExpressionTest, BroadcastScalars) {
+    auto x = core::make_array<int64_t>(int64_t(-3), 6);
+    auto y = core::make_array<int64_t>(int64_t(4), 6);
+    auto res = core::evaluate(x*y + x);
+    EXPECT_EQ(res.stride(), 0);
+    expect_array_eq(res, std::vector<int64_t>(6, -15));
+
+    auto mismatch = core::make_array<int64_t>(5);
+    EXPECT_THROW(core::evaluate(x + mismatch), std::invalid_argument);
+}
+
+TEST(SubstituteTest, DuplicateIndicesLastWriteWins) {
+    core::set_num_threads(4);
+    int64_t extent = 16;
+    int64_t n = 300000;
+
+    std::vector<int64_t> indicies(n);
+    std::vector<int64_t> values(n);
+    for(int64_t i = 0; i < n; ++i) {
+        indicies[i] = (i * 7) % extent - (i % 2 ? extent : 0);  // negative ones count from the end
+        values[i]   = i;
+    }
+
+    std::vector<int64_t> expected(extent, -1);
+    for(int64_t i = 0; i < n; ++i)
+        expected[ indicies[i] < 0 ? indicies[i] + extent : indicies[i] ] = values[i];
+
+    auto base = core::make_ndarray<int64_t>(int64_t(-1), {extent}, true);
+    for(int repeat = 0; repeat < 5; ++repeat) {
+        auto res = base.substitute(indicies, core::make_ndarray(values));
+        for(int64_t i = 0; i < extent; ++i)
+            ASSERT_EQ(res.elem({i}), expected[i]);
+    }
+
+    // the second set is written after the first one
+    std::vector<int64_t> idx1{0, 3, 3}, idx2{3, 5, 0};
+    auto res = base.substitute(idx1, core::make_ndarray<int64_t>({10, 11, 12}), idx2, core::make_ndarray<int64_t>({20, 21, 22}));
+    EXPECT_EQ(res.elem({0}), 22);
+    EXPECT_EQ(res.elem({3}), 20);
+    EXPECT_EQ(res.elem({5}), 21);
+    EXPECT_EQ(res.elem({1}), -1);
+    core::set_num_threads(0);
+}
+
+std::vector<uint8_t> random_bits(int64_t n, uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    std::vector<uint8_t> res(n);
+    for(auto& x: res)
+        x = gen() & 1;
+    return res;
+}
+
+/// @brief Reference packing, bit i%8 of byte i/8 holds element i.
+std::vector<uint8_t> naive_packbits(std::vector<uint8_t> const& bits)
+{
+    std::vector<uint8_t> res( (bits.size() + 7) / 8, 0 );
+    for(std::size_t i = 0; i < bits.size(); ++i)
+        res[i/8] |= bits[i] << (i%8);
+    return res;
+}
+
+TEST(PackbitsTest, RoundTrip) {
+    for(int64_t n: {0, 1, 7, 8, 9, 63, 64, 65, 1000, 1027}) {
+        auto bits = random_bits(n, n);
+        auto expected = naive_packbits(bits);
+
+        auto packed = core::packbits(core::make_ndarray(bits));
+        ASSERT_EQ(packed.numel(), static_cast<int64_t>(expected.size()));
+        for(int64_t i = 0; i < packed.numel(); ++i)
+            ASSERT_EQ(packed.elem({i}), expected[i]) << "n=" << n << " at " << i;
+
+        auto unpacked = core::unpackbits(packed);
+        ASSERT_EQ(unpacked.numel(), 8 * packed.numel());
+        for(int64_t i = 0; i < unpacked.numel(); ++i)
+            ASSERT_EQ(unpacked.elem({i}), i < n ? bits[i] : 0) << "n=" << n << " at " << i;
+
+        std::vector<bool> bools(bits.begin(), bits.end());
+        auto packed_bool = core::packbits(core::make_ndarray(bools));
+        auto unpacked_bool = core::unpackbits_bool(packed_bool);
+        for(int64_t i = 0; i < packed_bool.numel(); ++i)
+            ASSERT_EQ(packed_bool.elem({i}), expected[i]);
+        for(int64_t i = 0; i < n; ++i)
+            ASSERT_EQ(unpacked_bool.elem({i}), bool(bits[i]));
+    }
+}
+
+TEST(PackbitsTest, StridedAndAxis) {
+    int64_t rows = 5, cols = 13;
+    auto bits = random_bits(rows * cols, 42);
+    auto arr = core::make_ndarray(bits).reshape({rows, cols});
+
+    // along the rows, each row is a contiguous lane that does not fill its last byte
+    auto packed = core::packbits(arr, 1);
+    ASSERT_EQ(packed.shape(), (std::vector<int64_t>{rows, 2}));
+    for(int64_t r = 0; r < rows; ++r) {
+        auto expected = naive_packbits( std::vector<uint8_t>(bits.begin() + r*cols, bits.begin() + (r+1)*cols) );
+        for(int64_t j = 0; j < 2; ++j)
+            ASSERT_EQ(packed.elem({r, j}), expected[j]);
+    }
+
+    // along the columns, each lane is strided
+    packed = core::packbits(arr, 0);
+    ASSERT_EQ(packed.shape(), (std::vector<int64_t>{1, cols}));
+    for(int64_t c = 0; c < cols; ++c) {
+        std::vector<uint8_t> column;
+        for(int64_t r = 0; r < rows; ++r)
+            column.push_back(bits[r*cols + c]);
+        ASSERT_EQ(packed.elem({0, c}), naive_packbits(column)[0]);
+    }
+
+    // a transposed view is not linear and is flattened in logical order
+    auto flat = core::packbits(arr.transpose());
+    std::vector<uint8_t> transposed;
+    for(int64_t c = 0; c < cols; ++c)
+        for(int64_t r = 0; r < rows; ++r)
+            transposed.push_back(bits[r*cols + c]);
+    auto expected = naive_packbits(transposed);
+    ASSERT_EQ(flat.numel(), static_cast<int64_t>(expected.size()));
+    for(int64_t i = 0; i < flat.numel(); ++i)
+        ASSERT_EQ(flat.elem({i}), expected[i]);
+}
+
+TEST(BroadcastTest, ApplyKeepsScalarsLazy) {
+    auto x = core::make_ndarray<int64_t>(int64_t(-9), {3, 7});
+    auto y = core::make_ndarray<int64_t>(int64_t(4), {3, 7});
+    EXPECT_EQ(x.strides(), (std::vector<int64_t>{0, 0}));
+
+    auto neg = core::apply([](int64_t a) { return -a; }, x);
+    auto sum = core::apply([](int64_t a, int64_t b) { return a + b; }, x, y);
+    EXPECT_EQ(neg.strides(), (std::vector<int64_t>{0, 0}));
+    EXPECT_EQ(sum.strides(), (std::vector<int64_t>{0, 0}));
+    for(int64_t i = 0; i < 3; ++i)
+        for(int64_t j = 0; j < 7; ++j) {
+            ASSERT_EQ(neg.elem({i, j}), 9);
+            ASSERT_EQ(sum.elem({i, j}), -5);
+        }
+
+    // a broadcast scalar combined with a full array gives a full array
+    std::vector<int64_t> data(21);
+    for(int64_t i = 0; i < 21; ++i)
+        data[i] = i - 10;
+    auto z = core::make_ndarray(data).reshape({3, 7});
+    auto mixed = core::apply([](int64_t a, int64_t b) { return a * b; }, x, z);
+    for(int64_t i = 0; i < 3; ++i)
+        for(int64_t j = 0; j < 7; ++j)
+            ASSERT_EQ(mixed.elem({i, j}), -9 * data[i*7 + j]);
+
+    // reshaping keeps the scalar broadcast
+    auto flat = sum.reshape({21});
+    EXPECT_EQ(flat.strides(), (std::vector<int64_t>{0}));
+    EXPECT_EQ(flat.elem({20}), -5);
+
+    // empty broadcast arrays stay empty
+    auto empty = core::make_ndarray<int64_t>(int64_t(1), {0});
+    EXPECT_EQ(core::apply([](int64_t a) { return -a; }, empty).numel(), 0);
+}
+
+TEST(ArrayAsTest, SameRepresentationSharesElements) {
+    using S = Z2<64, true>;
+    using U = Z2<64, false>;
+    std::vector<S> data;
+    for(int64_t i = 0; i < 10; ++i)
+        data.push_back( S(i - 5) );
+    auto signed_arr = core::make_array(data);
+    auto strided    = core::ArrayRef<S>(signed_arr.sptr(), 5, 2, 1);
+
+    auto unsigned_arr = strided.as<U>();
+    EXPECT_FALSE( unsigned_arr.sptr() );
+    for(int64_t i = 0; i < 5; ++i)
+        ASSERT_EQ(unsigned_arr[i], U(data[2*i + 1]));
+
+    // writes go to the shared elements, and the elements outlive the original array
+    unsigned_arr[0] = U(42);
+    EXPECT_EQ(signed_arr[1], S(42));
+    signed_arr = core::make_array<S>(1);
+    strided    = core::make_array<S>(1);
+    auto back = unsigned_arr.as<S>();
+    EXPECT_EQ(back[0], S(42));
+    EXPECT_EQ(back[4], data[9]);
+
+    // an NDArrayRef needs a buffer of its own type
+    auto nd = core::unflatten(back, {5});
+    ASSERT_TRUE( nd.sptr() );
+    for(int64_t i = 1; i < 5; ++i)
+        ASSERT_EQ(nd.elem({i}), data[2*i + 1]);
+}
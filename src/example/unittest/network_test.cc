@@ -1,16 +1,24 @@
 #pragma once
 
+#include <barrier>
 #include <iostream>
 #include <vector>
 #include <string>
 #include <thread>
 #include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
 #include <random>
 
 #include "network/two_party_player.h"
 #include "network/two_party_player.hpp"
+#include "network/channel.h"
+#include "network/compression.h"
+#include "network/profile.h"
 #include "network/statistics.h"
 #include "tools/byte_vector.h"
+#include "config/config.h"
 
 #include <gtest/gtest.h>
 
@@ -145,3 +153,239 @@ TEST(NetworkTest, AssertionCommunication) {
     thread_player1.join();
     thread_player2.join();
 }
+
+TEST(NetworkTest, ChannelMultiplexing) {
+    Address local_addr = Address::from_string("127.0.0.1");
+    size_type n_threads = 1;
+    size_type n_players = 2;
+    size_type n_channels = 4;
+    std::vector<Endpoint> endpoints {
+        Endpoint(local_addr, 6670),
+        Endpoint(local_addr, 6671),
+    };
+
+    // every channel exchanges its id several times, concurrently with the other channels
+    auto run_party = [&](playerid_t my_pid) {
+        auto player = std::make_unique<PlainMultiPartyPlayer>(my_pid, n_players);
+        player->run(n_threads);
+        player->connect(endpoints);
+        network::ChannelMux mux(std::move(player));
+
+        std::vector<std::thread> jobs;
+        for(size_type i = 0; i < n_channels; ++i) {
+            // party 1 opens the channels in reverse order, so messages arrive before their channel is open
+            network::ChannelMux::channel_type channel = my_pid == 0 ? i : n_channels - 1 - i;
+            jobs.emplace_back([&mux, channel, my_pid]() {
+                auto netio = mux.open(channel);
+                for(int round = 0; round < 10; ++round) {
+                    int value = channel * 100 + round;
+                    ByteVector msg;
+                    msg.push_back(&value, sizeof(value));
+                    ByteVector msg_recv = netio->exchange(1 - my_pid, move(msg));
+                    int value_recv;
+                    memcpy(&value_recv, msg_recv.data(), sizeof(value_recv));
+                    EXPECT_EQ(value_recv, value);
+                }
+                netio->sync();
+                auto ss = netio->get_statistics();
+                EXPECT_EQ(ss.rounds, 10);
+                EXPECT_EQ(ss.bytes_recv[1 - my_pid], 10 * sizeof(int) + 4);
+            });
+        }
+        for(auto& t: jobs)
+            t.join();
+        EXPECT_EQ(mux.num_open(), 0);
+        EXPECT_THROW(mux.open(network::ChannelMux::CLOSE_CHANNEL), std::invalid_argument);
+        mux.close();
+    };
+
+    auto thread_player1 = std::thread(run_party, 1);
+    run_party(0);
+    thread_player1.join();
+}
+
+ByteVector compression_input(std::string const& kind, size_type n) {
+    ByteVector res(n);
+    std::mt19937_64 gen(n);
+    for(size_type i = 0; i < n; ++i) {
+        if( kind == "random" )
+            res.data()[i] = static_cast<std::byte>(gen());
+        else if( kind == "zeros" )
+            res.data()[i] = std::byte(0);
+        else /* text like, with repeats at various distances */
+            res.data()[i] = static_cast<std::byte>("abcabcabdabcabcabcxyz"[ (i * 7 / 5 + i / 1000) % 21 ]);
+    }
+    return res;
+}
+
+TEST(NetworkTest, ChannelMuxCloseAfterShutdown) {
+    Address local_addr = Address::from_string("127.0.0.1");
+    size_type n_threads = 1;
+    size_type n_players = 2;
+    std::vector<Endpoint> endpoints {
+        Endpoint(local_addr, 6675),
+        Endpoint(local_addr, 6676),
+    };
+    std::barrier exchanged(2);
+
+    auto run_party = [&](playerid_t my_pid) {
+        auto player = std::make_unique<PlainMultiPartyPlayer>(my_pid, n_players);
+        player->run(n_threads);
+        player->connect(endpoints);
+        network::ChannelMux mux(std::move(player));
+        {
+            auto netio = mux.open(0);
+            netio->exchange(1 - my_pid, init_1());
+        }
+        // a shutdown may drop messages still in flight, so both parties finish the exchange first
+        exchanged.arrive_and_wait();
+
+        // party 1 drops its connections, so its close message cannot be sent and party 0 never receives one
+        if( my_pid == 1 )
+            mux.player()->shutdown();
+        EXPECT_ANY_THROW(mux.close());
+        // the readers are joined even though close failed, closing again does nothing
+        EXPECT_NO_THROW(mux.close());
+        EXPECT_THROW(mux.open(1), std::runtime_error);
+    };
+
+    auto thread_player1 = std::thread(run_party, 1);
+    run_party(0);
+    thread_player1.join();
+}
+
+TEST(NetworkTest, RoundsPerExchange) {
+    Address local_addr = Address::from_string("127.0.0.1");
+    size_type n_threads = 1;
+    size_type n_players = 3;
+    std::vector<Endpoint> endpoints {
+        Endpoint(local_addr, 6672),
+        Endpoint(local_addr, 6673),
+        Endpoint(local_addr, 6674),
+    };
+
+    auto run_party = [&](playerid_t my_pid) {
+        PlainMultiPartyPlayer player(my_pid, n_players);
+        player.run(n_threads);
+        player.connect(endpoints);
+
+        // one round received from every peer separately
+        player.broadcast(init_1());
+        for(auto peer: player.all_but_me())
+            player.recv(peer);
+        EXPECT_EQ(player.get_statistics().rounds, 1);
+
+        // the same round received at once
+        player.broadcast(init_1());
+        player.mrecv(player.all_but_me());
+        EXPECT_EQ(player.get_statistics().rounds, 2);
+
+        // operations which send then receive are a round each
+        player.broadcast_recv(init_1());
+        player.mbroadcast_recv(player.all_but_me(), init_1());
+        EXPECT_EQ(player.get_statistics().rounds, 4);
+
+        // a receive with no send since the previous receive joins its round
+        player.broadcast(init_1());
+        player.broadcast(init_1());
+        player.mrecv(player.all_but_me());
+        player.mrecv(player.all_but_me());
+        EXPECT_EQ(player.get_statistics().rounds, 5);
+    };
+
+    auto thread_player1 = std::thread(run_party, 1);
+    auto thread_player2 = std::thread(run_party, 2);
+    run_party(0);
+    thread_player1.join();
+    thread_player2.join();
+}
+
+TEST(CompressionTest, BlockRoundTrip) {
+    for(string kind: {"random", "zeros", "text"}) {
+        for(size_type n: {0, 1, 12, 13, 100, 4096, 70000, 1 << 20}) {
+            auto message = compression_input(kind, n);
+            std::vector<std::byte> block(n + n / 255 + 16);
+            size_type c = network::compress_block(message.data(), n, block.data(), block.size());
+            ASSERT_GT(c, 0u) << kind << " " << n;
+
+            ByteVector restored(n);
+            network::decompress_block(block.data(), c, restored.data(), n);
+            ASSERT_TRUE(restored == message) << kind << " " << n;
+
+            ByteVector frame;
+            if( network::compress_frame(message, frame) ) {
+                ASSERT_LT(frame.size(), n);
+                ASSERT_TRUE(network::decompress_frame(frame) == message) << kind << " " << n;
+            } else {
+                // only messages which do not shrink are sent as is
+                ASSERT_TRUE(kind == "random" || n <= 13) << kind << " " << n;
+            }
+        }
+    }
+}
+
+TEST(CompressionTest, RejectsTruncatedAndCorruptFrames) {
+    auto message = compression_input("text", 100000);
+    ByteVector frame;
+    ASSERT_TRUE(network::compress_frame(message, frame));
+
+    // every truncation is rejected, including the bare header
+    for(size_type len = 0; len < frame.size(); len += 1 + len / 16) {
+        ByteVector truncated(frame.data(), len);
+        EXPECT_THROW(network::decompress_frame(truncated), std::runtime_error) << len;
+    }
+
+    // a header claiming more than the block can expand to is rejected before allocating
+    for(size_type n: {size_type(1) << 40, ~network::COMPRESSED_FRAME, size_type(255) * (frame.size() - 8) + 255}) {
+        ByteVector forged = frame.copy();
+        memcpy(forged.data(), &n, sizeof(n));
+        EXPECT_THROW(network::decompress_frame(forged), std::runtime_error) << n;
+    }
+    ByteVector shorter = frame.copy();
+    size_type n = message.size() - 1;
+    memcpy(shorter.data(), &n, sizeof(n));
+    EXPECT_THROW(network::decompress_frame(shorter), std::runtime_error);
+
+    // flipped bytes never read or write out of bounds, the size is exact whenever decoding succeeds
+    std::mt19937_64 gen(7);
+    for(int i = 0; i < 2000; ++i) {
+        ByteVector corrupt = frame.copy();
+        size_type pos = sizeof(size_type) + gen() % (corrupt.size() - sizeof(size_type));
+        corrupt.data()[pos] ^= static_cast<std::byte>(1 + gen() % 255);
+        try {
+            auto restored = network::decompress_frame(corrupt);
+            EXPECT_EQ(restored.size(), message.size());
+        } catch(std::runtime_error const&) {
+        }
+    }
+}
+
+/// @brief Load the profile of a config file holding the given network section.
+network::NetworkProfile load_profile_from(std::string const& section_body)
+{
+    std::string path = "network_profile_test.conf";
+    {
+        std::ofstream out(path);
+        out << "[network]\n" << section_body;
+    }
+    ConfigFile conf(path);
+    std::remove(path.c_str());
+    return network::load_network_profile(conf);
+}
+
+TEST(NetworkProfileTest, RejectsInvalidValues) {
+    EXPECT_EQ(network::parse_network_profile("2:10").to_string(), "custom (2Gbps, 10ms)");
+    EXPECT_THROW(network::parse_network_profile("0:10"), std::invalid_argument);
+    EXPECT_THROW(network::parse_network_profile("-1:10"), std::invalid_argument);
+    EXPECT_THROW(network::parse_network_profile("1:-5"), std::invalid_argument);
+    EXPECT_THROW(network::parse_network_profile("fast:10"), std::invalid_argument);
+
+    // a config file is checked the same way
+    EXPECT_EQ(load_profile_from("profile=wan\nrtt=20\n").to_string(), "wan (0.1Gbps, 20ms)");
+    EXPECT_EQ(load_profile_from("").to_string(), network::find_network_profile("none").to_string());
+    EXPECT_THROW(load_profile_from("bitrate=0\n"), std::invalid_argument);
+    EXPECT_THROW(load_profile_from("bitrate=-2\nrtt=10\n"), std::invalid_argument);
+    EXPECT_THROW(load_profile_from("profile=lan\nrtt=-1\n"), std::invalid_argument);
+    EXPECT_THROW(load_profile_from("bitrate=fast\n"), std::invalid_argument);
+    EXPECT_THROW(load_profile_from("profile=moon\n"), std::invalid_argument);
+}
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "datatypes/Z2k.hpp"
+#include "ndarray/array_ref.hpp"
+#include "ndarray/ndarray_ref.hpp"
+#include "ndarray/serialization.hpp"
+#include "serialization/serialization.hpp"
+
+#include <gtest/gtest.h>
+
+template <typename dtype>
+std::vector<dtype> random_vector(int64_t n, uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    std::vector<dtype> res;
+    res.reserve(n);
+    for(int64_t i = 0; i < n; ++i)
+        res.push_back( dtype(gen()) );
+    return res;
+}
+
+/// @brief Serialize an object, checking that serialized_size is exact.
+template <typename T>
+ByteVector to_bytes(T const& x)
+{
+    Serializer sr;
+    sr << x;
+    ByteVector bytes = std::move(sr.finalize());
+    EXPECT_EQ(bytes.size(), serialized_size(x));
+    return bytes;
+}
+
+/// @brief Deserialize an ArrayRef into a new array.
+template <typename dtype>
+core::ArrayRef<dtype> get_array(Deserializer& dr)
+{
+    auto arr = core::make_array<dtype>(0);
+    dr >> arr;
+    return arr;
+}
+
+template <typename dtype>
+void expect_array_eq(core::ArrayRef<dtype> const& arr, std::vector<dtype> const& expected)
+{
+    ASSERT_EQ(arr.numel(), static_cast<int64_t>(expected.size()));
+    for(int64_t i = 0; i < arr.numel(); ++i)
+        ASSERT_TRUE(arr[i] == expected[i]) << "at " << i;
+}
+
+template <typename dtype>
+void check_array_round_trip(int64_t numel)
+{
+    auto data = random_vector<dtype>(numel, numel);
+
+    // compact
+    Deserializer dr( to_bytes(core::make_array(data)) );
+    expect_array_eq(get_array<dtype>(dr), data);
+
+    // strided view of every other element
+    std::vector<dtype> doubled;
+    for(auto const& x: data) {
+        doubled.push_back(x);
+        doubled.push_back(dtype(0));
+    }
+    auto strided = core::ArrayRef<dtype>(core::make_array(doubled).sptr(), numel, 2, 0);
+    Deserializer dr2( to_bytes(strided) );
+    expect_array_eq(get_array<dtype>(dr2), data);
+
+    // broadcast
+    auto value = dtype(-5);
+    Deserializer dr3( to_bytes(core::make_array(value, numel)) );
+    expect_array_eq(get_array<dtype>(dr3), std::vector<dtype>(numel, value));
+
+    // into a uniquely owned array of the same size, which is overwritten in place
+    auto target = core::make_array<dtype>(numel);
+    auto target_data = target.data();
+    Deserializer dr4( to_bytes(core::make_array(data)) );
+    dr4 >> target;
+    expect_array_eq(target, data);
+    if( numel > 0 )
+        EXPECT_EQ(target.data(), target_data);
+}
+
+template <typename dtype>
+void check_ndarray_round_trip(int64_t rows, int64_t cols)
+{
+    auto data = random_vector<dtype>(rows * cols, rows + cols);
+    auto arr = core::make_ndarray(data).reshape({rows, cols}).transpose();
+
+    Deserializer dr( to_bytes(arr) );
+    auto res = dr.get<core::NDArrayRef<dtype>>();
+    ASSERT_EQ(res.shape(), (std::vector<int64_t>{cols, rows}));
+    for(int64_t i = 0; i < cols; ++i)
+        for(int64_t j = 0; j < rows; ++j)
+            ASSERT_TRUE(res.elem({i, j}) == data[j*cols + i]);
+}
+
+TEST(SerializationTest, ArrayRoundTrip) {
+    for(int64_t numel: {0, 1, 3, 64, 1001}) {
+        check_array_round_trip<int64_t>(numel);
+        check_array_round_trip<int16_t>(numel);
+        check_array_round_trip<double>(numel);
+        check_array_round_trip<Z2<64, true>>(numel);
+        check_array_round_trip<Z2<128, true>>(numel);
+    }
+}
+
+TEST(SerializationTest, NDArrayRoundTrip) {
+    check_ndarray_round_trip<int64_t>(3, 7);
+    check_ndarray_round_trip<Z2<64, true>>(1, 9);
+    check_ndarray_round_trip<Z2<128, false>>(9, 1);
+    check_ndarray_round_trip<int32_t>(0, 4);
+}
+
+template <typename dtype>
+std::vector<dtype> random_ring_vector(int64_t n, uint64_t seed)
+{
+    std::mt19937_64 gen(seed);
+    std::vector<dtype> res;
+    // the extremes and small negative values first, then random full width values
+    for(auto x: {dtype::min(), dtype::max(), dtype(-1), dtype(-2), dtype(0), dtype(1)})
+        if( static_cast<int64_t>(res.size()) < n )
+            res.push_back(x);
+    while( static_cast<int64_t>(res.size()) < n ) {
+        __int128 hi = gen(), lo = gen();
+        res.push_back( dtype( (hi << 64) | lo ) );
+    }
+    return res;
+}
+
+template <std::size_t K, bool Signed>
+void check_packed_round_trip()
+{
+    using dtype = Z2<K, Signed>;
+    static_assert( detail::PackedSerializable<dtype> );
+
+    for(int64_t numel: {0, 1, 5, 63, 64, 65, 129, 1000}) {
+        auto data = random_ring_vector<dtype>(numel, numel * K);
+
+        auto bytes = to_bytes(core::make_array(data));
+        EXPECT_EQ(bytes.size(), sizeof(std::size_t) + (numel * K + 7) / 8);
+        Deserializer dr( std::move(bytes) );
+        expect_array_eq(get_array<dtype>(dr), data);
+
+        // strided and broadcast sources pack the same elements
+        std::vector<dtype> doubled;
+        for(auto const& x: data) {
+            doubled.push_back(x);
+            doubled.push_back(dtype(-1));
+        }
+        Deserializer dr2( to_bytes(core::ArrayRef<dtype>(core::make_array(doubled).sptr(), numel, 2, 0)) );
+        expect_array_eq(get_array<dtype>(dr2), data);
+
+        Deserializer dr3( to_bytes(core::make_array(dtype(-3), numel)) );
+        expect_array_eq(get_array<dtype>(dr3), std::vector<dtype>(numel, dtype(-3)));
+
+        // NDArrayRef takes the same packed path
+        Deserializer dr4( to_bytes(core::make_ndarray(data)) );
+        auto nd = dr4.get<core::NDArrayRef<dtype>>();
+        ASSERT_EQ(nd.numel(), numel);
+        for(int64_t i = 0; i < numel; ++i)
+            ASSERT_TRUE(nd.elem({i}) == data[i]);
+    }
+}
+
+TEST(SerializationTest, PackedWidthsRoundTrip) {
+    check_packed_round_trip<1,   false>();
+    check_packed_round_trip<3,   true >();
+    check_packed_round_trip<7,   false>();
+    check_packed_round_trip<13,  true >();
+    check_packed_round_trip<31,  true >();
+    check_packed_round_trip<33,  false>();
+    check_packed_round_trip<40,  true >();
+    check_packed_round_trip<63,  true >();
+    check_packed_round_trip<65,  true >();
+    check_packed_round_trip<100, false>();
+    check_packed_round_trip<127, true >();
+}
+
+TEST(SerializationTest, FullWidthIsNotPacked) {
+    static_assert( !detail::PackedSerializable<Z2<64, true>> );
+    static_assert( !detail::PackedSerializable<Z2<128, false>> );
+    auto arr = core::make_array<Z2<64, true>>(10);
+    EXPECT_EQ(to_bytes(arr).size(), sizeof(std::size_t) + 10 * sizeof(uint64_t));
+}
+
+/// @brief Message holding a length prefix followed by nbytes bytes.
+ByteVector message_with_length(std::size_t numel, std::size_t nbytes)
+{
+    ByteVector message;
+    message.push_back(&numel, sizeof(numel));
+    std::vector<std::byte> payload(nbytes, std::byte(0x5a));
+    if( nbytes > 0 )
+        message.push_back(payload.data(), nbytes);
+    return message;
+}
+
+TEST(SerializationTest, WireLengthsAreChecked) {
+    // lengths whose byte count wraps around or exceeds the message are rejected before allocating
+    for(std::size_t numel: {std::size_t(3), std::size_t(1) << 61, (std::size_t(1) << 61) + 1, ~std::size_t(0)}) {
+        Deserializer dr( message_with_length(numel, 16) );
+        EXPECT_THROW(deserialize_borrowed<uint64_t>(dr), deserialization_error) << numel;
+
+        auto shared = std::make_shared<const ByteVector>( message_with_length(numel, 16) );
+        EXPECT_THROW(borrow_array<uint64_t>(shared), deserialization_error) << numel;
+
+        Deserializer dr2( message_with_length(numel, 16) );
+        auto arr = core::make_array<uint64_t>(0);
+        EXPECT_THROW(dr2 >> arr, deserialization_error) << numel;
+
+        // 40 bit elements, so the payload fits at most 3 of them
+        Deserializer dr3( message_with_length(numel == 3 ? 4 : numel, 16) );
+        auto packed = core::make_array<Z2<40, true>>(0);
+        EXPECT_THROW(dr3 >> packed, deserialization_error) << numel;
+
+        Deserializer dr4( message_with_length(numel, 16) );
+        std::vector<uint64_t> vec;
+        EXPECT_THROW(dr4 >> vec, deserialization_error) << numel;
+    }
+
+    // exact payloads are accepted
+    Deserializer dr( message_with_length(2, 16) );
+    EXPECT_EQ(deserialize_borrowed<uint64_t>(dr).numel(), 2);
+    EXPECT_EQ(borrow_array<uint64_t>(std::make_shared<const ByteVector>(message_with_length(2, 16))).numel(), 2);
+    Deserializer dr2( message_with_length(3, 15) );
+    auto packed = core::make_array<Z2<40, true>>(0);
+    dr2 >> packed;
+    EXPECT_EQ(packed.numel(), 3);
+
+    // shapes whose product overflows or is negative
+    for(auto shape: {std::vector<int64_t>{int64_t(1) << 40, int64_t(1) << 40}, std::vector<int64_t>{-1, 2},
+                     std::vector<int64_t>{int64_t(1) << 62, 4, 4}}) {
+        Serializer sr;
+        sr << shape;
+        Deserializer dr3( std::move(sr.finalize()) );
+        EXPECT_THROW(dr3.get<core::NDArrayRef<uint64_t>>(), deserialization_error);
+    }
+}
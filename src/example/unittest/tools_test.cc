@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tools/bit_transpose.h"
+#include "tools/trace.h"
+
+#include <gtest/gtest.h>
+
+/// @brief Reference transpose, bit j of out[i] is bit i of in[j].
+std::vector<uint64_t> naive_transpose64(std::vector<uint64_t> const& in)
+{
+    std::vector<uint64_t> out(64, 0);
+    for(int i = 0; i < 64; ++i)
+        for(int j = 0; j < 64; ++j)
+            out[i] |= ( (in[j] >> i) & 1 ) << j;
+    return out;
+}
+
+/// @brief Bit b of the little endian object representation of x.
+template <typename T>
+int bit_of(T const& x, int64_t b)
+{
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &x, sizeof(T));
+    return ( bytes[b / 8] >> (b % 8) ) & 1;
+}
+
+/// @brief Compare split_bit_planes with reading every bit of every element.
+template <typename T, typename Out>
+void check_split_bit_planes(int64_t numel, int64_t stride, int64_t nplanes)
+{
+    std::mt19937_64 gen(numel * 131 + stride * 7 + nplanes);
+    std::vector<T> src(numel * stride + 1);
+    for(auto& x: src) {
+        unsigned char bytes[sizeof(T)];
+        for(auto& c: bytes)
+            c = static_cast<unsigned char>(gen());
+        std::memcpy(&x, bytes, sizeof(T));
+    }
+
+    std::vector<std::vector<Out>> planes(nplanes, std::vector<Out>(numel + 1, Out(7)));
+    std::vector<Out*> dest;
+    for(auto& p: planes)
+        dest.push_back(p.data());
+    split_bit_planes(src.data() + 1, stride, numel, nplanes, dest.data());
+
+    for(int64_t b = 0; b < nplanes; ++b) {
+        for(int64_t e = 0; e < numel; ++e)
+            ASSERT_EQ(planes[b][e], Out( bit_of(src[1 + e * stride], b) ))
+                << "numel " << numel << " stride " << stride << " plane " << b << " element " << e;
+        ASSERT_EQ(planes[b][numel], Out(7)) << "plane " << b << " written past numel";
+    }
+}
+
+TEST(BitTransposeTest, Transpose64MatchesNaive) {
+    std::mt19937_64 gen(64);
+    for(int round = 0; round < 20; ++round) {
+        // round 0 is all zeros, round 1 a single bit which shows the direction of the transpose
+        std::vector<uint64_t> m(64, 0);
+        if( round == 1 )
+            m[3] = uint64_t(1) << 40;
+        if( round > 1 )
+            for(auto& x: m)
+                x = gen();
+
+        auto expected = naive_transpose64(m);
+        auto actual   = m;
+        transpose64(actual.data());
+        ASSERT_EQ(actual, expected) << "round " << round;
+        if( round == 1 )
+            EXPECT_EQ(actual[40], uint64_t(1) << 3);
+
+        transpose64(actual.data());
+        ASSERT_EQ(actual, m) << "round " << round;
+    }
+}
+
+TEST(BitTransposeTest, SplitBitPlanesMatchesNaive) {
+    for(int64_t numel: {0, 1, 63, 64, 65, 511, 512, 513, 1000}) {
+        for(int64_t stride: {1, 3}) {
+            check_split_bit_planes<uint32_t, uint8_t>(numel, stride, 32);
+            check_split_bit_planes<uint32_t, int>(numel, stride, 17);
+            check_split_bit_planes<uint16_t, uint8_t>(numel, stride, 16);
+            check_split_bit_planes<uint64_t, uint8_t>(numel, stride, 64);
+            check_split_bit_planes<unsigned __int128, uint8_t>(numel, stride, 128);
+            check_split_bit_planes<unsigned __int128, int>(numel, stride, 100);
+        }
+    }
+}
+
+/// @struct Json
+/// @brief Parsed JSON value, enough to check the exported traces.
+struct Json
+{
+    enum Kind { Null, Bool, Number, String, Array, Object } kind = Null;
+    double                      number = 0;
+    std::string                 str;
+    std::vector<Json>           items;
+    std::map<std::string, Json> fields;
+
+    Json const& operator[](std::string const& key) const { return fields.at(key); }
+};
+
+/// @class JsonParser
+/// @brief Strict recursive descent JSON parser, throws std::runtime_error at the first error.
+class JsonParser
+{
+  public:
+    explicit JsonParser(std::string const& text) : _text(text) {}
+
+    Json parse()
+    {
+        Json ans = value();
+        skip_space();
+        if( _pos != _text.size() )
+            fail("trailing characters");
+        return ans;
+    }
+
+  private:
+    std::string const& _text;
+    std::size_t        _pos = 0;
+
+    [[noreturn]] void fail(std::string const& what)
+    {
+        throw std::runtime_error("json: " + what + " at " + std::to_string(_pos));
+    }
+
+    void skip_space()
+    {
+        while( _pos < _text.size() && std::strchr(" \t\r\n", _text[_pos]) )
+            ++_pos;
+    }
+
+    char peek()
+    {
+        skip_space();
+        if( _pos == _text.size() )
+            fail("unexpected end");
+        return _text[_pos];
+    }
+
+    void expect(char c)
+    {
+        if( peek() != c )
+            fail(std::string("expected ") + c);
+        ++_pos;
+    }
+
+    void literal(const char* word)
+    {
+        if( _text.compare(_pos, std::strlen(word), word) != 0 )
+            fail("bad literal");
+        _pos += std::strlen(word);
+    }
+
+    Json value()
+    {
+        Json ans;
+        char c = peek();
+        if( c == '{' ) {
+            ans.kind = Json::Object;
+            ++_pos;
+            if( peek() == '}' ) { ++_pos; return ans; }
+            while( true ) {
+                std::string key = string();
+                expect(':');
+                if( !ans.fields.emplace(key, value()).second )
+                    fail("duplicate key " + key);
+                if( peek() == '}' ) { ++_pos; return ans; }
+                expect(',');
+            }
+        }
+        if( c == '[' ) {
+            ans.kind = Json::Array;
+            ++_pos;
+            if( peek() == ']' ) { ++_pos; return ans; }
+            while( true ) {
+                ans.items.push_back( value() );
+                if( peek() == ']' ) { ++_pos; return ans; }
+                expect(',');
+            }
+        }
+        if( c == '"' ) {
+            ans.kind = Json::String;
+            ans.str  = string();
+            return ans;
+        }
+        if( c == 't' ) { literal("true");  ans.kind = Json::Bool; ans.number = 1; return ans; }
+        if( c == 'f' ) { literal("false"); ans.kind = Json::Bool; return ans; }
+        if( c == 'n' ) { literal("null");  return ans; }
+
+        std::size_t begin = _pos;
+        if( _text[_pos] == '-' ) ++_pos;
+        auto digits = [&] {
+            std::size_t from = _pos;
+            while( _pos < _text.size() && std::isdigit(static_cast<unsigned char>(_text[_pos])) ) ++_pos;
+            if( _pos == from ) fail("expected digit");
+        };
+        digits();
+        if( _pos < _text.size() && _text[_pos] == '.' ) { ++_pos; digits(); }
+        if( _pos < _text.size() && (_text[_pos] == 'e' || _text[_pos] == 'E') ) {
+            ++_pos;
+            if( _pos < _text.size() && (_text[_pos] == '+' || _text[_pos] == '-') ) ++_pos;
+            digits();
+        }
+        ans.kind   = Json::Number;
+        ans.number = std::strtod(_text.substr(begin, _pos - begin).c_str(), nullptr);
+        return ans;
+    }
+
+    std::string string()
+    {
+        expect('"');
+        std::string ans;
+        while( true ) {
+            if( _pos == _text.size() )
+                fail("unterminated string");
+            unsigned char c = _text[_pos++];
+            if( c == '"' )
+                return ans;
+            if( c < 0x20 )
+                fail("control character in string");
+            if( c != '\\' ) {
+                ans += static_cast<char>(c);
+                continue;
+            }
+            if( _pos == _text.size() )
+                fail("unterminated escape");
+            switch( char e = _text[_pos++] ) {
+                case '"': case '\\': case '/': ans += e; break;
+                case 'b': ans += '\b'; break;
+                case 'f': ans += '\f'; break;
+                case 'n': ans += '\n'; break;
+                case 'r': ans += '\r'; break;
+                case 't': ans += '\t'; break;
+                case 'u': {
+                    if( _pos + 4 > _text.size() )
+                        fail("short unicode escape");
+                    auto code = std::stoul(_text.substr(_pos, 4), nullptr, 16);
+                    if( code >= 0x80 )
+                        fail("unicode escape outside ascii");
+                    ans += static_cast<char>(code);
+                    _pos += 4;
+                    break;
+                }
+                default: fail("bad escape");
+            }
+        }
+    }
+};
+
+/// @brief Parse an exported Chrome trace, checking the fields every event has.
+std::vector<Json> parse_trace_events(std::string const& text, int64_t pid)
+{
+    Json trace = JsonParser(text).parse();
+    EXPECT_EQ(trace.kind, Json::Object);
+    auto const& events = trace["traceEvents"];
+    EXPECT_EQ(events.kind, Json::Array);
+    for(auto const& e: events.items) {
+        EXPECT_EQ(e["name"].kind, Json::String);
+        EXPECT_EQ(e["cat"].kind, Json::String);
+        EXPECT_EQ(e["ph"].str, "X");
+        EXPECT_EQ(e["ts"].kind, Json::Number);
+        EXPECT_GE(e["dur"].number, 0);
+        EXPECT_EQ(e["pid"].number, pid);
+        EXPECT_EQ(e["tid"].kind, Json::Number);
+    }
+    return events.items;
+}
+
+TEST(TraceTest, ChromeTraceIsValidJson) {
+    // names are not copied, so they must outlive the export
+    static const std::string long_name(2000, 'x');
+    static const char* special = "quote\" backslash\\ newline\n tab\t bell\x07 end";
+
+    trace::clear();
+    trace::enable();
+    { trace::Span span("plain", "test"); }
+    { trace::Span span(special, "te\"st"); }
+    { trace::Span span(long_name.c_str()); }
+    trace::record("send", "network", Timer::Clock::now(), Timer::DurationType(0), 12345);
+    trace::enable(false);
+    { trace::Span span("disabled"); }
+
+    auto events = parse_trace_events(trace::chrome_trace(7), 7);
+    trace::clear();
+
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events[0]["name"].str, "plain");
+    EXPECT_EQ(events[0]["cat"].str, "test");
+    EXPECT_EQ(events[0].fields.count("args"), 0);
+    EXPECT_EQ(events[1]["name"].str, special);
+    EXPECT_EQ(events[1]["cat"].str, "te\"st");
+    EXPECT_EQ(events[2]["name"].str, long_name);
+    EXPECT_EQ(events[2]["cat"].str, "pppu");
+    EXPECT_EQ(events[3]["name"].str, "send");
+    EXPECT_EQ(events[3]["args"]["bytes"].number, 12345);
+}
+
+TEST(TraceTest, MergedTracesAreValidJson) {
+    static const char* special = "two\nlines";
+    std::vector<std::string> paths;
+    for(int64_t pid = 0; pid < 2; ++pid) {
+        trace::clear();
+        trace::enable();
+        { trace::Span span(special); }
+        { trace::Span span("other"); }
+        trace::enable(false);
+        paths.push_back( "trace_test_" + std::to_string(pid) + ".json" );
+        trace::write_chrome_trace(paths.back(), pid);
+    }
+    trace::clear();
+    trace::merge_chrome_traces("trace_test_merged.json", paths);
+
+    std::ifstream in("trace_test_merged.json");
+    std::string text( (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>() );
+    in.close();
+    for(auto const& path: paths)
+        std::remove(path.c_str());
+    std::remove("trace_test_merged.json");
+
+    Json trace = JsonParser(text).parse();
+    auto const& events = trace["traceEvents"].items;
+    ASSERT_EQ(events.size(), 4);
+    for(int64_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(events[i]["pid"].number, i / 2);
+        EXPECT_EQ(events[i]["name"].str, i % 2 == 0 ? special : "other");
+    }
+}
@@ -10,9 +10,9 @@ using ProtocolTriple = mpc::Semi2kTriple;
 std::unique_ptr<network::MultiPartyPlayer> make_netio(
     playerid_t pid,
     std::size_t num_parties,
-    std::string ssl_dir
+    std::string ssl_dir,
+    int base_port
 ) {
-    int base_port = 7777;
     int num_threads = 1;
 
     std::vector<tcp::endpoint> endpoints;
@@ -108,6 +108,51 @@ std::shared_ptr<pppu::Context> run_player(std::size_t pid, std::size_t num_parti
     return context;
 }
 
+std::shared_ptr<pppu::Context> run_sharded_player(std::size_t pid, std::size_t num_parties, std::size_t num_shards) {
+    int base_port = 7777;
+    auto context = run_player(pid, num_parties);
+
+    // every shard has its own connections, on the ports following those of the main context
+    std::vector<std::unique_ptr<pppu::Context>> shards;
+    for(std::size_t i = 0; i < num_shards; ++i) {
+        auto netio = make_netio(pid, num_parties, "", base_port + (i + 1) * num_parties);
+        auto [prot, prep] = make_protocol<ProtocolType, ProtocolTriple>(netio.get());
+        shards.push_back( std::make_unique<pppu::Context>(*context->config(), std::move(prot), std::move(prep), std::move(netio)) );
+    }
+    context->set_shards(std::move(shards));
+    return context;
+}
+
+std::unique_ptr<pppu::Session<ProtocolType>> run_session(std::size_t pid, std::size_t num_parties, int base_port) {
+    int64_t fxp_fracbits = 40;
+    int64_t fxp_security_parameter = 3;
+
+    // connect once, every job of the session runs on a channel of these connections
+    auto netio = make_netio(pid, num_parties, "", base_port);
+    auto conf = make_config(fxp_security_parameter, fxp_fracbits);
+    return std::make_unique<pppu::Session<ProtocolType>>(conf, std::move(netio));
+}
+
+void apply_network_profile(network::MultiPartyPlayer* netio, network::NetworkProfile const& profile) {
+    if(auto plain_player = dynamic_cast<network::PlainMultiPartyPlayer*>(netio)) {
+        plain_player->set_profile(profile);
+    }
+    else if(auto secure_player = dynamic_cast<network::SecureMultiPartyPlayer*>(netio)) {
+        secure_player->set_profile(profile);
+    }
+    else {
+        throw std::invalid_argument("network profiles need a socket player");
+    }
+}
+
+void apply_network_profile(pppu::Context* ctx, network::NetworkProfile const& profile) {
+    // the shards of a context have connections of their own
+    for(std::size_t i = 0; i < ctx->num_shards(); ++i) {
+        apply_network_profile(ctx->shard(i), profile);
+    }
+    apply_network_profile(ctx->netio(), profile);
+}
+
 int rand_32() {
     std::random_device rd;
     std::default_random_engine r_eng(rd());
@@ -13,6 +13,8 @@
 #include "context/basic/factory.hpp"
 #include "context/basic/basic.hpp"
 #include "context/basic/util.hpp"
+#include "context/session.h"
+#include "context/session.hpp"
 #include "datatypes/Z2k.h"
 #include "datatypes/Z2k.hpp"
 #include "mpc/protocol.hpp"
@@ -21,6 +23,7 @@
 #include "network/network.hpp"
 #include "network/multi_party_player.h"
 #include "network/multi_party_player.hpp"
+#include "network/profile.h"
 #include "ndarray/ndarray_ref.h"
 #include "ndarray/ndarray_ref.hpp"
 #include "serialization/serialization.hpp"
@@ -37,7 +40,8 @@
 std::unique_ptr<network::MultiPartyPlayer> make_netio(
     playerid_t pid,
     std::size_t num_parties,
-    std::string ssl_dir
+    std::string ssl_dir,
+    int base_port = 7777
 );
 
 template <typename ProtocolType, typename ProtocolTriple>
@@ -57,6 +61,12 @@ std::shared_ptr<pppu::Context> make_context(
     std::unique_ptr<network::MultiPartyPlayer> netio
 );
 
+std::shared_ptr<pppu::Context> run_player(std::size_t pid, std::size_t num_parties);
+std::shared_ptr<pppu::Context> run_sharded_player(std::size_t pid, std::size_t num_parties, std::size_t num_shards);
+std::unique_ptr<pppu::Session<mpc::Semi2k>> run_session(std::size_t pid, std::size_t num_parties, int base_port = 7777);
+void apply_network_profile(network::MultiPartyPlayer* netio, network::NetworkProfile const& profile);
+void apply_network_profile(pppu::Context* ctx, network::NetworkProfile const& profile);
+
 int rand_32();
 float rand_f();
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdlib>
+#include <optional>
+#include <random>
 
 #include "mpc/protocol.hpp"
 #include "mpc/preprocessing.hpp"
@@ -8,12 +10,16 @@
 #include "../../ndarray/array_ref.hpp"
 #include "../../ndarray/ndarray_ref.hpp"
 #include "../../ndarray/operations.hpp"
+#include "../../ndarray/expression.hpp"
 #include "../../network/multi_party_player.hpp"
 #include "../../network/playerid.h"
 #include "../../network/multi_party_player.hpp"
 #include "../../datatypes/Z2k.hpp"
 #include "../../ndarray/tools.hpp"
+#include "../../serialization/borrowed_array.h"
 #include "../../serialization/stl.h"
+#include "../../tools/bit_transpose.h"
+#include "../../tools/trace.h"
 #include <map>
 
 namespace mpc{
@@ -25,10 +31,52 @@ using core::ArrayRef, core::NDArrayRef;
 /// @class Semi2kTripl
 /// @brief Multiplication triplet used in Semi2k protocol.
 class Semi2kTriple: public mpc::Preprocessing{
+    /// @brief Dealer emulated by a seed which every party shares, empty for the zero preprocessing.
+    std::optional<std::mt19937_64> dealer;
+    playerid_t playerid  = 0;
+    size_t     n_players = 1;
+
+    /// @brief Draw n values of the dealer.
+    template<size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> deal(size_t n)
+    {
+        auto values = core::make_array<Z2<K, Signed>>(n);
+        for(size_t i = 0; i != n; ++i) {
+            Z2<K, Signed> x( (*dealer)() );
+            for(size_t k = 64; k < K; k += 64)
+                x = (x << 64) + Z2<K, Signed>( (*dealer)() );
+            values[i] = x;
+        }
+        return values;
+    }
+
+    /// @brief Return my additive share of values, the dealer draws the shares of every party.
+    template<size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> share(ArrayRef<Z2<K, Signed>> const& values)
+    {
+        auto mine = core::make_array<Z2<K, Signed>>(values.numel());
+        auto rest = values;
+        for(size_t p = 1; p != n_players; ++p) {
+            auto s = deal<K, Signed>(values.numel());
+            if( p == playerid )
+                mine = s;
+            rest = core::evaluate(rest - s);
+        }
+        return playerid == 0 ? rest : mine;
+    }
+
 public:
     Semi2kTriple() = default;
     ~Semi2kTriple() = default;
 
+    /// @brief Constructor, deal random triples and square pairs from a seed instead of zeros.
+    /// @param playerid My player id
+    /// @param n_players Number of players
+    /// @param seed The same on every party, every party draws the same values and keeps its share of them
+    /// @note Insecure, for testing the masking of protocols. Randbits and truncation masks stay zero.
+    Semi2kTriple(playerid_t playerid, size_t n_players, uint64_t seed):
+        dealer(std::in_place, seed), playerid(playerid), n_players(n_players) {}
+
     /// @brief Get n triples for Semi2k protocol.
     /// @param n How many triples we need
     template<size_t K, bool Signed>
@@ -38,6 +86,12 @@ public:
         ArrayRef<Z2<K, Signed>>
     > get_n_triple(size_t n)
     {
+        if( dealer ) {
+            auto a = deal<K, Signed>(n);
+            auto b = deal<K, Signed>(n);
+            auto c = core::evaluate(a * b);
+            return std::make_tuple( share(a), share(b), share(c) );
+        }
         return std::make_tuple(
             core::make_array(Z2<K, Signed>{0}, n, true),
             core::make_array(Z2<K, Signed>{0}, n, true),
@@ -45,6 +99,25 @@ public:
         );
     }
 
+    /// @brief Get n square pairs (a, a^2) for Semi2k protocol.
+    /// @param n How many square pairs we need
+    template<size_t K, bool Signed>
+    std::tuple<
+        ArrayRef<Z2<K, Signed>>,
+        ArrayRef<Z2<K, Signed>>
+    > get_n_square(size_t n)
+    {
+        if( dealer ) {
+            auto a  = deal<K, Signed>(n);
+            auto aa = core::evaluate(a * a);
+            return std::make_tuple( share(a), share(aa) );
+        }
+        return std::make_tuple(
+            core::make_array(Z2<K, Signed>{0}, n, true),
+            core::make_array(Z2<K, Signed>{0}, n, true)
+        );
+    }
+
     /// @brief Get matrix bever triple for Semi2k protocol.
     /// @param M The first parameter
     /// @param N The second parameter
@@ -57,6 +130,12 @@ public:
         ArrayRef<Z2<K, Signed>>
     > get_matrix_triple(int64_t M, int64_t N, int64_t KK)
     {
+        if( dealer ) {
+            auto a = deal<K, Signed>(M * N);
+            auto b = deal<K, Signed>(N * KK);
+            auto c = core::matmul(a, b, M, N, KK);
+            return std::make_tuple( share(a), share(b), share(c) );
+        }
         return std::make_tuple(
             core::make_array(Z2<K, Signed>{0}, M * N, true),
             core::make_array(Z2<K, Signed>{0}, N * KK, true),
@@ -163,17 +242,43 @@ public:
     template <std::size_t K, bool Signed>
     ArrayRef<Z2<K, Signed>> open_s(ArrayRef<Z2<K, Signed>> const& in)
     {
-        ArrayRef<Z2<K, Signed>> ret(in);
-        Serializer sr;
+        trace::Span span("open_s", "semi2k");
+        using dtype = Z2<K, Signed>;
+
+        Serializer sr( serialized_size(in) );
         sr << in;
         auto msgs = mplayer->mbroadcast_recv(parties, sr.finalize());
-        ArrayRef<Z2<K, Signed>> tmp(in);
-        for(const auto& pid: parties){
-            Deserializer dr(std::move(msgs[pid]));
-            dr >> tmp;
-            ret = add_pp(ret, tmp);
+
+        if constexpr ( ::detail::PackedSerializable<dtype> ) {
+            // packed shares must be unpacked, after the first message tmp owns its buffer
+            // and later messages are read into it in place
+            ArrayRef<dtype> ret(in);
+            ArrayRef<dtype> tmp(in);
+            for(const auto& pid: parties){
+                Deserializer dr(std::move(msgs[pid]));
+                dr >> tmp;
+                ret = add_pp(std::move(ret), tmp);
+            }
+            return ret;
+        }
+        else {
+            // sum the shares straight out of the receive buffers, only the result is allocated
+            int64_t numel = in.numel();
+            ArrayRef<dtype> ret(core::make_buffer<dtype>(numel), numel, 1, 0);
+            auto out = ret.data();
+            for(int64_t i = 0; i < numel; ++i)
+                out[i] = in[i];
+
+            for(const auto& pid: parties){
+                Deserializer dr(std::move(msgs[pid]));
+                auto share = deserialize_borrowed<dtype>(dr);
+                if( share.numel() != numel )
+                    throw std::invalid_argument("number of elements mismatch");
+                for(int64_t i = 0; i < numel; ++i)
+                    out[i] += share[i];
+            }
+            return ret;
         }
-        return ret;
     }
 
     /// @brief Implementation of negation for plain input under the Semi2k protocol.
@@ -185,6 +290,15 @@ public:
         return core::neg(in);
     }
 
+    /// @brief Implementation of negation for temporary plain input, reusing its buffer when uniquely owned.
+    /// @param in Plain input
+    /// @return ArrayRef object of the result
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> neg_p(ArrayRef<Z2<K, Signed>>&& in)
+    {
+        return core::neg(std::move(in));
+    }
+
     /// @brief Implementation of negation for share input under the Semi2k protocol.
     /// @param in Plain input
     /// @return ArrayRef object of the result
@@ -194,6 +308,15 @@ public:
         return core::neg(in);
     }
 
+    /// @brief Implementation of negation for temporary share input, reusing its buffer when uniquely owned.
+    /// @param in Share input
+    /// @return ArrayRef object of the result
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> neg_s(ArrayRef<Z2<K, Signed>>&& in)
+    {
+        return core::neg(std::move(in));
+    }
+
     /// @brief Implementation of addition between plain addend and plain addend under the Semi2k protocol.
     /// @param lhs First plain addend
     /// @param rhs Second plain addend
@@ -204,6 +327,16 @@ public:
         return core::add(lhs, rhs);
     }
 
+    /// @brief Implementation of addition with a temporary first plain addend, reusing its buffer when uniquely owned.
+    /// @param lhs First plain addend
+    /// @param rhs Second plain addend
+    /// @return ArrayRef object of the sum, lhs + rhs
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> add_pp(ArrayRef<Z2<K, Signed>>&& lhs, ArrayRef<Z2<K, Signed>> const& rhs)
+    {
+        return core::add(std::move(lhs), rhs);
+    }
+
     /// @brief Implementation of addition between share addend and plain addend under the Semi2k protocol.
     /// @param lhs First share addend
     /// @param rhs Second plain addend
@@ -220,6 +353,23 @@ public:
             return share;
         }
     }
+
+    /// @brief Implementation of addition with a temporary share addend, reusing its buffer when uniquely owned.
+    /// @param lhs First share addend
+    /// @param rhs Second plain addend
+    /// @return ArrayRef object of the sum, lhs + rhs
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> add_sp(ArrayRef<Z2<K, Signed>>&& share, ArrayRef<Z2<K, Signed>> const& plain)
+    {
+        if(playerid == 0) 
+        {
+            return core::add(std::move(share), plain);
+        }
+        else 
+        {
+            return std::move(share);
+        }
+    }
     
     /// @brief Implementation of addition between share addend and share addend under the Semi2k protocol.
     /// @param lhs First share addend
@@ -231,6 +381,16 @@ public:
         return core::add(lhs, rhs);
     }
 
+    /// @brief Implementation of addition with a temporary first share addend, reusing its buffer when uniquely owned.
+    /// @param lhs First share addend
+    /// @param rhs Second share addend
+    /// @return ArrayRef object of the sum, lhs + rhs
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> add_ss(ArrayRef<Z2<K, Signed>>&& lhs, ArrayRef<Z2<K, Signed>> const& rhs)
+    {
+        return core::add(std::move(lhs), rhs);
+    }
+
     /// @brief Implementation of multiplication between plain multiplier and plain multiplier under the Semi2k protocol.
     /// @param lhs First plain multiplier
     /// @param rhs Second plain multiplier
@@ -241,6 +401,16 @@ public:
         return core::mul(lhs, rhs);
     }
 
+    /// @brief Implementation of multiplication with a temporary first plain multiplier, reusing its buffer when uniquely owned.
+    /// @param lhs First plain multiplier
+    /// @param rhs Second plain multiplier
+    /// @return ArrayRef object of the product, lhs * rhs
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> mul_pp(ArrayRef<Z2<K, Signed>>&& lhs, ArrayRef<Z2<K, Signed>> const& rhs)
+    {
+        return core::mul(std::move(lhs), rhs);
+    }
+
     /// @brief Implementation of multiplication between share multiplier and plain multiplier under the Semi2k protocol.
     /// @param lhs First share multiplier
     /// @param rhs Second plain multiplier
@@ -251,6 +421,16 @@ public:
         return core::mul(share, plain);
     }
 
+    /// @brief Implementation of multiplication with a temporary share multiplier, reusing its buffer when uniquely owned.
+    /// @param lhs First share multiplier
+    /// @param rhs Second plain multiplier
+    /// @return ArrayRef object of the product, lhs * rhs
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> mul_sp(ArrayRef<Z2<K, Signed>>&& share, ArrayRef<Z2<K, Signed>> const& plain)
+    {
+        return core::mul(std::move(share), plain);
+    }
+
     /// @brief Implementation of multiplication between share multiplier and share multiplier under the Semi2k protocol.
     /// @param lhs First share multiplier
     /// @param rhs Second share multiplier
@@ -258,109 +438,135 @@ public:
     template <std::size_t K, bool Signed>
     ArrayRef<Z2<K, Signed>> mul_ss(ArrayRef<Z2<K, Signed>> const& lhs, ArrayRef<Z2<K, Signed>> const& rhs)
     {
+        trace::Span span("mul_ss", "semi2k");
         // ArrayRef<Z2<K, Signed>> us, vs, uvs;
         if(!triples)
         {
             throw std::runtime_error("Triples are not enough. ");
         }
         auto [us, vs, uvs] = triples->get_n_triple<K, Signed>(lhs.numel());
-        auto a_u = add_pp(lhs, neg_p(us));
-        auto b_v = add_pp(rhs, neg_p(vs));
-        auto p_a_u = open_s(a_u);
-        auto p_b_v = open_s(b_v);
-        auto ret = add_ss(
-                    add_sp(
-                        add_ss(
-                            mul_sp(us, p_b_v), 
-                            mul_sp(vs, p_a_u)), 
-                        mul_pp(p_a_u, p_b_v)), 
-                    uvs);
-        return ret;
+        auto [p_a_u, p_b_v] = open_masked_s(lhs, us, rhs, vs);
+        // fused local step, one pass over the operands instead of one per operation
+        if(playerid == 0)
+        {
+            return core::evaluate(us * p_b_v + vs * p_a_u + p_a_u * p_b_v + uvs);
+        }
+        else
+        {
+            return core::evaluate(us * p_b_v + vs * p_a_u + uvs);
+        }
     }
 
-    /// @brief Implementation of the most significant bit for share input under the Semi2k protocol.
-    /// @param in Share input
-    /// @return ArrayRef object of the result, x < 0 -> 1, x >= 0 -> 0
+    /// @brief Implementation of square for plain input under the Semi2k protocol.
+    /// @param in Plain input
+    /// @return ArrayRef object of the product, in * in
     template <std::size_t K, bool Signed>
-    ArrayRef<Z2<K, Signed>> msb_s(ArrayRef<Z2<K, Signed>> const& in)
+    ArrayRef<Z2<K, Signed>> square_p(ArrayRef<Z2<K, Signed>> const& in)
     {
+        return core::mul(in, in);
+    }
 
-        if(Signed == true){
-            ArrayRef<Z2<K, false>> unsigned_in = core::apply([](auto const& x){return Z2<K, false>(x);}, in);
-            ArrayRef<Z2<K, false>> unsigned_res = msb_s(unsigned_in);
-            ArrayRef<Z2<K, Signed>> signed_res = core::apply([](auto const& x){return Z2<K, Signed>(x);}, unsigned_res);
-            return signed_res;
-        }
-
-        // Setp 1
+    /// @brief Implementation of square for share input under the Semi2k protocol.
+    /// @param in Share input
+    /// @return ArrayRef object of the product, in * in
+    /// @note With a square pair (a, a^2) only e = in - a is opened, in^2 = e^2 + 2ea + a^2.
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> square_s(ArrayRef<Z2<K, Signed>> const& in)
+    {
+        trace::Span span("square_s", "semi2k");
         if(!triples)
         {
-            throw std::runtime_error("Randbits are not enough. ");
+            throw std::runtime_error("Square pairs are not enough. ");
         }
-        auto b = triples->get_n_randbit<K, Signed>(in.numel());
-        std::vector<ArrayRef<Z2<K, Signed>>> rs;
-        for(int i = 0; i != K; ++i){
-            rs.emplace_back(triples->get_n_randbit<K, Signed>(in.numel()));
+        auto [as, aas] = triples->get_n_square<K, Signed>(in.numel());
+        auto p_e = open_s(core::evaluate(in - as));
+        if(playerid == 0)
+        {
+            return core::evaluate((as + as + p_e) * p_e + aas);
         }
-        ArrayRef<Z2<K, Signed>> r = core::make_array(std::vector<Z2<K, Signed>>(in.numel(), 0));
-        for(int i = 0; i != in.numel(); ++i)
+        else
         {
-            for(int j = 0; j != K; ++j)
-            {
-                r[i] = r[i] + (rs[j][i] << j);
-            }
+            return core::evaluate((as + as) * p_e + aas);
         }
+    }
 
-        // Setp 2
-        ArrayRef<Z2<K, Signed>> c = open_s(add_ss(in, r));
-
-        // Setp 3
-        ArrayRef<Z2<K, Signed>> cc(c);
-        cc = rshift_p(lshift_p(c, 1), 1);
-        ArrayRef<Z2<K, Signed>> rr = core::make_array(std::vector<Z2<K, Signed>>(in.numel(), 0));
-        for(int i = 0; i != in.numel(); ++i)
-        {
-            for(int j = 0; j != K - 1; ++j)
+    /// @brief Implementation of the most significant bit for share input under the Semi2k protocol.
+    /// @param in Share input
+    /// @return ArrayRef object of the result, x < 0 -> 1, x >= 0 -> 0
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> msb_s(ArrayRef<Z2<K, Signed>> const& in)
+    {
+        if constexpr (Signed) {
+            // same bits either way, as<> reinterprets the elements instead of converting them
+            ArrayRef<Z2<K, false>> unsigned_res = msb_s(in.template as<Z2<K, false>>());
+            return unsigned_res.template as<Z2<K, Signed>>();
+        }
+        else {
+            // Setp 1
+            trace::Span step("msb_s step 1", "semi2k");
+            if(!triples)
             {
-                rr[i] = rr[i] + (rs[j][i] << j);
+                throw std::runtime_error("Randbits are not enough. ");
             }
-        }
+            auto b = triples->get_n_randbit<K, Signed>(in.numel());
+            std::vector<ArrayRef<Z2<K, Signed>>> rs;
+            for(int i = 0; i != K; ++i){
+                rs.emplace_back(triples->get_n_randbit<K, Signed>(in.numel()));
+            }
+            ArrayRef<Z2<K, Signed>> r = compose_s(rs, K);
 
-        // Setp 4
-        std::vector<ArrayRef<Z2<1, Signed>>> r2s = a2b(rs);
+            // Setp 2
+            step.next("msb_s step 2");
+            ArrayRef<Z2<K, Signed>> c = open_s(add_ss(in, r));
+
+            // Setp 3
+            step.next("msb_s step 3");
+            ArrayRef<Z2<K, Signed>> cc(c);
+            cc = rshift_p(lshift_p(c, 1), 1);
+            ArrayRef<Z2<K, Signed>> rr = compose_s(rs, K - 1);
+
+            // Setp 4
+            step.next("msb_s step 4");
+            std::vector<ArrayRef<Z2<1, Signed>>> r2s = a2b(rs);
         
-        // Setp 5
-        ArrayRef<Z2<1, Signed>> u2 = bitlt_ps(cc, r2s);
-
-        // Setp 6
-        std::vector<ArrayRef<Z2<1, Signed>>> tmp;
-        tmp.emplace_back(u2);
-        ArrayRef<Z2<K, Signed>> u = b2a<K>(tmp)[0];
-
-        // Setp 7
-        ArrayRef<Z2<K, Signed>> aa = add_sp(
-                                        add_ss(
-                                            neg_s(rr), 
-                                            lshift_s(u, K - 1)), 
-                                        cc);
-        ArrayRef<Z2<K, Signed>> d = add_ss(in, neg_s(aa));
-
-        // Setp 8
-        ArrayRef<Z2<K, Signed>> e = open_s(add_ss(
-                                        lshift_s(b, K - 1), 
-                                        d));
-        ArrayRef<Z2<K, Signed>> e_msb = msb_p(e);
+            // Setp 5
+            step.next("msb_s step 5");
+            ArrayRef<Z2<1, Signed>> u2 = bitlt_ps(cc, r2s);
+
+            // Setp 6
+            step.next("msb_s step 6");
+            std::vector<ArrayRef<Z2<1, Signed>>> tmp;
+            tmp.emplace_back(u2);
+            ArrayRef<Z2<K, Signed>> u = b2a<K>(tmp)[0];
+
+            // Setp 7
+            step.next("msb_s step 7");
+            ArrayRef<Z2<K, Signed>> aa = add_sp(
+                                            add_ss(
+                                                neg_s(rr), 
+                                                lshift_s(u, K - 1)), 
+                                            cc);
+            ArrayRef<Z2<K, Signed>> d = add_ss(in, neg_s(aa));
+
+            // Setp 8
+            step.next("msb_s step 8");
+            ArrayRef<Z2<K, Signed>> e = open_s(add_ss(
+                                            lshift_s(b, K - 1), 
+                                            d));
+            ArrayRef<Z2<K, Signed>> e_msb = msb_p(e);
         
-        // Setp 9
-        auto tmpp = add_sp(
-                        add_ss(
+            // Setp 9
+            step.next("msb_s step 9");
+            auto tmpp = add_sp(
                             add_ss(
-                                neg_s(mul_sp(b, e_msb)), 
-                                neg_s(mul_sp(b, e_msb))), 
-                            b), 
-                        e_msb);
+                                add_ss(
+                                    neg_s(mul_sp(b, e_msb)), 
+                                    neg_s(mul_sp(b, e_msb))), 
+                                b), 
+                            e_msb);
         
-        return add_sp(neg_s(tmpp), core::make_array(std::vector<Z2<K, Signed>>(tmpp.numel(), 1)));
+            return add_sp(neg_s(tmpp), core::make_array(Z2<K, Signed>{1}, tmpp.numel()));
+        }
     }
 
     /// @brief Implementation of the most significant bit for plain input under the Semi2k protocol.
@@ -418,6 +624,7 @@ public:
     template <std::size_t K, bool Signed>
     ArrayRef<Z2<K, Signed>> trunc_s(ArrayRef<Z2<K, Signed>> const& in, std::size_t nbits)
     {
+        trace::Span span("trunc_s", "semi2k");
         if( n_players == 2 )
         {
             // 2Party local truncation
@@ -455,55 +662,50 @@ public:
     template <std::size_t K, bool Signed>
     core::ArrayRef<Z2<K, Signed>> eqz_s(core::ArrayRef<Z2<K, Signed>> const& in)
     {
-
-        if(Signed == true){
-            ArrayRef<Z2<K, false>> unsigned_in = core::apply([](auto const& x){return Z2<K, false>(x);}, in);
-            ArrayRef<Z2<K, false>> unsigned_res = eqz_s(unsigned_in);
-            ArrayRef<Z2<K, Signed>> signed_res = core::apply([](auto const& x){return Z2<K, Signed>(x);}, unsigned_res);
-            return signed_res;
-        }
-
-        // Step 1
-        std::vector<ArrayRef<Z2<K, Signed>>> rs;
-        for(int i = 0; i != K; ++i)
-        {
-            rs.emplace_back(triples->get_n_randbit<K, Signed>(in.numel()));
+        if constexpr (Signed) {
+            // same bits either way, as<> reinterprets the elements instead of converting them
+            ArrayRef<Z2<K, false>> unsigned_res = eqz_s(in.template as<Z2<K, false>>());
+            return unsigned_res.template as<Z2<K, Signed>>();
         }
+        else {
+            trace::Span span("eqz_s", "semi2k");
+            // Step 1
+            std::vector<ArrayRef<Z2<K, Signed>>> rs;
+            for(int i = 0; i != K; ++i)
+            {
+                rs.emplace_back(triples->get_n_randbit<K, Signed>(in.numel()));
+            }
 
-        // Step 2
-        ArrayRef<Z2<K, Signed>> r = core::make_array(Z2<K, Signed>{0}, in.numel(), true);
-        for(int i = 0; i != K; ++i)
-        {
-            r = add_ss(r, lshift_s(rs[i], i));
-        }
+            // Step 2
+            ArrayRef<Z2<K, Signed>> r = compose_s(rs, K);
 
-        // Step 3
-        ArrayRef<Z2<K, Signed>> c = open_s(add_ss(in, r));
-        std::vector<ArrayRef<Z2<K, Signed>>> cs = bitdec_p(c, K);
+            // Step 3
+            ArrayRef<Z2<K, Signed>> c = open_s(add_ss(in, r));
 
-        // Step 4
-        std::vector<ArrayRef<Z2<1, Signed>>> rsb = a2b(rs);
+            // Step 4
+            std::vector<ArrayRef<Z2<1, Signed>>> rsb = a2b(rs);
 
-        // Step 5
-        std::vector<ArrayRef<Z2<1, Signed>>> csb = a2b(cs);
-        std::vector<ArrayRef<Z2<1, Signed>>> tmp;
-        for(int i = 0; i != K; ++i)
-        {
-            tmp.emplace_back(add_sp(rsb[i], csb[i]));
-        }
-        ArrayRef<Z2<1, Signed>> b2 = tmp[0];
-        for(int i = 1; i != K; ++i)
-        {
-            b2 = or_ss(b2, tmp[i]);
+            // Step 5
+            std::vector<ArrayRef<Z2<1, Signed>>> csb = bit_planes<Z2<1, Signed>>(c, K);
+            std::vector<ArrayRef<Z2<1, Signed>>> tmp;
+            for(int i = 0; i != K; ++i)
+            {
+                tmp.emplace_back(add_sp(rsb[i], csb[i]));
+            }
+            ArrayRef<Z2<1, Signed>> b2 = tmp[0];
+            for(int i = 1; i != K; ++i)
+            {
+                b2 = or_ss(b2, tmp[i]);
+            }
+            auto ones = core::make_array(Z2<1, Signed>{1}, b2.numel());
+            b2 = add_sp(b2, ones);
+
+            // Step 6
+            std::vector<ArrayRef<Z2<1, Signed>>> tmpp;
+            tmpp.emplace_back(b2);
+            ArrayRef<Z2<K, Signed>> b = b2a<K>(tmpp)[0];
+            return b;
         }
-        auto ones = core::make_array(std::vector<Z2<1, Signed>>(b2.numel(), 1));
-        b2 = add_sp(b2, ones);
-
-        // Step 6
-        std::vector<ArrayRef<Z2<1, Signed>>> tmpp;
-        tmpp.emplace_back(b2);
-        ArrayRef<Z2<K, Signed>> b = b2a<K>(tmpp)[0];
-        return b;
     }
 
     /// @brief Implementation of the bit decomposition for plain input under the Semi2k protocol.
@@ -513,20 +715,11 @@ public:
     template <std::size_t K, bool Signed>
     std::vector<core::ArrayRef<Z2<K, Signed>>> bitdec_p(core::ArrayRef<Z2<K, Signed>> const& in, std::size_t nbits)
     {
-        std::vector<core::ArrayRef<Z2<K, Signed>>> ans;
-        ArrayRef<Z2<K, Signed>> zero = core::make_array(std::vector<Z2<K, Signed>>(in.numel(), 0));
-        for(int i = 0; i < nbits; ++i) {
-            if(i < K) {
-                ans.emplace_back(
-                core::apply(
-                    [i](Z2<K, Signed> const& x){ return Z2<K, Signed>(x.bit(i)); },
-                    in)
-                );
-            }
-            else {
-                if(K == 1) ans.emplace_back(zero);
-                else ans.emplace_back(msb_p(in));
-            }
+        std::vector<core::ArrayRef<Z2<K, Signed>>> ans = bit_planes<Z2<K, Signed>>(in, std::min(nbits, K));
+        if(nbits > K) {
+            // bits above K repeat the sign bit
+            ArrayRef<Z2<K, Signed>> ext = (K == 1) ? core::make_array(Z2<K, Signed>{0}, in.numel()) : msb_p(in);
+            ans.resize(nbits, ext);
         }
         return ans;
     }
@@ -538,16 +731,14 @@ public:
     template <std::size_t K, bool Signed>
     std::vector<ArrayRef<Z2<K, Signed>>> bitdec_s(ArrayRef<Z2<K, Signed>> const& in, std::size_t nbits)
     {
+        trace::Span span("bitdec_s", "semi2k");
         // Step 1
         std::vector<ArrayRef<Z2<K, Signed>>> rs;
         for(int i = 0; i != nbits; ++i)
         {
             rs.emplace_back(triples->get_n_randbit<K, Signed>(in.numel()));
         }
-        ArrayRef<Z2<K, Signed>> r = core::make_array(Z2<K, Signed>{0}, in.numel(), true);
-        for(int i = 0; i != nbits; ++i){
-            r = add_ss(r, lshift_s(rs[i], i));
-        }
+        ArrayRef<Z2<K, Signed>> r = compose_s(rs, nbits);
 
         // Step 2
         ArrayRef<Z2<K, Signed>> c = open_s(add_ss(in, neg_s(r)));
@@ -573,15 +764,14 @@ public:
     template <std::size_t K, bool Signed>
     std::vector<core::ArrayRef<Z2<K, Signed>>> h1bitdec_p(core::ArrayRef<Z2<K, Signed>> const& in, std::size_t nbits)
     {
-        auto h1b = core::apply([nbits](Z2<K, Signed> const& x){
-            Z2<K, Signed> ans{0};
-            char flag = 1;
-            for(int i = nbits - 1; i >= 0; --i) {
-                char b = x.bit(i);
-                ans.bit(i) = b & flag;
-                flag &= ~b;
-            }
-            return ans;
+        using Unsigned = Z2<K, false>;
+        Unsigned mask = (nbits < K) ? Unsigned((Unsigned{1} << nbits) - Unsigned{1}) : Unsigned(~Unsigned{0});
+        auto h1b = core::apply([mask](Z2<K, Signed> const& x){
+            // smear the highest set bit down, then keep only that bit
+            Unsigned y = Unsigned(x) & mask;
+            for(std::size_t s = 1; s < K; s <<= 1)
+                y = y | (y >> s);
+            return Z2<K, Signed>( y ^ (y >> 1) );
         }, in);
         auto ans = bitdec_p(h1b, nbits);
         return ans;
@@ -594,6 +784,7 @@ public:
     template <std::size_t K, bool Signed>
     std::vector<core::ArrayRef<Z2<K, Signed>>> h1bitdec_s(core::ArrayRef<Z2<K, Signed>> const& in, std::size_t nbits)
     {
+        trace::Span span("h1bitdec_s", "semi2k");
 
         std::vector<core::ArrayRef<Z2<1, Signed>>> prefix_or_ans_dec = a2b(bitdec_s(in, nbits));
 
@@ -602,7 +793,7 @@ public:
             prefix_or_ans_dec[i] = or_ss(prefix_or_ans_dec[i], prefix_or_ans_dec[i + 1]);
         }
 
-        ArrayRef<Z2<1, Signed>> ones = core::make_array(std::vector<Z2<1, Signed>>(in.numel(), 1));
+        ArrayRef<Z2<1, Signed>> ones = core::make_array(Z2<1, Signed>{1}, in.numel());
 
         std::vector<ArrayRef<Z2<1, Signed>>> ret = add_pb(bitdec_p(ones, nbits), prefix_or_ans_dec, true);
 
@@ -653,12 +844,48 @@ public:
     /// @return ArrayRef object of the matrix product, (lhsrhs)
     template <std::size_t K, bool Signed>
     ArrayRef<Z2<K, Signed>> matmul_ss(ArrayRef<Z2<K, Signed>> const& lhs, ArrayRef<Z2<K, Signed>> const& rhs, int64_t M, int64_t N, int64_t KK){
+        return core::flatten( matmul_ss(core::unflatten(lhs, {M, N}), core::unflatten(rhs, {N, KK})) );
+    }
+
+    /// @brief Implementation of matrix multiplication between plain matrix multipliers under the Semi2k protocol.
+    /// @param lhs First plain matrix multiplier, transposed or sliced views are read in place
+    /// @param rhs Second plain matrix multiplier, transposed or sliced views are read in place
+    /// @return NDArrayRef object of the matrix product, (lhsrhs)
+    template <std::size_t K, bool Signed>
+    NDArrayRef<Z2<K, Signed>> matmul_pp(NDArrayRef<Z2<K, Signed>> const& lhs, NDArrayRef<Z2<K, Signed>> const& rhs){
+        return core::matmul(lhs, rhs);
+    }
+
+    /// @brief Implementation of matrix multiplication between share matrix multiplier and plain matrix multiplier under the Semi2k protocol.
+    /// @param lhs First share matrix multiplier, transposed or sliced views are read in place
+    /// @param rhs Second plain matrix multiplier, transposed or sliced views are read in place
+    /// @return NDArrayRef object of the matrix product, (lhsrhs)
+    template <std::size_t K, bool Signed>
+    NDArrayRef<Z2<K, Signed>> matmul_sp(NDArrayRef<Z2<K, Signed>> const& lhs, NDArrayRef<Z2<K, Signed>> const& rhs){
+        return core::matmul(lhs, rhs);
+    }
+
+    /// @brief Implementation of matrix multiplication between plain matrix multiplier and share matrix multiplier under the Semi2k protocol.
+    /// @param lhs First plain matrix multiplier, transposed or sliced views are read in place
+    /// @param rhs Second share matrix multiplier, transposed or sliced views are read in place
+    /// @return NDArrayRef object of the matrix product, (lhsrhs)
+    template <std::size_t K, bool Signed>
+    NDArrayRef<Z2<K, Signed>> matmul_ps(NDArrayRef<Z2<K, Signed>> const& lhs, NDArrayRef<Z2<K, Signed>> const& rhs){
+        return core::matmul(lhs, rhs);
+    }
+
+    /// @brief Implementation of matrix multiplication between share matrix multipliers under the Semi2k protocol.
+    /// @param lhs First share matrix multiplier, transposed or sliced views are read in place
+    /// @param rhs Second share matrix multiplier, transposed or sliced views are read in place
+    /// @return NDArrayRef object of the matrix product, (lhsrhs)
+    /// @note The views are only read once, while masking them with the triple.
+    template <std::size_t K, bool Signed>
+    NDArrayRef<Z2<K, Signed>> matmul_ss(NDArrayRef<Z2<K, Signed>> const& lhs, NDArrayRef<Z2<K, Signed>> const& rhs){
+        trace::Span span("matmul_ss", "semi2k");
+        auto [M, N, KK] = core::detail::deduceMatmulShape(lhs.shape(), rhs.shape());
         auto [us, vs, uvs] = triples->get_matrix_triple<K, Signed>(M, N, KK);
 
-        auto a_u = add_pp(lhs, neg_p(us));
-        auto b_v = add_pp(rhs, neg_p(vs));
-        auto p_a_u = open_s(a_u);
-        auto p_b_v = open_s(b_v);
+        auto [p_a_u, p_b_v] = open_masked_s(lhs, us, rhs, vs);
         auto ret = add_ss(
                     add_sp(
                         add_ss(
@@ -666,10 +893,67 @@ public:
                             matmul_ps(p_a_u, vs, M, N, KK)), 
                         matmul_pp(p_a_u, p_b_v, M, N, KK)), 
                     uvs);
-        return ret;
+        return core::unflatten(ret, {M, KK});
     }
 
 private:
+    /// @brief Open lhs - u and rhs - v in a single round.
+    /// @param lhs First share input
+    /// @param us Share mask of lhs
+    /// @param rhs Second share input
+    /// @param vs Share mask of rhs
+    /// @return Opened lhs - u and rhs - v
+    /// @note Both differences are written to one buffer and broadcast as one message.
+    template <std::size_t K, bool Signed>
+    std::pair<ArrayRef<Z2<K, Signed>>, ArrayRef<Z2<K, Signed>>> open_masked_s(
+        ArrayRef<Z2<K, Signed>> const& lhs, ArrayRef<Z2<K, Signed>> const& us,
+        ArrayRef<Z2<K, Signed>> const& rhs, ArrayRef<Z2<K, Signed>> const& vs)
+    {
+        int64_t nl = lhs.numel(), nr = rhs.numel();
+        auto masked = core::make_array<Z2<K, Signed>>(nl + nr);
+        for(int64_t i = 0; i < nl; ++i)
+            masked[i] = lhs[i] - us[i];
+        for(int64_t i = 0; i < nr; ++i)
+            masked[nl + i] = rhs[i] - vs[i];
+
+        auto opened = open_s(masked);
+        return {
+            ArrayRef<Z2<K, Signed>>(opened.sptr(), nl, opened.stride(), opened.offset()),
+            ArrayRef<Z2<K, Signed>>(opened.sptr(), nr, opened.stride(), opened.offset() + nl * opened.stride())
+        };
+    }
+
+    /// @brief Open lhs - u and rhs - v of matrices in a single round, reading the views of lhs and rhs in place.
+    /// @param lhs First share matrix, u is row major
+    /// @param us Share mask of lhs
+    /// @param rhs Second share matrix, v is row major
+    /// @param vs Share mask of rhs
+    /// @return Opened lhs - u and rhs - v, row major
+    template <std::size_t K, bool Signed>
+    std::pair<ArrayRef<Z2<K, Signed>>, ArrayRef<Z2<K, Signed>>> open_masked_s(
+        NDArrayRef<Z2<K, Signed>> const& lhs, ArrayRef<Z2<K, Signed>> const& us,
+        NDArrayRef<Z2<K, Signed>> const& rhs, ArrayRef<Z2<K, Signed>> const& vs)
+    {
+        int64_t nl = lhs.numel(), nr = rhs.numel();
+        auto masked = core::make_array<Z2<K, Signed>>(nl + nr);
+        auto mask_into = [&](NDArrayRef<Z2<K, Signed>> const& x, ArrayRef<Z2<K, Signed>> const& mask, int64_t begin) {
+            auto const* data = x.data() + x.offset();
+            int64_t rows = x.shape()[0], cols = x.shape()[1];
+            int64_t row_stride = x.strides()[0], col_stride = x.strides()[1];
+            for(int64_t i = 0; i < rows; ++i)
+                for(int64_t j = 0; j < cols; ++j)
+                    masked[begin + i * cols + j] = data[i * row_stride + j * col_stride] - mask[i * cols + j];
+        };
+        mask_into(lhs, us, 0);
+        mask_into(rhs, vs, nl);
+
+        auto opened = open_s(masked);
+        return {
+            ArrayRef<Z2<K, Signed>>(opened.sptr(), nl, opened.stride(), opened.offset()),
+            ArrayRef<Z2<K, Signed>>(opened.sptr(), nr, opened.stride(), opened.offset() + nl * opened.stride())
+        };
+    }
+
     /// @brief Used in most significant bit function to calculate intermediate variable.
     /// @param lhs First plain input
     /// @param rhs Second share input
@@ -684,30 +968,68 @@ private:
             bb.emplace_back(core::apply(fn, rhs[i]));
         }
 
-        std::vector<ArrayRef<Z2<K, Signed>>> a = bitdec_p(lhs, K);
-
-        std::vector<ArrayRef<Z2<1, Signed>>> aa;
-        std::vector<Z2<1, Signed>> tmp(a[0].numel());
-        for(int i = 0; i != a.size(); ++i){
-            for(int j = 0; j != tmp.size(); ++j){
-                tmp[j] = static_cast<Z2<1, Signed>>(a[i][j]);
-            }
-            aa.emplace_back(core::make_array(tmp));
-        }
+        std::vector<ArrayRef<Z2<1, Signed>>> aa = bit_planes<Z2<1, Signed>>(lhs, K);
 
         if(playerid == 0)
         {
-            ArrayRef<Z2<1, Signed>> c = core::make_array(std::vector<Z2<1, Signed>>(lhs.numel(), 1));
+            ArrayRef<Z2<1, Signed>> c = core::make_array(Z2<1, Signed>{1}, lhs.numel());
 
             return core::apply(fn, carry_pss(aa, bb, c));
         }
         else 
         {
-            ArrayRef<Z2<1, Signed>> c = core::make_array(std::vector<Z2<1, Signed>>(lhs.numel(), 0));
+            ArrayRef<Z2<1, Signed>> c = core::make_array(Z2<1, Signed>{0}, lhs.numel());
             return carry_pss(aa, bb, c);
         }
     }
 
+    /// @brief Split plain values into bit planes, plane i holds bit i of every element as a 0/1 value of Out.
+    /// @param in Plain input
+    /// @param nplanes Number of planes, at most K
+    /// @return The vector of nplanes ArrayRef
+    template <typename Out, std::size_t K, bool Signed>
+    std::vector<ArrayRef<Out>> bit_planes(ArrayRef<Z2<K, Signed>> const& in, std::size_t nplanes)
+    {
+        std::vector<ArrayRef<Out>> planes;
+        std::vector<Out*> dest;
+        for(std::size_t i = 0; i != nplanes; ++i)
+        {
+            planes.emplace_back(core::make_array<Out>(in.numel()));
+            dest.push_back(planes.back().data());
+        }
+        split_bit_planes(in.data() + in.offset(), in.stride(), in.numel(), nplanes, dest.data());
+        return planes;
+    }
+
+    /// @brief Recompose shares of bits, sum of bits[j] << j over j < nbits.
+    /// @param bits Shares of bits, all of the same length
+    /// @param nbits Number of bits to recompose
+    /// @return ArrayRef object of the recomposed share
+    template <std::size_t K, bool Signed>
+    ArrayRef<Z2<K, Signed>> compose_s(std::vector<ArrayRef<Z2<K, Signed>>> const& bits, std::size_t nbits)
+    {
+        constexpr int64_t BLOCK = 1024;
+        int64_t numel = bits[0].numel();
+        ArrayRef<Z2<K, Signed>> ret = core::make_array(Z2<K, Signed>{0}, numel, true);
+        Z2<K, Signed>* r = ret.data();
+
+        // blocks of the result stay in cache while all bits are added to them
+        for(int64_t e0 = 0; e0 < numel; e0 += BLOCK)
+        {
+            int64_t n = std::min(BLOCK, numel - e0);
+            for(std::size_t j = 0; j != nbits; ++j)
+            {
+                Z2<K, Signed> const* b = bits[j].data() + bits[j].offset() + e0 * bits[j].stride();
+                int64_t stride = bits[j].stride();
+                for(int64_t e = 0; e < n; ++e)
+                {
+                    r[e0 + e] = r[e0 + e] + (b[e * stride] << j);
+                }
+            }
+        }
+        return ret;
+    }
+
     /// @brief Convert Z2's bit size from K to 1
     /// @param in Input to be converted
     /// @return Converted Output
@@ -750,7 +1072,7 @@ private:
             c.emplace_back(tmp3);
         }
         std::vector<ArrayRef<Z2<K, Signed>>> ret;
-        ArrayRef<Z2<K, Signed>> twos = core::make_array(Z2<K, Signed>{2}, in[0].numel(), true);
+        ArrayRef<Z2<K, Signed>> twos = core::make_array(Z2<K, Signed>{2}, in[0].numel());
         for(int i = 0; i != in.size(); ++i)
         {
             ret.emplace_back(add_sp(
@@ -774,7 +1096,7 @@ private:
     ArrayRef<Z2<1, Signed>> or_ss(const ArrayRef<Z2<1, Signed>>& lhs, const ArrayRef<Z2<1, Signed>>& rhs)
     {
 
-        ArrayRef<Z2<1, Signed>> ones = core::make_array<Z2<1, Signed>>(std::vector<Z2<1, Signed>>(lhs.numel(), 1));
+        ArrayRef<Z2<1, Signed>> ones = core::make_array(Z2<1, Signed>{1}, lhs.numel());
 
         return add_sp(mul_ss(
                         add_sp(lhs, ones),
@@ -790,7 +1112,7 @@ private:
     std::vector<ArrayRef<Z2<1, Signed>>> add_pb(const std::vector<ArrayRef<Z2<1, Signed>>>& lhs, const std::vector<ArrayRef<Z2<1, Signed>>>& rhs, bool save_carry = false)
     {
         std::vector<ArrayRef<Z2<1, Signed>>> ret;
-        ArrayRef<Z2<1, Signed>> c = core::make_array(Z2<1, Signed>{0}, lhs[0].numel(), true);
+        ArrayRef<Z2<1, Signed>> c = core::make_array(Z2<1, Signed>{0}, lhs[0].numel());
         for(int i = 0; i != lhs.size(); ++i)
         {
             ret.emplace_back(add_sp(add_ss(rhs[i], c), lhs[i]));
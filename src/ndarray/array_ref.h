@@ -8,6 +8,7 @@
 
 #include "slice.hpp"
 #include "buffer.hpp"
+#include "buffer_pool.hpp"
 #include "iterator.hpp"
 
 namespace core
@@ -33,7 +34,10 @@ class ArrayRef
   protected:
 
     /// @brief A pointer to the buffer where the data is stored.
+    /// @note For arrays reinterpreted by as<>, it only shares the ownership of a buffer of another type and is null.
     std::shared_ptr<BufferType> _data;
+    /// @brief The first element of the buffer of another type, null unless the array is reinterpreted by as<>.
+    dtype* _elems = nullptr;
     /// @brief The length of data.
     int64_t _numel;
     /// @brief Indicates the difference in buffer between two adjacent elements.
@@ -41,6 +45,12 @@ class ArrayRef
     /// @brief Indicates the offset of the first element in buffer.
     int64_t _offset;
 
+    template <typename> friend class ArrayRef;
+
+    /// @brief Constructor of the arrays reinterpreted by as<>, owner keeps the buffer of elems alive.
+    ArrayRef(std::shared_ptr<BufferType> owner, dtype* elems, int64_t numel, int64_t stride, int64_t offset)
+        : _data( std::move(owner) ), _elems(elems), _numel(numel), _stride(stride), _offset(offset) {}
+
   public:
 
     using value_type      = dtype;
@@ -62,12 +72,13 @@ class ArrayRef
     ArrayRef& operator=(ArrayRef const&) = default;
 
     /// @brief Get the shared pointer _data.
+    /// @note Null for arrays reinterpreted by as<>, whose elements live in a buffer of another type.
     std::shared_ptr<BufferType> sptr() const { return _data; }
 
     /// @brief Get the pointer to the data.
-    pointer       data()       { return _data->data(); }
+    pointer       data()       { return _elems ? _elems : _data->data(); }
     /// @brief Get the pointer to the const data.
-    const_pointer data() const { return _data->data(); }
+    const_pointer data() const { return _elems ? _elems : _data->data(); }
 
     /// @brief Get the _numel.
     int64_t numel () const { return _numel;  }
@@ -76,6 +87,10 @@ class ArrayRef
     /// @brief Get the _offset.
     int64_t offset() const { return _offset; }
 
+    /// @brief Determine whether this ArrayRef is the only owner of its buffer.
+    /// @note A uniquely owned buffer can be overwritten in place without affecting any other ArrayRef.
+    bool unique() const { return _data.use_count() == 1; }
+
     /// @brief Get the reference to the element corresponding to the index.
     reference       operator[](int64_t index)       { return this->data()[_offset + _stride * index]; }
     /// @brief Get the reference to the const element corresponding to the index.
@@ -99,6 +114,7 @@ class ArrayRef
     /// @brief Convert ArrayRef<old_type> to ArrayRef<new_type>.
     /// @tparam New underlying data type
     /// @return ArrayRef with the modified type
+    /// @note Types of the same representation share the buffer, other types are converted element wise into a new buffer.
     template <typename new_type>
     ArrayRef<new_type> as() const;
 
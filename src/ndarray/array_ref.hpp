@@ -1,6 +1,7 @@
 #pragma once
 
 #include "array_ref.h"
+#include "concepts.hpp"
 
 #include <span>
 #include <functional>
@@ -20,7 +21,7 @@ namespace core
 template <typename dtype>
 ArrayRef<dtype> make_array(int64_t numel)
 {
-    auto buffer = std::make_shared< typename ArrayRef<dtype>::BufferType >( numel );
+    auto buffer = make_buffer<dtype>( numel );
     auto stride = 1;
     auto offset = 0;
     return { std::move(buffer), numel, stride, offset };
@@ -36,14 +37,14 @@ ArrayRef<dtype> make_array(dtype const& value, int64_t numel, bool expand)
 {
     if(expand)
     {
-        auto    buffer = std::make_shared< typename ArrayRef<dtype>::BufferType >(numel, value);
+        auto    buffer = make_buffer<dtype>(numel, value);
         int64_t offset = 0;
         int64_t stride = 1;
         return { std::move(buffer), numel, stride, offset };
     }
     else
     {
-        auto    buffer = std::make_shared< typename ArrayRef<dtype>::BufferType >(1, value);
+        auto    buffer = make_buffer<dtype>(1, value);
         int64_t offset = 0;
         int64_t stride = 0;
         return { std::move(buffer), numel, stride, offset };
@@ -59,7 +60,7 @@ ArrayRef<dtype> make_array(std::vector<dtype> vec)
     int64_t numel = static_cast<int64_t>(vec.size());
     int64_t stride = 1;
     int64_t offset = 0;
-    auto    buffer = std::make_shared< typename ArrayRef<dtype>::BufferType >( std::move(vec) );
+    auto    buffer = make_buffer<dtype>( std::move(vec) );
     return { std::move(buffer), numel, stride, offset };
 }
 
@@ -72,7 +73,7 @@ ArrayRef<dtype> make_array(std::initializer_list<dtype> list)
     int64_t numel  = static_cast<int64_t>(list.size());
     int64_t stride = 1;
     int64_t offset = 0;
-    auto    buffer = std::make_shared< typename ArrayRef<dtype>::BufferType >( list );
+    auto    buffer = make_buffer<dtype>( list );
     return { std::move(buffer), numel, stride, offset };
 }
 
@@ -81,32 +82,43 @@ ArrayRef<dtype> make_array(std::initializer_list<dtype> list)
 /// @brief Convert ArrayRef<old_type> to ArrayRef<new_type>.
 /// @tparam New underlying data type
 /// @return ArrayRef with the modified type
+/// @note Types of the same representation share the buffer, other types are converted element wise into a new buffer.
 template <typename old_type>
 template <typename new_type>
 ArrayRef<new_type> ArrayRef<old_type>::as() const
 {
-    if( this->stride() == 0 )
+    if constexpr ( SameRepresentation<old_type, new_type> )
     {
-        auto buffer = std::make_shared< ArrayRef<new_type>::BufferType >(1, static_cast<new_type>( this->operator[](0) ));
-        auto numel = this->numel();
-        auto stride = 0;
-        auto offset = 0;
-        return { std::move(buffer), numel, stride, offset };
+        // the buffer keeps its type, only the element pointer is reinterpreted
+        auto owner = std::shared_ptr<typename ArrayRef<new_type>::BufferType>(_data, nullptr);
+        auto elems = reinterpret_cast<new_type*>( const_cast<old_type*>(this->data()) );
+        return ArrayRef<new_type>( std::move(owner), elems, _numel, _stride, _offset );
     }
+    else
+    {
+        if( this->stride() == 0 )
+        {
+            auto buffer = make_buffer<new_type>(1, static_cast<new_type>( this->operator[](0) ));
+            auto numel = this->numel();
+            auto stride = 0;
+            auto offset = 0;
+            return { std::move(buffer), numel, stride, offset };
+        }
 
-    auto buffer = std::make_shared< ArrayRef<new_type>::BufferType >(numel);
-    auto data = buffer->data();
-    auto numel  = this->numel();
-    auto stride = 1;
-    auto offset = 0;
+        auto numel  = this->numel();
+        auto buffer = make_buffer<new_type>(numel);
+        auto data   = buffer->data();
+        auto stride = 1;
+        auto offset = 0;
 
-    auto iter = this->begin();
-    for(int64_t i = 0; i < numel; ++i, ++iter)
-    {
-        data[i] = static_cast<new_type>(*iter);
-    }
+        auto iter = this->begin();
+        for(int64_t i = 0; i < numel; ++i, ++iter)
+        {
+            data[i] = static_cast<new_type>(*iter);
+        }
 
-    return { std::move(buffer), numel, stride, offset };
+        return { std::move(buffer), numel, stride, offset };
+    }
 }
 
 /// @brief Get the string representation of the ArrayRef.
@@ -0,0 +1,128 @@
+#include "buffer_pool.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace core
+{
+
+namespace
+{
+std::atomic<bool>    g_pool_enabled{true};
+std::atomic<int64_t> g_pool_capacity{int64_t(1) << 30};
+
+struct PoolRegistry
+{
+    std::mutex             mutex;
+    std::vector<void(*)()> clears;
+};
+
+/// @note Intentionally leaked, pools may register during static destruction.
+PoolRegistry& registry() { static PoolRegistry* r = new PoolRegistry(); return *r; }
+}
+
+/// @brief Get the allocation statistics of the buffer pool.
+/// @return Statistics summed over all element types
+BufferPoolStats buffer_pool_stats()
+{
+    auto& c = detail::bufferPoolCounters();
+    return { c.allocations.load(), c.reuses.load(), c.releases.load(), c.evictions.load(), c.cached_buffers.load(), c.cached_bytes.load() };
+}
+
+/// @brief Reset the counters of the buffer pool, cached buffers are not affected.
+void reset_buffer_pool_stats()
+{
+    auto& c = detail::bufferPoolCounters();
+    c.allocations = 0;
+    c.reuses      = 0;
+    c.releases    = 0;
+    c.evictions   = 0;
+}
+
+/// @brief Free all buffers currently cached in the pool.
+void clear_buffer_pool()
+{
+    std::vector<void(*)()> clears;
+    {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        clears = r.clears;
+    }
+    for(auto clear: clears)
+        clear();
+}
+
+/// @brief Enable or disable recycling of buffers, disabling also clears the pool.
+/// @param enabled Whether released buffers are cached for reuse (default: true)
+void set_buffer_pool_enabled(bool enabled)
+{
+    g_pool_enabled = enabled;
+    if( !enabled )
+        clear_buffer_pool();
+}
+
+/// @brief Determine whether released buffers are cached for reuse.
+/// @return If the pool is enabled, return true
+bool buffer_pool_enabled()
+{
+    return g_pool_enabled.load(std::memory_order_relaxed);
+}
+
+/// @brief Set the maximum number of bytes cached in the pool.
+/// @param bytes Upper bound of cached bytes, buffers released beyond it are freed
+void set_buffer_pool_capacity(int64_t bytes)
+{
+    if( bytes < 0 )
+        throw std::invalid_argument("buffer pool capacity must be non negative");
+    g_pool_capacity = bytes;
+}
+
+/// @brief Get the maximum number of bytes cached in the pool.
+/// @return Upper bound of cached bytes
+int64_t buffer_pool_capacity()
+{
+    return g_pool_capacity.load(std::memory_order_relaxed);
+}
+
+namespace detail
+{
+
+/// @brief Get the global counters of the buffer pool.
+BufferPoolCounters& bufferPoolCounters()
+{
+    static BufferPoolCounters* counters = new BufferPoolCounters();
+    return *counters;
+}
+
+/// @brief Register the clear function of a typed pool, so that clear_buffer_pool() reaches it.
+void registerBufferPool(void (*clear)())
+{
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.clears.push_back(clear);
+}
+
+/// @brief Round a requested number of elements up to its size class.
+/// @note Size classes keep the three most significant bits, so at most 1/8 of a buffer is wasted.
+std::size_t ceilBufferClass(std::size_t numel)
+{
+    if( numel <= 8 )
+        return std::max<std::size_t>(numel, 1);
+    int shift = std::bit_width(numel) - 3;
+    std::size_t unit = std::size_t(1) << shift;
+    return (numel + unit - 1) >> shift << shift;
+}
+
+/// @brief Round the capacity of a buffer down to the largest size class it can serve.
+std::size_t floorBufferClass(std::size_t capacity)
+{
+    if( capacity <= 8 )
+        return capacity;
+    int shift = std::bit_width(capacity) - 3;
+    return capacity >> shift << shift;
+}
+
+} // namespace detail
+
+} // namespace core
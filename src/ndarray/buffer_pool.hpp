@@ -0,0 +1,327 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer.hpp"
+
+namespace core
+{
+
+/// @struct BufferPoolStats
+/// @brief Allocation statistics of the buffer pool, summed over all element types.
+struct BufferPoolStats
+{
+    /// @brief Number of buffers whose memory was freshly allocated.
+    int64_t allocations;
+    /// @brief Number of buffers served from the pool.
+    int64_t reuses;
+    /// @brief Number of buffers returned to the pool.
+    int64_t releases;
+    /// @brief Number of buffers freed because the pool was full or disabled.
+    int64_t evictions;
+    /// @brief Number of buffers currently cached in the pool.
+    int64_t cached_buffers;
+    /// @brief Number of bytes currently cached in the pool.
+    int64_t cached_bytes;
+};
+
+/// @brief Get the allocation statistics of the buffer pool.
+/// @return Statistics summed over all element types
+BufferPoolStats buffer_pool_stats();
+
+/// @brief Reset the counters of the buffer pool, cached buffers are not affected.
+void reset_buffer_pool_stats();
+
+/// @brief Free all buffers currently cached in the pool.
+void clear_buffer_pool();
+
+/// @brief Enable or disable recycling of buffers, disabling also clears the pool.
+/// @param enabled Whether released buffers are cached for reuse (default: true)
+void set_buffer_pool_enabled(bool enabled);
+
+/// @brief Determine whether released buffers are cached for reuse.
+/// @return If the pool is enabled, return true
+bool buffer_pool_enabled();
+
+/// @brief Set the maximum number of bytes cached in the pool.
+/// @param bytes Upper bound of cached bytes, buffers released beyond it are freed
+void set_buffer_pool_capacity(int64_t bytes);
+
+/// @brief Get the maximum number of bytes cached in the pool.
+/// @return Upper bound of cached bytes
+int64_t buffer_pool_capacity();
+
+namespace detail
+{
+
+/// @struct BufferPoolCounters
+/// @brief Global counters shared by the pools of all element types.
+struct BufferPoolCounters
+{
+    std::atomic<int64_t> allocations    {0};
+    std::atomic<int64_t> reuses         {0};
+    std::atomic<int64_t> releases       {0};
+    std::atomic<int64_t> evictions      {0};
+    std::atomic<int64_t> cached_buffers {0};
+    std::atomic<int64_t> cached_bytes   {0};
+};
+
+/// @brief Get the global counters of the buffer pool.
+BufferPoolCounters& bufferPoolCounters();
+
+/// @brief Register the clear function of a typed pool, so that clear_buffer_pool() reaches it.
+void registerBufferPool(void (*clear)());
+
+/// @brief Round a requested number of elements up to its size class.
+/// @note Size classes keep the three most significant bits, so at most 1/8 of a buffer is wasted.
+std::size_t ceilBufferClass(std::size_t numel);
+
+/// @brief Round the capacity of a buffer down to the largest size class it can serve.
+std::size_t floorBufferClass(std::size_t capacity);
+
+/// @class PooledBlockAllocator
+/// @brief Allocator recycling single fixed size blocks, used for the shared_ptr control blocks of pooled buffers.
+template <typename T>
+class PooledBlockAllocator
+{
+    struct FreeList
+    {
+        std::mutex         mutex;
+        std::vector<void*> blocks;
+    };
+
+    /// @note Intentionally leaked, buffers may be released during static destruction.
+    static FreeList& freelist() { static FreeList* fl = new FreeList(); return *fl; }
+
+    static constexpr std::size_t MAX_CACHED_BLOCKS = 1 << 16;
+
+public:
+    using value_type = T;
+
+    PooledBlockAllocator() = default;
+    template <typename U> PooledBlockAllocator(PooledBlockAllocator<U> const&) noexcept {}
+
+    T* allocate(std::size_t n)
+    {
+        if( n == 1 ) {
+            auto& fl = freelist();
+            std::lock_guard<std::mutex> lock(fl.mutex);
+            if( !fl.blocks.empty() ) {
+                void* p = fl.blocks.back();
+                fl.blocks.pop_back();
+                return static_cast<T*>(p);
+            }
+        }
+        return static_cast<T*>( ::operator new(n * sizeof(T)) );
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        if( n == 1 ) {
+            auto& fl = freelist();
+            std::lock_guard<std::mutex> lock(fl.mutex);
+            if( fl.blocks.size() < MAX_CACHED_BLOCKS ) {
+                fl.blocks.push_back(p);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+    template <typename U> bool operator==(PooledBlockAllocator<U> const&) const noexcept { return true;  }
+    template <typename U> bool operator!=(PooledBlockAllocator<U> const&) const noexcept { return false; }
+};
+
+} // namespace detail
+
+/// @class BufferPool
+/// @brief Size-class pool of Buffer<dtype>, buffers are recycled when their last shared_ptr is dropped.
+template <typename dtype>
+class BufferPool
+{
+public:
+    using BufferType = Buffer<dtype>;
+
+private:
+    std::mutex _mutex;
+    std::unordered_map<std::size_t, std::vector<BufferType*>> _free;
+
+    BufferPool() { detail::registerBufferPool( [] { BufferPool::instance().clear(); } ); }
+
+    /// @brief Number of bytes held by a buffer of the given capacity.
+    static int64_t bytes(std::size_t capacity) { return static_cast<int64_t>(capacity * sizeof(dtype)); }
+
+    /// @struct Recycler
+    /// @brief Deleter of pooled buffers, hands the buffer back to the pool.
+    struct Recycler
+    {
+        void operator()(BufferType* buffer) const { BufferPool::instance().release(buffer); }
+    };
+
+    /// @brief Take a buffer with capacity for at least numel elements, size is unspecified.
+    BufferType* take(std::size_t numel)
+    {
+        auto& counters = detail::bufferPoolCounters();
+        std::size_t cls = detail::ceilBufferClass(numel);
+
+        if( buffer_pool_enabled() ) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _free.find(cls);
+            if( it != _free.end() && !it->second.empty() ) {
+                BufferType* buffer = it->second.back();
+                it->second.pop_back();
+                counters.reuses         += 1;
+                counters.cached_buffers -= 1;
+                counters.cached_bytes   -= bytes( buffer->capacity() );
+                return buffer;
+            }
+        }
+
+        counters.allocations += 1;
+        auto* buffer = new BufferType();
+        buffer->reserve(cls);
+        return buffer;
+    }
+
+    /// @brief Wrap a buffer into a shared_ptr that returns it to the pool.
+    static std::shared_ptr<BufferType> share(BufferType* buffer)
+    {
+        return std::shared_ptr<BufferType>( buffer, Recycler{}, detail::PooledBlockAllocator<BufferType>{} );
+    }
+
+public:
+    BufferPool(BufferPool const&)            = delete;
+    BufferPool& operator=(BufferPool const&) = delete;
+
+    /// @brief Get the pool of this element type.
+    /// @note Intentionally leaked, buffers may be released during static destruction.
+    static BufferPool& instance() { static BufferPool* pool = new BufferPool(); return *pool; }
+
+    /// @brief Acquire a buffer of numel value-initialized elements.
+    std::shared_ptr<BufferType> acquire(std::size_t numel)
+    {
+        BufferType* buffer = take(numel);
+        buffer->clear();
+        buffer->resize(numel);
+        return share(buffer);
+    }
+
+    /// @brief Acquire a buffer of numel elements filled with value.
+    std::shared_ptr<BufferType> acquire(std::size_t numel, dtype const& value)
+    {
+        BufferType* buffer = take(numel);
+        buffer->clear();
+        buffer->resize(numel, value);
+        return share(buffer);
+    }
+
+    /// @brief Acquire a buffer holding the elements of a list.
+    std::shared_ptr<BufferType> acquire(std::initializer_list<dtype> list)
+    {
+        BufferType* buffer = take(list.size());
+        buffer->clear();
+        for(dtype const& value: list)
+            buffer->push_back(value);
+        return share(buffer);
+    }
+
+    /// @brief Take over the memory of a vector, it is returned to the pool when the last reference is dropped.
+    std::shared_ptr<BufferType> adopt(std::vector<dtype> vec)
+    {
+        detail::bufferPoolCounters().allocations += 1;
+        return share( new BufferType( std::move(vec) ) );
+    }
+
+    /// @brief Return a buffer to the pool, or free it when the pool is disabled or full.
+    void release(BufferType* buffer)
+    {
+        auto& counters = detail::bufferPoolCounters();
+        std::size_t capacity = buffer->capacity();
+        std::size_t cls = detail::floorBufferClass(capacity);
+
+        // reserve the bytes before caching, so concurrent releases never exceed the capacity together
+        bool keep = cls > 0 && buffer_pool_enabled();
+        if( keep ) {
+            int64_t limit  = buffer_pool_capacity();
+            int64_t cached = counters.cached_bytes.load(std::memory_order_relaxed);
+            do {
+                if( cached + bytes(capacity) > limit ) {
+                    keep = false;
+                    break;
+                }
+            } while( !counters.cached_bytes.compare_exchange_weak(cached, cached + bytes(capacity)) );
+        }
+
+        if( keep ) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _free[cls].push_back(buffer);
+            counters.releases       += 1;
+            counters.cached_buffers += 1;
+            return;
+        }
+
+        counters.evictions += 1;
+        delete buffer;
+    }
+
+    /// @brief Free all cached buffers of this element type.
+    void clear()
+    {
+        auto& counters = detail::bufferPoolCounters();
+        std::lock_guard<std::mutex> lock(_mutex);
+        for(auto& [cls, buffers]: _free) {
+            for(BufferType* buffer: buffers) {
+                counters.cached_buffers -= 1;
+                counters.cached_bytes   -= bytes( buffer->capacity() );
+                delete buffer;
+            }
+        }
+        _free.clear();
+    }
+};
+
+/// @brief Make a pooled buffer of numel value-initialized elements.
+/// @param numel Number of elements
+/// @return Shared buffer, recycled by the pool when the last reference is dropped
+template <typename dtype>
+std::shared_ptr<Buffer<dtype>> make_buffer(std::size_t numel)
+{
+    return BufferPool<dtype>::instance().acquire(numel);
+}
+
+/// @brief Make a pooled buffer of numel elements filled with value.
+/// @param numel Number of elements
+/// @param value Used to initialize the elements of the buffer
+/// @return Shared buffer, recycled by the pool when the last reference is dropped
+template <typename dtype>
+std::shared_ptr<Buffer<dtype>> make_buffer(std::size_t numel, dtype const& value)
+{
+    return BufferPool<dtype>::instance().acquire(numel, value);
+}
+
+/// @brief Make a pooled buffer holding the elements of a list.
+/// @param list Used to initialize the elements of the buffer
+/// @return Shared buffer, recycled by the pool when the last reference is dropped
+template <typename dtype>
+std::shared_ptr<Buffer<dtype>> make_buffer(std::initializer_list<dtype> list)
+{
+    return BufferPool<dtype>::instance().acquire(list);
+}
+
+/// @brief Make a pooled buffer from the memory of a vector without copying.
+/// @param vec Vector whose elements become the buffer
+/// @return Shared buffer, recycled by the pool when the last reference is dropped
+template <typename dtype>
+std::shared_ptr<Buffer<dtype>> make_buffer(std::vector<dtype> vec)
+{
+    return BufferPool<dtype>::instance().adopt( std::move(vec) );
+}
+
+} // namespace core
@@ -26,7 +26,7 @@ NDArrayRef<dtype> concatenate(
     int64_t new_offset  = 0;
     auto    new_numel   = detail::calcNumel(new_shape);
     auto    new_strides = detail::makeCompactStrides(new_shape);
-    auto    new_buffer  = std::make_shared< typename NDArrayRef<dtype>::BufferType >( new_numel );
+    auto    new_buffer  = make_buffer<dtype>( new_numel );
 
     int64_t ndim = new_shape.size();
     if(axis < 0) axis += ndim;
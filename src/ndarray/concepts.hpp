@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <type_traits>
 
 namespace core
@@ -29,3 +30,24 @@ concept isArrayRef = isArrayRefImpl<T>::value;
 /// @brief The value of isNDArrayRefImpl<T>, true or false.
 template <typename T>
 concept isNDArrayRef = isNDArrayRefImpl<T>::value;
+
+/// @brief Element types providing add_n, sub_n and mul_n over contiguous arrays, found by argument dependent lookup.
+/// @details The element wise operations of ArrayRef call these kernels for contiguous operands instead of
+///          invoking the operators once per element.
+template <typename T>
+concept BatchArithmetic = requires(T* r, T const* a, std::size_t n) {
+    add_n(r, a, a, n);
+    sub_n(r, a, a, n);
+    mul_n(r, a, a, n);
+};
+
+/// @brief Element types sharing one object representation, an array of From is read as an array of To without a copy.
+/// @details Types opt in with a member alias representation_type, the conversion between two types with the same
+///          representation_type must keep every bit, e.g. signed and unsigned Z2 of the same K.
+template <typename From, typename To>
+concept SameRepresentation = requires {
+    typename From::representation_type;
+    typename To::representation_type;
+} && std::is_same_v<typename From::representation_type, typename To::representation_type>
+  && sizeof(From) == sizeof(To) && alignof(From) == alignof(To)
+  && std::is_trivially_copyable_v<From> && std::is_trivially_copyable_v<To>;
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+#include "../tools/expr_template.h"
+#include "array_ref.h"
+
+// expression templates fuse element wise arithmetic on ArrayRef into a single pass,
+// e.g. core::evaluate(u*pb + v*pa + uv) reads each operand once and allocates only the result
+
+/************************ enable expression template ************************/
+
+template <typename dtype>
+struct ExprTraits<core::ArrayRef<dtype>>
+{
+    static constexpr auto expr_type = EnumExprType::array;
+    using ref_type = core::ArrayRef<dtype> const &; // save reference for array
+};
+
+namespace core
+{
+
+// found by argument dependent lookup, since core::ArrayRef appears in every expression
+ __define_unary_operator_expression_template__ (-, std::negate<>    );
+__define_binary_operator_expression_template__(+, std::plus<>      );
+__define_binary_operator_expression_template__(-, std::minus<>     );
+__define_binary_operator_expression_template__(*, std::multiplies<>);
+
+namespace detail
+{
+
+/// @brief Element of an array operand, broadcast arrays are read through their zero stride.
+template <typename dtype>
+dtype const& element(ArrayRef<dtype> const& array, int64_t pos)
+{
+    return array[pos];
+}
+
+template <typename Operation, typename Operand>
+auto element(UnaryExpression<Operation, Operand> const& expr, int64_t pos)
+{
+    static constexpr Operation op;
+    return op( element(expr.operand, pos) );
+}
+
+template <typename Operation, typename LhsOperand, typename RhsOperand>
+auto element(BinaryExpression<Operation, LhsOperand, RhsOperand> const& expr, int64_t pos)
+{
+    static constexpr Operation op;
+    return op( element(expr.lhs, pos), element(expr.rhs, pos) );
+}
+
+template <typename dtype>
+int64_t numel(ArrayRef<dtype> const& array)
+{
+    return array.numel();
+}
+
+template <typename Operation, typename Operand>
+int64_t numel(UnaryExpression<Operation, Operand> const& expr)
+{
+    return numel(expr.operand);
+}
+
+template <typename Operation, typename LhsOperand, typename RhsOperand>
+int64_t numel(BinaryExpression<Operation, LhsOperand, RhsOperand> const& expr)
+{
+    auto numell = numel(expr.lhs);
+    auto numelr = numel(expr.rhs);
+    if( numell != numelr ) {
+        throw std::invalid_argument("number of elements mismatch");
+    }
+    return numell;
+}
+
+/// @brief Determine whether every array operand broadcasts a single element.
+template <typename dtype>
+bool broadcast(ArrayRef<dtype> const& array)
+{
+    return array.stride() == 0;
+}
+
+template <typename Operation, typename Operand>
+bool broadcast(UnaryExpression<Operation, Operand> const& expr)
+{
+    return broadcast(expr.operand);
+}
+
+template <typename Operation, typename LhsOperand, typename RhsOperand>
+bool broadcast(BinaryExpression<Operation, LhsOperand, RhsOperand> const& expr)
+{
+    return broadcast(expr.lhs) && broadcast(expr.rhs);
+}
+
+/// @brief Element type produced by an expression.
+template <typename ExprType>
+using expr_value_t = std::remove_cvref_t< decltype( element(std::declval<ExprType const&>(), 0) ) >;
+
+} // namespace detail
+
+/// @brief Evaluate an element wise expression of ArrayRef in one pass.
+/// @param expr Expression built from ArrayRef operands with unary -, binary +, - and *
+/// @return New ArrayRef holding the result
+/// @note Memory allocation: only the result, no intermediate array is created.
+///       The result broadcasts a single element when all operands do.
+///       Operands are held by reference, so the expression must be evaluated within the statement creating it.
+template <ConceptExprCompound ExprType>
+auto evaluate(ExprType const& expr)
+{
+    using rtype = detail::expr_value_t<ExprType>;
+
+    int64_t numel = detail::numel(expr);
+
+    // an expression of broadcast scalars is computed once
+    if( numel > 0 && detail::broadcast(expr) ) {
+        auto new_buffer = make_buffer<rtype>(1);
+        new_buffer->data()[0] = detail::element(expr, 0);
+        return ArrayRef<rtype>(std::move(new_buffer), numel, 0, 0);
+    }
+
+    auto new_buffer = make_buffer<rtype>(numel);
+    auto data = new_buffer->data();
+
+    for(int64_t i = 0; i < numel; ++i) {
+        data[i] = detail::element(expr, i);
+    }
+    return ArrayRef<rtype>(std::move(new_buffer), numel, 1, 0);
+}
+
+/// @brief Evaluate an element wise expression of ArrayRef in one pass, writing the result into out.
+/// @param out Destination, must have the same number of elements as the expression
+/// @param expr Expression built from ArrayRef operands with unary -, binary +, - and *
+/// @return Reference to out
+/// @note Memory allocation: only when out is a broadcast array, which is replaced by a new one.
+///       out may appear in expr, element i of the result only depends on element i of each operand.
+template <typename dtype, ConceptExprCompound ExprType>
+ArrayRef<dtype>& evaluate_into(ArrayRef<dtype>& out, ExprType const& expr)
+{
+    int64_t numel = detail::numel(expr);
+    if( out.numel() != numel ) {
+        throw std::invalid_argument("number of elements mismatch");
+    }
+
+    if( out.stride() == 0 ) {
+        out = evaluate(expr);
+        return out;
+    }
+
+    int64_t stride = out.stride();
+    auto    data   = out.data() + out.offset();
+    for(int64_t i = 0; i < numel; ++i) {
+        data[i * stride] = detail::element(expr, i);
+    }
+    return out;
+}
+
+} // namespace core
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "parallel.hpp"
+
+namespace core
+{
+
+namespace detail
+{
+
+/// @brief Ring element that stores a single machine word and wraps around on overflow, e.g. Z2<K> with 1 < K <= 128.
+/// @note Products and sums are accumulated on the raw unsigned word and reduced once when stored.
+template <typename T>
+concept hasRawRingValue = requires(T const& x) {
+    typename T::value_type;
+    typename T::unsigned_value_type;
+    { x.data() } -> std::same_as<typename T::value_type const*>;
+} && ( !std::same_as<typename T::unsigned_value_type, bool> )
+  && std::constructible_from<T, typename T::value_type>
+  && ( sizeof(T) == sizeof(typename T::value_type) );
+
+/// @struct GemmTraits
+/// @brief Accumulator type of gemm, generic ring types accumulate with their own operators.
+template <typename dtype>
+struct GemmTraits
+{
+    using acc_type = dtype;
+    static acc_type zero()                 { return dtype(0); }
+    static acc_type load(dtype const& x)   { return x; }
+    static dtype    store(acc_type const& x) { return x; }
+};
+
+/// @brief Unsigned accumulator for a raw word, promoted to at least unsigned int so that products never overflow int.
+template <typename uint_type>
+using gemm_word_t = std::conditional_t< (sizeof(uint_type) < sizeof(unsigned)), unsigned, uint_type >;
+
+/// @struct GemmTraits
+/// @brief Builtin integers accumulate in an unsigned type.
+template <typename dtype>
+requires ( std::integral<dtype> && !std::same_as<dtype, bool> )
+struct GemmTraits<dtype>
+{
+    using acc_type = gemm_word_t< std::make_unsigned_t<dtype> >;
+    static acc_type zero()                 { return 0; }
+    static acc_type load(dtype const& x)   { return static_cast<acc_type>(x); }
+    static dtype    store(acc_type const& x) { return static_cast<dtype>(x); }
+};
+
+/// @struct GemmTraits
+/// @brief Word sized rings accumulate on the raw unsigned word, the reduction happens in the constructor.
+template <hasRawRingValue dtype>
+struct GemmTraits<dtype>
+{
+    using acc_type = gemm_word_t< typename dtype::unsigned_value_type >;
+    static acc_type zero()                 { return 0; }
+    static acc_type load(dtype const& x)   { return static_cast<acc_type>( *x.data() ); }
+    static dtype    store(acc_type const& x) { return dtype( static_cast<typename dtype::value_type>(x) ); }
+};
+
+/// @brief Blocking parameters of gemm.
+/// @note Dimensions follow core::matmul, A is M x N and B is N x K.
+///       GEMM_MR x GEMM_KR is the register tile, a GEMM_MC x GEMM_NC block of A is kept in L2
+///       and a GEMM_NC x GEMM_KC panel of B is kept in L3.
+inline constexpr int64_t GEMM_MR = 4;
+inline constexpr int64_t GEMM_KR = 4;
+inline constexpr int64_t GEMM_MC = 64;
+inline constexpr int64_t GEMM_NC = 256;
+inline constexpr int64_t GEMM_KC = 512;
+
+/// @brief Minimal number of multiply-adds assigned to one thread.
+inline constexpr int64_t GEMM_GRAIN = int64_t(1) << 16;
+
+/// @brief Pack a mc x nc block of A into row panels of GEMM_MR rows, zero padded.
+template <typename Traits, typename dtype>
+void gemm_pack_lhs(
+    int64_t mc, int64_t nc,
+    dtype const* A, int64_t rsa, int64_t csa,
+    typename Traits::acc_type* packed)
+{
+    for(int64_t ir = 0; ir < mc; ir += GEMM_MR) {
+        int64_t mr = std::min(GEMM_MR, mc - ir);
+        for(int64_t p = 0; p < nc; ++p) {
+            for(int64_t i = 0; i < mr; ++i)
+                *packed++ = Traits::load( A[(ir+i)*rsa + p*csa] );
+            for(int64_t i = mr; i < GEMM_MR; ++i)
+                *packed++ = Traits::zero();
+        }
+    }
+}
+
+/// @brief Pack a nc x kc panel of B into column panels of GEMM_KR columns, zero padded.
+template <typename Traits, typename dtype>
+void gemm_pack_rhs(
+    int64_t nc, int64_t kc,
+    dtype const* B, int64_t rsb, int64_t csb,
+    typename Traits::acc_type* packed)
+{
+    for(int64_t jr = 0; jr < kc; jr += GEMM_KR) {
+        int64_t kr = std::min(GEMM_KR, kc - jr);
+        for(int64_t p = 0; p < nc; ++p) {
+            for(int64_t j = 0; j < kr; ++j)
+                *packed++ = Traits::load( B[p*rsb + (jr+j)*csb] );
+            for(int64_t j = kr; j < GEMM_KR; ++j)
+                *packed++ = Traits::zero();
+        }
+    }
+}
+
+/// @brief Multiply a packed GEMM_MR row panel with a packed GEMM_KR column panel,
+///        and write (or accumulate) the mr x kr top left corner into C.
+template <typename Traits, typename dtype>
+void gemm_micro_kernel(
+    int64_t nc, int64_t mr, int64_t kr,
+    typename Traits::acc_type const* a,
+    typename Traits::acc_type const* b,
+    dtype* C, int64_t ldc, bool accumulate)
+{
+    using acc_type = typename Traits::acc_type;
+
+    acc_type acc[GEMM_MR][GEMM_KR];
+    for(int64_t i = 0; i < GEMM_MR; ++i)
+        for(int64_t j = 0; j < GEMM_KR; ++j)
+            acc[i][j] = Traits::zero();
+
+    for(int64_t p = 0; p < nc; ++p) {
+        for(int64_t i = 0; i < GEMM_MR; ++i)
+            for(int64_t j = 0; j < GEMM_KR; ++j)
+                acc[i][j] += a[i] * b[j];
+        a += GEMM_MR;
+        b += GEMM_KR;
+    }
+
+    for(int64_t i = 0; i < mr; ++i) {
+        for(int64_t j = 0; j < kr; ++j) {
+            dtype& c = C[i*ldc + j];
+            c = accumulate ? Traits::store( Traits::load(c) + acc[i][j] ) : Traits::store( acc[i][j] );
+        }
+    }
+}
+
+/// @brief Single threaded cache blocked C = A * B, where A is M x N and B is N x K.
+/// @note Element (i,j) of A is A[i*rsa + j*csa], element (i,j) of B is B[i*rsb + j*csb],
+///       so transposed and strided views are read in place. C is row major with leading dimension ldc.
+template <typename dtype>
+void gemm_serial(
+    int64_t M, int64_t N, int64_t K,
+    dtype const* A, int64_t rsa, int64_t csa,
+    dtype const* B, int64_t rsb, int64_t csb,
+    dtype* C, int64_t ldc)
+{
+    using Traits = GemmTraits<dtype>;
+    using acc_type = typename Traits::acc_type;
+
+    if( N == 0 ) {
+        for(int64_t i = 0; i < M; ++i)
+            for(int64_t j = 0; j < K; ++j)
+                C[i*ldc + j] = Traits::store( Traits::zero() );
+        return;
+    }
+
+    std::vector<acc_type> packed_lhs( GEMM_MC * std::min(GEMM_NC, N) );
+    std::vector<acc_type> packed_rhs( std::min(GEMM_NC, N) * ((std::min(GEMM_KC, K) + GEMM_KR - 1) / GEMM_KR * GEMM_KR) );
+
+    for(int64_t jc = 0; jc < K; jc += GEMM_KC) {
+        int64_t kc = std::min(GEMM_KC, K - jc);
+
+        for(int64_t pc = 0; pc < N; pc += GEMM_NC) {
+            int64_t nc = std::min(GEMM_NC, N - pc);
+            bool accumulate = (pc != 0);
+
+            gemm_pack_rhs<Traits>(nc, kc, B + pc*rsb + jc*csb, rsb, csb, packed_rhs.data());
+
+            for(int64_t ic = 0; ic < M; ic += GEMM_MC) {
+                int64_t mc = std::min(GEMM_MC, M - ic);
+
+                gemm_pack_lhs<Traits>(mc, nc, A + ic*rsa + pc*csa, rsa, csa, packed_lhs.data());
+
+                for(int64_t jr = 0; jr < kc; jr += GEMM_KR) {
+                    for(int64_t ir = 0; ir < mc; ir += GEMM_MR) {
+                        gemm_micro_kernel<Traits>(
+                            nc, std::min(GEMM_MR, mc - ir), std::min(GEMM_KR, kc - jr),
+                            packed_lhs.data() + ir * nc,
+                            packed_rhs.data() + jr * nc,
+                            C + (ic+ir)*ldc + (jc+jr), ldc, accumulate );
+                    }
+                }
+            }
+        }
+    }
+}
+
+/// @brief Multi-threaded cache blocked C = A * B, where A is M x N and B is N x K.
+/// @note The larger of the two output dimensions is split across threads, see gemm_serial for the layout.
+template <typename dtype>
+void gemm(
+    int64_t M, int64_t N, int64_t K,
+    dtype const* A, int64_t rsa, int64_t csa,
+    dtype const* B, int64_t rsb, int64_t csb,
+    dtype* C, int64_t ldc)
+{
+    // number of multiply-adds per output row or column
+    int64_t row_work = std::max<int64_t>(N * K, 1);
+    int64_t col_work = std::max<int64_t>(M * N, 1);
+
+    if( M >= K ) {
+        int64_t grain = std::max<int64_t>(GEMM_MR, GEMM_GRAIN / row_work);
+        grain = (grain + GEMM_MR - 1) / GEMM_MR * GEMM_MR;
+        parallel_for(0, M, grain, [&](int64_t begin, int64_t end) {
+            gemm_serial(end - begin, N, K, A + begin*rsa, rsa, csa, B, rsb, csb, C + begin*ldc, ldc);
+        });
+    } else {
+        int64_t grain = std::max<int64_t>(GEMM_KR, GEMM_GRAIN / col_work);
+        grain = (grain + GEMM_KR - 1) / GEMM_KR * GEMM_KR;
+        parallel_for(0, K, grain, [&](int64_t begin, int64_t end) {
+            gemm_serial(M, N, end - begin, A, rsa, csa, B + begin*csb, rsb, csb, C + begin, ldc);
+        });
+    }
+}
+
+} // namespace detail
+
+} // namespace core
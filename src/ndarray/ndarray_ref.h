@@ -8,6 +8,7 @@
 #include <functional>
 
 #include "buffer.hpp"
+#include "buffer_pool.hpp"
 #include "iterator.hpp"
 #include "slice.hpp"
 #include "util.hpp"
@@ -112,6 +113,16 @@ class NDArrayRef
     /// @note Memory allocation: always, currently only one-dimensional arrays are supported.
     NDArrayRef substitute(std::span<const int64_t> indicies, NDArrayRef value) const;
 
+    /// @brief Return a new array, where the elements at two sets of indices are substituted in a single copy.
+    /// @param indicies1 Indices substituted by value1
+    /// @param value1 Input value to substitute at indicies1
+    /// @param indicies2 Indices substituted by value2, written after value1
+    /// @param value2 Input value to substitute at indicies2
+    /// @return Array, equal to substitute(indicies1, value1).substitute(indicies2, value2)
+    /// @note Memory allocation: always, currently only one-dimensional arrays are supported.
+    NDArrayRef substitute(std::span<const int64_t> indicies1, NDArrayRef value1,
+                          std::span<const int64_t> indicies2, NDArrayRef value2) const;
+
     /// @brief Return a reference to the element at the specified index location.
     /// @param index.size() == shape.size()
     /// @return Reference to the element at the specified index location
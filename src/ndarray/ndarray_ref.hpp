@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ndarray_ref.h"
+#include "parallel.hpp"
 
 #include <ranges>
 
@@ -109,6 +110,29 @@ NDArrayRef<dtype> NDArrayRef<dtype>::slice(std::vector<std::variant<Slice, int64
 
 /************************ permute ************************/
 
+namespace detail
+{
+
+/// @brief Minimal number of elements gathered or scattered by one thread.
+inline constexpr int64_t PERMUTE_GRAIN = int64_t(1) << 16;
+
+/// @brief Scatter value into dest at the given one-dimensional indices, dest[indicies[i]] = value[i].
+/// @note Indices must have been checked by checkIndicies, negative ones count from the end.
+///       Indices may repeat, the writes run in order on one thread so the last one wins.
+template <typename dtype>
+void scatter(dtype* dest, int64_t extent, std::span<const int64_t> indicies, NDArrayRef<dtype> const& value)
+{
+    auto    src    = value.data() + value.offset();
+    int64_t stride = value.strides()[0];
+
+    for(std::size_t i = 0; i < indicies.size(); ++i) {
+        int64_t index = indicies[i] < 0 ? indicies[i] + extent : indicies[i];
+        dest[index] = src[i * stride];
+    }
+}
+
+} // namespace detail
+
 /// @brief Return a new array consisting of elements at specified indicies.
 /// @param indicies.size() <= shape.size(). accepts both integers and slices
 /// @return Array consisting of elements at specified indicies
@@ -128,18 +152,28 @@ NDArrayRef<dtype> NDArrayRef<dtype>::permute(std::span<const int64_t> indicies)
         throw std::invalid_argument("not implemented yet");
     }
 
+    int64_t extent = _shape[0];
+    detail::checkIndicies(indicies, extent);
+
     int64_t new_numel  = indicies.size();
     int64_t new_offset = 0;
 
     // currently only one-dimensional arrays are supported
     auto new_shape   = std::vector<int64_t>{ new_numel };
-    auto new_buffer  = std::make_shared<BufferType>(new_numel);
+    auto new_buffer  = make_buffer<dtype>(new_numel);
     auto new_strides = detail::makeCompactStrides( new_shape );
     auto new_data    = new_buffer->data();
 
-    for(int64_t i = 0; i < new_numel; ++i) {
-        new_data[i] = this->elem( {indicies[i]} );
-    }
+    // gather straight from the buffer instead of computing a multi-dimensional index per element
+    auto    src    = this->data() + _offset;
+    int64_t stride = _strides[0];
+
+    detail::parallel_for(0, new_numel, detail::PERMUTE_GRAIN, [&](int64_t begin, int64_t end) {
+        for(int64_t i = begin; i < end; ++i) {
+            int64_t index = indicies[i] < 0 ? indicies[i] + extent : indicies[i];
+            new_data[i] = src[index * stride];
+        }
+    });
 
     return { std::move(new_buffer), std::move(new_shape), std::move(new_strides), new_offset };
 }
@@ -172,10 +206,50 @@ NDArrayRef<dtype> NDArrayRef<dtype>::substitute(std::span<const int64_t> indicie
         throw std::invalid_argument("invalid value");
     }
 
+    int64_t extent = _shape[0];
+    detail::checkIndicies(indicies, extent);
+
     auto new_arr = this->copy();
-    for(int64_t i = 0; i < indicies.size(); ++i) {
-        new_arr.elem( {indicies[i]} ) = value.elem( {i} );
+    detail::scatter(new_arr.data(), extent, indicies, value);
+    return new_arr;
+}
+
+/// @brief Return a new array, where the elements at two sets of indices are substituted in a single copy.
+/// @param indicies1 Indices substituted by value1
+/// @param value1 Input value to substitute at indicies1
+/// @param indicies2 Indices substituted by value2, written after value1
+/// @param value2 Input value to substitute at indicies2
+/// @return Array, equal to substitute(indicies1, value1).substitute(indicies2, value2)
+/// @note Memory allocation: always, currently only one-dimensional arrays are supported.
+template<typename dtype>
+NDArrayRef<dtype> NDArrayRef<dtype>::substitute(
+    std::span<const int64_t> indicies1, NDArrayRef<dtype> value1,
+    std::span<const int64_t> indicies2, NDArrayRef<dtype> value2) const
+{
+    if(this->ndim() <= 0) {
+        throw std::invalid_argument("invalid ndim");
+    }
+
+    if(this->ndim() >  1) {
+        // maybe implement this using concatenate
+        throw std::invalid_argument("not implemented yet");
     }
+
+    if(value1.ndim() != 1 || value2.ndim() != 1) {
+        throw std::invalid_argument("invalid value");
+    }
+
+    if(indicies1.size() != value1.numel() || indicies2.size() != value2.numel()) {
+        throw std::invalid_argument("invalid value");
+    }
+
+    int64_t extent = _shape[0];
+    detail::checkIndicies(indicies1, extent);
+    detail::checkIndicies(indicies2, extent);
+
+    auto new_arr = this->copy();
+    detail::scatter(new_arr.data(), extent, indicies1, value1);
+    detail::scatter(new_arr.data(), extent, indicies2, value2);
     return new_arr;
 }
 
@@ -204,16 +278,15 @@ NDArrayRef<dtype> NDArrayRef<dtype>::copy() const
     auto const& old_offset = _offset;
     auto const& old_strides = _strides;
 
-    auto new_data = std::make_shared<BufferType>();
+    auto new_data = make_buffer<dtype>( numel() );
     auto new_shape = old_shape;
     auto new_offset = 0;
     auto new_strides = detail::makeCompactStrides( new_shape );
 
+    auto dest = new_data->data();
+
     // for compact strides, use memcpy to avoid computing indicies
     if( detail::isCompactStrides( old_strides, old_shape) && std::is_trivially_copyable_v<dtype> ) {
-        new_data->resize( numel() );
-
-        auto dest = new_data->data();
         auto src = old_buffer->data() + old_offset;
         auto nbytes = sizeof(dtype) * numel();
 
@@ -221,16 +294,14 @@ NDArrayRef<dtype> NDArrayRef<dtype>::copy() const
     }
     // for linear strides, use linear index to reduce indicies computation
     else if( detail::isLinearStrides( old_strides, old_shape ) ) {
-        new_data->reserve( numel() );
         for(auto iter = this->lbegin(); iter != this->lend(); ++iter) {
-            new_data->push_back( *iter );
+            *dest++ = *iter;
         }
     }
     // for non-linear strides, copy one by one
     else {
-        new_data->reserve( numel() );
         for(auto iter = this->begin(); iter != this->end(); ++iter) {
-            new_data->push_back( *iter );
+            *dest++ = *iter;
         }
     }
 
@@ -341,7 +412,7 @@ NDArrayRef<new_type> NDArrayRef<old_type>::as() const
     int64_t new_offset  = 0;
     auto    new_shape   = old_shape;
     auto    new_strides = detail::makeCompactStrides(new_shape);
-    auto    new_buffer  = std::make_shared<typename NDArrayRef<new_type>::BufferType >(numel);
+    auto    new_buffer  = make_buffer<new_type>(numel);
     auto    new_data    = new_buffer->data();
 
     if( detail::isLinearStrides( old_strides, old_shape ) )
@@ -405,10 +476,9 @@ NDArrayRef<dtype> arange(dtype start, dtype stop, dtype step)
 
     // prepare data
     using namespace std::ranges::views;
-    auto data = std::make_shared<typename NDArrayRef<dtype>::BufferType>();
-    data->reserve(numel);
-    for (auto x : iota(0, numel) | transform([start, step](auto i) -> dtype { return start + static_cast<dtype>(i) * step; })) {
-        data->push_back(x);
+    auto data = make_buffer<dtype>(numel);
+    for (auto i : iota(int64_t(0), numel)) {
+        (*data)[i] = start + static_cast<dtype>(i) * step;
     }
 
     return { std::move(data), std::move(shape), std::move(strides), offset };
@@ -446,13 +516,13 @@ NDArrayRef<dtype> make_ndarray (dtype const& value, std::vector<int64_t> shape,
     {
         int64_t offset  = 0;
         int64_t numel   = detail::calcNumel(shape);
-        auto    buffer  = std::make_shared<typename NDArrayRef<dtype>::BufferType>(numel, value);
+        auto    buffer  = make_buffer<dtype>(numel, value);
         auto    strides = detail::makeCompactStrides(shape);
         return {std::move(buffer), std::move(shape), std::move(strides), offset };
     }
     else
     {
-        auto buffer  = std::make_shared<typename NDArrayRef<dtype>::BufferType>(1, value);
+        auto buffer  = make_buffer<dtype>(1, value);
         auto strides = detail::makeLinearStrides(0, shape);
         int64_t offset = 0;
         return { std::move(buffer), std::move(shape), std::move(strides), offset };
@@ -468,7 +538,7 @@ NDArrayRef<dtype> make_ndarray (std::vector<int64_t> shape)
     int64_t offset  = 0;
     auto    numel   = detail::calcNumel(shape);
     auto    strides = detail::makeCompactStrides(shape);
-    auto    buffer  = std::make_shared< typename NDArrayRef<dtype>::BufferType >( numel );
+    auto    buffer  = make_buffer<dtype>( numel );
 
     return { std::move(buffer), std::move(shape), std::move(strides), offset };
 }
@@ -482,7 +552,7 @@ NDArrayRef<dtype> make_ndarray (std::vector<dtype> data)
     int64_t offset  = 0;
     auto    strides = std::vector<int64_t>{ 1 };
     auto    shape   = std::vector<int64_t>{ static_cast<int64_t>(data.size()) };
-    auto    buffer  = std::make_shared< typename NDArrayRef<dtype>::BufferType >( std::move(data) );
+    auto    buffer  = make_buffer<dtype>( std::move(data) );
 
     return { std::move(buffer), std::move(shape), std::move(strides), offset };
 }
@@ -496,7 +566,7 @@ NDArrayRef<dtype> make_ndarray (std::initializer_list<dtype> data)
     int64_t offset  = 0;
     auto    strides = std::vector<int64_t>{ 1 };
     auto    shape   = std::vector<int64_t>{ static_cast<int64_t>(data.size()) };
-    auto    buffer  = std::make_shared< typename NDArrayRef<dtype>::BufferType >( data );
+    auto    buffer  = make_buffer<dtype>( data );
 
     return { std::move(buffer), std::move(shape), std::move(strides), offset };
 }
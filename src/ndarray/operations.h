@@ -35,6 +35,47 @@ ArrayRef<dtype> sub(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs);
 template <typename dtype>
 ArrayRef<dtype> mul(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs);
 
+/// @brief Inverts the given ArrayRef in place.
+/// @param in The array to be overwritten
+/// @return Reference to in
+template <typename dtype>
+ArrayRef<dtype>& neg_inplace(ArrayRef<dtype>& in);
+
+/// @brief The given left ArrayRef add the given right ArrayRef in place, lhs += rhs.
+/// @param lhs The left operand, overwritten by the result
+/// @param rhs Constant reference for the right operand ArrayRef
+/// @return Reference to lhs
+template <typename dtype>
+ArrayRef<dtype>& add_inplace(ArrayRef<dtype>& lhs, ArrayRef<dtype> const& rhs);
+
+/// @brief The given left ArrayRef sub the given right ArrayRef in place, lhs -= rhs.
+/// @param lhs The left operand, overwritten by the result
+/// @param rhs Constant reference for the right operand ArrayRef
+/// @return Reference to lhs
+template <typename dtype>
+ArrayRef<dtype>& sub_inplace(ArrayRef<dtype>& lhs, ArrayRef<dtype> const& rhs);
+
+/// @brief The given left ArrayRef mul the given right ArrayRef in place, lhs *= rhs.
+/// @param lhs The left operand, overwritten by the result
+/// @param rhs Constant reference for the right operand ArrayRef
+/// @return Reference to lhs
+template <typename dtype>
+ArrayRef<dtype>& mul_inplace(ArrayRef<dtype>& lhs, ArrayRef<dtype> const& rhs);
+
+/// @brief Overloads for temporary operands.
+/// @note The buffer of a temporary operand is reused for the result when it is uniquely owned,
+///       otherwise these behave exactly like the overloads taking constant references.
+template <typename dtype> ArrayRef<dtype> neg(ArrayRef<dtype>&& in);
+template <typename dtype> ArrayRef<dtype> add(ArrayRef<dtype>&& lhs, ArrayRef<dtype> const& rhs);
+template <typename dtype> ArrayRef<dtype> add(ArrayRef<dtype> const& lhs, ArrayRef<dtype>&& rhs);
+template <typename dtype> ArrayRef<dtype> add(ArrayRef<dtype>&& lhs, ArrayRef<dtype>&& rhs);
+template <typename dtype> ArrayRef<dtype> sub(ArrayRef<dtype>&& lhs, ArrayRef<dtype> const& rhs);
+template <typename dtype> ArrayRef<dtype> sub(ArrayRef<dtype> const& lhs, ArrayRef<dtype>&& rhs);
+template <typename dtype> ArrayRef<dtype> sub(ArrayRef<dtype>&& lhs, ArrayRef<dtype>&& rhs);
+template <typename dtype> ArrayRef<dtype> mul(ArrayRef<dtype>&& lhs, ArrayRef<dtype> const& rhs);
+template <typename dtype> ArrayRef<dtype> mul(ArrayRef<dtype> const& lhs, ArrayRef<dtype>&& rhs);
+template <typename dtype> ArrayRef<dtype> mul(ArrayRef<dtype>&& lhs, ArrayRef<dtype>&& rhs);
+
 /// @brief Bitwise_not the given ArrayRef.
 /// @param in A constant reference to the input array
 /// @return The resulting ArrayRef
@@ -65,4 +106,12 @@ ArrayRef<dtype> bitwise_and(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& r
 template <typename dtype>
 ArrayRef<dtype> matmul(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs, int64_t M, int64_t N, int64_t K);
 
+/// @brief Performs matrix multiplication on the given two-dimensional NDArrayRef.
+/// @param lhs Constant reference for the left operand matrix, may be a transposed, sliced or broadcast view
+/// @param rhs Constant reference for the right operand matrix, may be a transposed, sliced or broadcast view
+/// @return The resulting compact NDArrayRef
+/// @note Memory allocation: only for the result, strided inputs are read in place.
+template <typename dtype>
+NDArrayRef<dtype> matmul(NDArrayRef<dtype> const& lhs, NDArrayRef<dtype> const& rhs);
+
 } // namspace core
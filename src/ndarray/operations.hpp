@@ -2,13 +2,55 @@
 
 #include "operations.h"
 
+#include "concepts.hpp"
 #include "tools.hpp"
+#include "gemm.hpp"
 
 #include <eigen3/Eigen/Dense>
 
 namespace core
 {
 
+namespace detail
+{
+
+/// @brief Evaluate a batch kernel over two contiguous operands into a new array.
+/// @param kernel(dtype* r, dtype const* a, dtype const* b, size_t n)
+template <typename dtype, typename Kernel>
+ArrayRef<dtype> apply_batch(Kernel&& kernel, ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs)
+{
+    if( lhs.numel() != rhs.numel() ) {
+        throw std::invalid_argument("number of elements mismatch");
+    }
+    int64_t numel  = lhs.numel();
+    auto    buffer = make_buffer<dtype>(numel);
+    if( numel > 0 )
+        kernel(buffer->data(), lhs.data() + lhs.offset(), rhs.data() + rhs.offset(), numel);
+    return { std::move(buffer), numel, 1, 0 };
+}
+
+/// @brief Evaluate a batch kernel over two contiguous operands, overwriting lhs.
+/// @param kernel(dtype* r, dtype const* a, dtype const* b, size_t n)
+template <typename dtype, typename Kernel>
+void apply_batch_inplace(Kernel&& kernel, ArrayRef<dtype>& lhs, ArrayRef<dtype> const& rhs)
+{
+    if( lhs.numel() != rhs.numel() ) {
+        throw std::invalid_argument("number of elements mismatch");
+    }
+    auto data = lhs.data() + lhs.offset();
+    if( lhs.numel() > 0 )
+        kernel(data, data, rhs.data() + rhs.offset(), lhs.numel());
+}
+
+/// @brief Determine whether both operands can be handed to a batch kernel.
+template <typename dtype>
+bool isBatchable(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs)
+{
+    return lhs.stride() == 1 && rhs.stride() == 1;
+}
+
+} // namespace detail
+
 /// @brief Inverts the given ArrayRef.
 /// @param in A constant reference to the input array
 /// @return The resulting ArrayRef
@@ -25,6 +67,10 @@ ArrayRef<dtype> neg(ArrayRef<dtype> const& in)
 template <typename dtype>
 ArrayRef<dtype> add(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs)
 {
+    if constexpr ( BatchArithmetic<dtype> ) {
+        if( detail::isBatchable(lhs, rhs) )
+            return detail::apply_batch([](auto... args){ add_n(args...); }, lhs, rhs);
+    }
     return apply(std::plus<>{}, lhs, rhs);
 }
 
@@ -35,6 +81,10 @@ ArrayRef<dtype> add(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs)
 template <typename dtype>
 ArrayRef<dtype> sub(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs)
 {
+    if constexpr ( BatchArithmetic<dtype> ) {
+        if( detail::isBatchable(lhs, rhs) )
+            return detail::apply_batch([](auto... args){ sub_n(args...); }, lhs, rhs);
+    }
     return apply(std::minus<>{}, lhs, rhs);
 }
 
@@ -45,9 +95,181 @@ ArrayRef<dtype> sub(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs)
 template <typename dtype>
 ArrayRef<dtype> mul(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs)
 {
+    if constexpr ( BatchArithmetic<dtype> ) {
+        if( detail::isBatchable(lhs, rhs) )
+            return detail::apply_batch([](auto... args){ mul_n(args...); }, lhs, rhs);
+    }
     return apply(std::multiplies<>{}, lhs, rhs);
 }
 
+/************************ in-place and temporary operands ************************/
+
+namespace detail
+{
+
+/// @brief Determine whether the buffer of a temporary ArrayRef can hold the result of an element wise operation.
+template <typename dtype>
+bool isReusable(ArrayRef<dtype> const& in)
+{
+    return in.unique() && in.stride() != 0;
+}
+
+} // namespace detail
+
+/// @brief Inverts the given ArrayRef in place.
+/// @param in The array to be overwritten
+/// @return Reference to in
+template <typename dtype>
+ArrayRef<dtype>& neg_inplace(ArrayRef<dtype>& in)
+{
+    apply_inplace(std::negate<>{}, in);
+    return in;
+}
+
+/// @brief The given left ArrayRef add the given right ArrayRef in place, lhs += rhs.
+/// @param lhs The left operand, overwritten by the result
+/// @param rhs Constant reference for the right operand ArrayRef
+/// @return Reference to lhs
+template <typename dtype>
+ArrayRef<dtype>& add_inplace(ArrayRef<dtype>& lhs, ArrayRef<dtype> const& rhs)
+{
+    if constexpr ( BatchArithmetic<dtype> ) {
+        if( detail::isBatchable(lhs, rhs) ) {
+            detail::apply_batch_inplace([](auto... args){ add_n(args...); }, lhs, rhs);
+            return lhs;
+        }
+    }
+    apply_inplace(std::plus<>{}, lhs, rhs);
+    return lhs;
+}
+
+/// @brief The given left ArrayRef sub the given right ArrayRef in place, lhs -= rhs.
+/// @param lhs The left operand, overwritten by the result
+/// @param rhs Constant reference for the right operand ArrayRef
+/// @return Reference to lhs
+template <typename dtype>
+ArrayRef<dtype>& sub_inplace(ArrayRef<dtype>& lhs, ArrayRef<dtype> const& rhs)
+{
+    if constexpr ( BatchArithmetic<dtype> ) {
+        if( detail::isBatchable(lhs, rhs) ) {
+            detail::apply_batch_inplace([](auto... args){ sub_n(args...); }, lhs, rhs);
+            return lhs;
+        }
+    }
+    apply_inplace(std::minus<>{}, lhs, rhs);
+    return lhs;
+}
+
+/// @brief The given left ArrayRef mul the given right ArrayRef in place, lhs *= rhs.
+/// @param lhs The left operand, overwritten by the result
+/// @param rhs Constant reference for the right operand ArrayRef
+/// @return Reference to lhs
+template <typename dtype>
+ArrayRef<dtype>& mul_inplace(ArrayRef<dtype>& lhs, ArrayRef<dtype> const& rhs)
+{
+    if constexpr ( BatchArithmetic<dtype> ) {
+        if( detail::isBatchable(lhs, rhs) ) {
+            detail::apply_batch_inplace([](auto... args){ mul_n(args...); }, lhs, rhs);
+            return lhs;
+        }
+    }
+    apply_inplace(std::multiplies<>{}, lhs, rhs);
+    return lhs;
+}
+
+/// @brief Inverts the given temporary ArrayRef, reusing its buffer when uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> neg(ArrayRef<dtype>&& in)
+{
+    if( !detail::isReusable(in) )
+        return neg(in);
+    return std::move( neg_inplace(in) );
+}
+
+/// @brief Add with a temporary left operand, reusing its buffer when uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> add(ArrayRef<dtype>&& lhs, ArrayRef<dtype> const& rhs)
+{
+    if( !detail::isReusable(lhs) )
+        return add(lhs, rhs);
+    return std::move( add_inplace(lhs, rhs) );
+}
+
+/// @brief Add with a temporary right operand, reusing its buffer when uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> add(ArrayRef<dtype> const& lhs, ArrayRef<dtype>&& rhs)
+{
+    if( !detail::isReusable(rhs) )
+        return add(lhs, rhs);
+    apply_inplace([](auto const& y, auto const& x){ return x + y; }, rhs, lhs);
+    return std::move(rhs);
+}
+
+/// @brief Add with two temporary operands, reusing whichever buffer is uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> add(ArrayRef<dtype>&& lhs, ArrayRef<dtype>&& rhs)
+{
+    if( detail::isReusable(lhs) )
+        return add(std::move(lhs), rhs);
+    return add(lhs, std::move(rhs));
+}
+
+/// @brief Sub with a temporary left operand, reusing its buffer when uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> sub(ArrayRef<dtype>&& lhs, ArrayRef<dtype> const& rhs)
+{
+    if( !detail::isReusable(lhs) )
+        return sub(lhs, rhs);
+    return std::move( sub_inplace(lhs, rhs) );
+}
+
+/// @brief Sub with a temporary right operand, reusing its buffer when uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> sub(ArrayRef<dtype> const& lhs, ArrayRef<dtype>&& rhs)
+{
+    if( !detail::isReusable(rhs) )
+        return sub(lhs, rhs);
+    apply_inplace([](auto const& y, auto const& x){ return x - y; }, rhs, lhs);
+    return std::move(rhs);
+}
+
+/// @brief Sub with two temporary operands, reusing whichever buffer is uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> sub(ArrayRef<dtype>&& lhs, ArrayRef<dtype>&& rhs)
+{
+    if( detail::isReusable(lhs) )
+        return sub(std::move(lhs), rhs);
+    return sub(lhs, std::move(rhs));
+}
+
+/// @brief Mul with a temporary left operand, reusing its buffer when uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> mul(ArrayRef<dtype>&& lhs, ArrayRef<dtype> const& rhs)
+{
+    if( !detail::isReusable(lhs) )
+        return mul(lhs, rhs);
+    return std::move( mul_inplace(lhs, rhs) );
+}
+
+/// @brief Mul with a temporary right operand, reusing its buffer when uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> mul(ArrayRef<dtype> const& lhs, ArrayRef<dtype>&& rhs)
+{
+    if( !detail::isReusable(rhs) )
+        return mul(lhs, rhs);
+    apply_inplace([](auto const& y, auto const& x){ return x * y; }, rhs, lhs);
+    return std::move(rhs);
+}
+
+/// @brief Mul with two temporary operands, reusing whichever buffer is uniquely owned.
+template <typename dtype>
+ArrayRef<dtype> mul(ArrayRef<dtype>&& lhs, ArrayRef<dtype>&& rhs)
+{
+    if( detail::isReusable(lhs) )
+        return mul(std::move(lhs), rhs);
+    return mul(lhs, std::move(rhs));
+}
+
 /// @brief Bitwise_not the given ArrayRef.
 /// @param in A constant reference to the input array
 /// @return The resulting ArrayRef
@@ -77,6 +299,42 @@ ArrayRef<dtype> bitwise_and(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& r
     return apply(std::bit_and<>{}, lhs, rhs);
 }
 
+namespace detail
+{
+
+/// @brief Compute the row major M x K product of a M x N matrix and a N x K matrix given by row and column strides.
+/// @note Floating point types go through Eigen, integer rings (e.g. Z2<K>) use the blocked wrap-around gemm.
+template <typename dtype>
+void matmul_impl(
+    int64_t M, int64_t N, int64_t K,
+    dtype const* lhs, int64_t lhs_row_stride, int64_t lhs_col_stride,
+    dtype const* rhs, int64_t rhs_row_stride, int64_t rhs_col_stride,
+    dtype* out)
+{
+    if constexpr ( std::floating_point<dtype> )
+    {
+        using namespace Eigen;
+        // MatrixType is a matrix type that is an Eigen matrix type instantiated using the specified data type dtype, 
+        // dynamically sized rows and columns, and row main-order storage
+        using MatrixType = Matrix<dtype, Dynamic, Dynamic, RowMajor>;
+        using StrideType = Stride<Dynamic, Dynamic>;
+
+        // Map: Map is a class in the Eigen library that maps external data to Eigen's matrix objects without having to copy the data.
+        Map<const MatrixType, 0, StrideType> mlhs { lhs, M, N, StrideType{ lhs_row_stride, lhs_col_stride } };
+        Map<const MatrixType, 0, StrideType> mrhs { rhs, N, K, StrideType{ rhs_row_stride, rhs_col_stride } };
+
+        Map<MatrixType> mans { out, M, K };
+
+        mans = mlhs * mrhs;
+    }
+    else
+    {
+        gemm(M, N, K, lhs, lhs_row_stride, lhs_col_stride, rhs, rhs_row_stride, rhs_col_stride, out, K);
+    }
+}
+
+} // namespace detail
+
 /// @brief Performs matrix multiplication on the given ArrayRef.
 /// @param lhs Constant reference for the left operand matrix
 /// @param rhs Constant reference for the right operand matrix
@@ -93,31 +351,40 @@ ArrayRef<dtype> matmul(ArrayRef<dtype> const& lhs, ArrayRef<dtype> const& rhs, i
     if( lhs.stride() == 0 || rhs.stride() == 0 )
         throw std::invalid_argument("stride must be non zero");
 
-    using namespace Eigen;
-    // MatrixType is a matrix type that is an Eigen matrix type instantiated using the specified data type dtype, 
-    // dynamically sized rows and columns, and row main-order storage
-    using MatrixType = Matrix<dtype, Dynamic, Dynamic, RowMajor>;
-    using StrideType = Stride<Dynamic, Dynamic>;
-
-    auto new_buffer = std::make_shared<typename ArrayRef<dtype>::BufferType>(M*K);
+    auto new_buffer = make_buffer<dtype>(M*K);
     auto new_data = new_buffer->data();
     int64_t new_numel = M*K;
     int64_t new_offset = 0;
     int64_t new_stride = 1;
 
-    // Map: Map is a class in the Eigen library that maps external data to Eigen's matrix objects without having to copy the data.
-    // const MatrixType: This is the type of the matrix object to be mapped, where MatrixType is the Eigen matrix type generated from the template parameter dtype.
-    // 0: indicates that the mapped matrix object is constant, that is, the mapped data cannot be modified.
-    // StrideType: Specifies the step type of the matrix to specify the span between elements.
-    // mlhs and mrhs: are two matrix objects created with the Map class, corresponding to the left operand lhs and the right operand rhs, respectively.
-    Map<const MatrixType, 0, StrideType> mlhs { lhs.data() + lhs.offset(), M, N, StrideType{ lhs.stride()*N, lhs.stride() } };
-    Map<const MatrixType, 0, StrideType> mrhs { rhs.data() + rhs.offset(), N, K, StrideType{ rhs.stride()*K, rhs.stride() } };
+    detail::matmul_impl<dtype>(
+        M, N, K,
+        lhs.data() + lhs.offset(), lhs.stride()*N, lhs.stride(),
+        rhs.data() + rhs.offset(), rhs.stride()*K, rhs.stride(),
+        new_data );
+
+    return { std::move(new_buffer), new_numel, new_stride, new_offset };
+}
+
+/// @brief Performs matrix multiplication on the given two-dimensional NDArrayRef.
+/// @param lhs Constant reference for the left operand matrix, may be a transposed, sliced or broadcast view
+/// @param rhs Constant reference for the right operand matrix, may be a transposed, sliced or broadcast view
+/// @return The resulting compact NDArrayRef
+template <typename dtype>
+NDArrayRef<dtype> matmul(NDArrayRef<dtype> const& lhs, NDArrayRef<dtype> const& rhs)
+{
+    auto [M, N, K] = detail::deduceMatmulShape(lhs.shape(), rhs.shape());
 
-    Map<MatrixType> mans { new_data, M, K };
+    auto new_buffer = make_buffer<dtype>(M*K);
+    auto new_data = new_buffer->data();
 
-    mans = mlhs * mrhs;
+    detail::matmul_impl<dtype>(
+        M, N, K,
+        lhs.data() + lhs.offset(), lhs.strides()[0], lhs.strides()[1],
+        rhs.data() + rhs.offset(), rhs.strides()[0], rhs.strides()[1],
+        new_data );
 
-    return { std::move(new_buffer), new_numel, new_stride, new_offset };
+    return { std::move(new_buffer), {M, K}, detail::makeCompactStrides(std::vector<int64_t>{M, K}), 0 };
 }
 
 } // namspace core
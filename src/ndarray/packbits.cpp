@@ -1,6 +1,8 @@
 
 #include <cmath>
+#include <cstring>
 
+#include "../tools/bit_packing.h"
 #include "../tools/math.h"
 
 #include "util.hpp"
@@ -10,12 +12,64 @@
 namespace core
 {
 
-///@brief performs packbits for the input NDArrayRef
-///@param in NDArray to perform bit-packing operation.
-///@param _axis Specifies the axis of the packaging operation, default no-value, which mean output is one-dimensional
-///@return The packed NDArray, where each element represents the bit-packed result at the corresponding position in the input
-NDArrayRef<uint8_t> packbits(NDArrayRef<uint8_t> const& in, std::optional<int64_t> _axis)
+namespace detail
+{
+
+/// @brief Pack a strided lane of numel 0/1 values into ceil(numel/8) bytes.
+template <typename dtype>
+void packLane(dtype const* src, int64_t src_stride, int64_t numel, uint8_t* dest, int64_t dest_stride)
+{
+    int64_t nbytes = numel / 8;
+
+    if( src_stride == 1 ) {
+        for(int64_t i = 0; i < nbytes; ++i) {
+            dest[i * dest_stride] = pack8(src + i*8);
+        }
+    }
+    else {
+        for(int64_t i = 0; i < nbytes; ++i) {
+            uint8_t x = 0;
+            for(int64_t k = 0; k < 8; ++k) {
+                x |= static_cast<uint8_t>( (src[(i*8+k) * src_stride] & 1) << k );
+            }
+            dest[i * dest_stride] = x;
+        }
+    }
+
+    if( numel % 8 != 0 ) {
+        uint8_t x = 0;
+        for(int64_t i = nbytes * 8; i < numel; ++i) {
+            x |= static_cast<uint8_t>( (src[i * src_stride] & 1) << (i%8) );
+        }
+        dest[nbytes * dest_stride] = x;
+    }
+}
+
+/// @brief Unpack a strided lane of numel bytes into 8*numel 0/1 values.
+template <typename rtype>
+void unpackLane(uint8_t const* src, int64_t src_stride, int64_t numel, rtype* dest, int64_t dest_stride)
 {
+    if( dest_stride == 1 ) {
+        for(int64_t i = 0; i < numel; ++i) {
+            unpack8(src[i * src_stride], dest + i*8);
+        }
+    }
+    else {
+        for(int64_t i = 0; i < numel; ++i) {
+            uint8_t x = src[i * src_stride];
+            for(int64_t k = 0; k < 8; ++k) {
+                dest[(i*8+k) * dest_stride] = static_cast<rtype>( (x >> k) & 1 );
+            }
+        }
+    }
+}
+
+/// @brief Implementation of packbits for 0/1 arrays stored one byte per element.
+template <typename dtype>
+NDArrayRef<uint8_t> packbits(NDArrayRef<dtype> const& in, std::optional<int64_t> _axis)
+{
+    static_assert( sizeof(dtype) == 1, "packbits expects one byte per element" );
+
     int64_t     old_numel   = in.numel();
     int64_t     old_offset  = in.offset();
     auto        old_data    = in.data();
@@ -26,7 +80,7 @@ NDArrayRef<uint8_t> packbits(NDArrayRef<uint8_t> const& in, std::optional<int64_
     int64_t new_offset;
     std::vector<int64_t> new_shape;
     std::vector<int64_t> new_strides;
-    auto new_buffer = std::make_shared< NDArrayRef<uint8_t>::BufferType >();
+    std::shared_ptr<Buffer<uint8_t>> new_buffer;
 
     if( _axis.has_value() ) {
         int64_t ndim = in.ndim();
@@ -42,7 +96,7 @@ NDArrayRef<uint8_t> packbits(NDArrayRef<uint8_t> const& in, std::optional<int64_
         new_shape[axis] = ceildiv( old_shape[axis], 8 );
         new_strides = detail::makeCompactStrides(new_shape);
         new_numel = detail::calcNumel(new_shape);
-        new_buffer->resize(new_numel);
+        new_buffer = make_buffer<uint8_t>(new_numel);
         auto new_data = new_buffer->data();
 
         auto reduced_strides = new_strides;
@@ -50,36 +104,11 @@ NDArrayRef<uint8_t> packbits(NDArrayRef<uint8_t> const& in, std::optional<int64_
 
         /* packing */
         for_each_axis(in, axis, [new_data, new_strides, new_offset, &reduced_strides, ndim, axis]
-        (std::span<const int64_t> index, NDArrayRef<uint8_t> arr)
+        (std::span<const int64_t> index, NDArrayRef<dtype> arr)
         {
-            auto    sold_data   = arr.data();
-            int64_t sold_numel  = arr.numel();
-            int64_t sold_offset = arr.offset();
-            auto    sold_stride = arr.strides().back();
-
             auto snew_offset = detail::calcNDIndex(index, reduced_strides, new_offset, ndim-1);
-            auto snew_data   = new_data;
-            auto snew_stride = new_strides[axis];
-
-            for(int64_t i = 0; i < sold_numel/8; ++i) {
-                snew_data[ snew_offset + i*snew_stride ] =
-                    ( (sold_data[ sold_offset + (i*8+0) * sold_stride ] & 1) << 0) |
-                    ( (sold_data[ sold_offset + (i*8+1) * sold_stride ] & 1) << 1) |
-                    ( (sold_data[ sold_offset + (i*8+2) * sold_stride ] & 1) << 2) |
-                    ( (sold_data[ sold_offset + (i*8+3) * sold_stride ] & 1) << 3) |
-                    ( (sold_data[ sold_offset + (i*8+4) * sold_stride ] & 1) << 4) |
-                    ( (sold_data[ sold_offset + (i*8+5) * sold_stride ] & 1) << 5) |
-                    ( (sold_data[ sold_offset + (i*8+6) * sold_stride ] & 1) << 6) |
-                    ( (sold_data[ sold_offset + (i*8+7) * sold_stride ] & 1) << 7);
-            }
-
-            if( sold_numel % 8 != 0 ) {
-                uint8_t& x = snew_data[ snew_offset + sold_numel/8 * snew_stride ];
-                x = 0;
-                for(std::size_t i = sold_numel/8 * 8; i < sold_numel; ++i) {
-                    x |= ( (sold_data[ sold_offset + i*sold_stride ] & 1) << (i%8) );
-                }
-            }
+            packLane(arr.data() + arr.offset(), arr.strides().back(), arr.numel(),
+                     new_data + snew_offset, new_strides[axis]);
         });
     }
     else
@@ -88,49 +117,28 @@ NDArrayRef<uint8_t> packbits(NDArrayRef<uint8_t> const& in, std::optional<int64_
         new_offset  = 0;
         new_shape   = { new_numel };
         new_strides = { 1 };
-        new_buffer->resize( new_numel );
+        new_buffer  = make_buffer<uint8_t>(new_numel);
         auto new_data = new_buffer->data();
 
         if( detail::isLinearStrides( old_strides, old_shape ) )
         {
-            int64_t old_stride = old_strides.back();
-            for(int64_t i = 0; i < old_numel/8; ++i) {
-                new_data[i] =
-                    ( (old_data[ old_offset + (i*8+0) * old_stride ] & 1) << 0) |
-                    ( (old_data[ old_offset + (i*8+1) * old_stride ] & 1) << 1) |
-                    ( (old_data[ old_offset + (i*8+2) * old_stride ] & 1) << 2) |
-                    ( (old_data[ old_offset + (i*8+3) * old_stride ] & 1) << 3) |
-                    ( (old_data[ old_offset + (i*8+4) * old_stride ] & 1) << 4) |
-                    ( (old_data[ old_offset + (i*8+5) * old_stride ] & 1) << 5) |
-                    ( (old_data[ old_offset + (i*8+6) * old_stride ] & 1) << 6) |
-                    ( (old_data[ old_offset + (i*8+7) * old_stride ] & 1) << 7);
-            }
-
-            if( old_numel % 8 != 0 ) {
-                uint8_t& x = new_data[ old_numel/8 ];
-                x = 0;
-                for(std::size_t i = old_numel/8 * 8; i < old_numel; ++i) {
-                    x |= ( (old_data[ old_offset + i*old_stride ] & 1) << (i%8) );
-                }
-            }
+            packLane(old_data + old_offset, old_strides.back(), old_numel, new_data, 1);
         }
-        else /* non-linear strides */
+        else /* non-linear strides, linear iterators are not available */
         {
-            memset(new_data, 0, new_numel);
-            for_each(in, [new_data](int64_t i, uint8_t x){
-                new_data[ i/8 ] |= (x&1 << (i%8));
-            });
+            auto compact = in.copy();
+            packLane(compact.data(), 1, old_numel, new_data, 1);
         }
     }
     return { std::move(new_buffer), std::move(new_shape), std::move(new_strides), new_offset };
 }
 
-///@brief performs unpackbits for the input NDArrayRef
-///@param in NDArray to perform bit-unpacking operation.
-///@param _axis Specifies the axis of the packaging operation, default no-value, which mean output is one-dimensional
-///@return Unpacked NDArray, where each element represents the bit unpacked result at the corresponding position in the input
-NDArrayRef<uint8_t> unpackbits(NDArrayRef<uint8_t> const& in, std::optional<int64_t> _axis)
+/// @brief Implementation of unpackbits into 0/1 arrays stored one byte per element.
+template <typename rtype>
+NDArrayRef<rtype> unpackbits(NDArrayRef<uint8_t> const& in, std::optional<int64_t> _axis)
 {
+    static_assert( sizeof(rtype) == 1, "unpackbits expects one byte per element" );
+
     int64_t old_numel = in.numel();
     int64_t old_offset = in.offset();
     auto old_data = in.data();
@@ -141,7 +149,7 @@ NDArrayRef<uint8_t> unpackbits(NDArrayRef<uint8_t> const& in, std::optional<int6
     int64_t new_offset;
     std::vector<int64_t> new_shape;
     std::vector<int64_t> new_strides;
-    auto new_buffer = std::make_shared< NDArrayRef<uint8_t>::BufferType >();
+    std::shared_ptr<Buffer<rtype>> new_buffer;
 
     if(_axis.has_value()) {
         int64_t ndim = in.ndim();
@@ -157,28 +165,10 @@ NDArrayRef<uint8_t> unpackbits(NDArrayRef<uint8_t> const& in, std::optional<int6
         new_shape[axis] = old_shape[axis] * 8;
         new_strides = detail::makeCompactStrides(new_shape);
         new_numel = detail::calcNumel(new_shape);
-        new_buffer->resize(new_numel);
+        new_buffer = make_buffer<rtype>(new_numel);
         auto new_data = new_buffer->data();
 
         /* unpacking */
-
-        // auto reduced_shape = old_shape;  reduced_shape[axis] = 1;
-        // for(int64_t i = 0; i < detail::calcNumel(reduced_shape); ++i) {
-        //     auto old_begin = detail::calcLinearIndex(i, reduced_shape, old_strides, old_offset);
-        //     auto new_begin = detail::calcLinearIndex(i, reduced_shape, new_strides, new_offset);
-
-        //     for(int64_t j = 0; j < old_shape[axis]; ++j) {
-        //         new_data[ new_begin + (8*j+0)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 0) & 1;
-        //         new_data[ new_begin + (8*j+1)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 1) & 1;
-        //         new_data[ new_begin + (8*j+2)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 2) & 1;
-        //         new_data[ new_begin + (8*j+3)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 3) & 1;
-        //         new_data[ new_begin + (8*j+4)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 4) & 1;
-        //         new_data[ new_begin + (8*j+5)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 5) & 1;
-        //         new_data[ new_begin + (8*j+6)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 6) & 1;
-        //         new_data[ new_begin + (8*j+7)*new_strides[axis] ] = (old_data[ old_begin + j*old_strides[axis] ] >> 7) & 1;
-        //     }
-        // }
-
         int64_t snew_stride = new_strides[axis];
         auto reduced_strides = new_strides;
         reduced_strides.erase( reduced_strides.begin() + axis );
@@ -187,16 +177,8 @@ NDArrayRef<uint8_t> unpackbits(NDArrayRef<uint8_t> const& in, std::optional<int6
         (std::span<const int64_t> index, NDArrayRef<uint8_t> arr)
         {
             int64_t snew_offset = detail::calcNDIndex(index, reduced_strides, new_offset, ndim-1);
-            for_each(arr, [new_data, snew_offset, snew_stride](int64_t i, uint8_t x){
-                new_data[ snew_offset + (8*i + 0) * snew_stride ] = (x >> 0) & 1;
-                new_data[ snew_offset + (8*i + 1) * snew_stride ] = (x >> 1) & 1;
-                new_data[ snew_offset + (8*i + 2) * snew_stride ] = (x >> 2) & 1;
-                new_data[ snew_offset + (8*i + 3) * snew_stride ] = (x >> 3) & 1;
-                new_data[ snew_offset + (8*i + 4) * snew_stride ] = (x >> 4) & 1;
-                new_data[ snew_offset + (8*i + 5) * snew_stride ] = (x >> 5) & 1;
-                new_data[ snew_offset + (8*i + 6) * snew_stride ] = (x >> 6) & 1;
-                new_data[ snew_offset + (8*i + 7) * snew_stride ] = (x >> 7) & 1;
-            });
+            unpackLane(arr.data() + arr.offset(), arr.strides().back(), arr.numel(),
+                       new_data + snew_offset, snew_stride);
         });
     }
     else
@@ -205,23 +187,60 @@ NDArrayRef<uint8_t> unpackbits(NDArrayRef<uint8_t> const& in, std::optional<int6
         new_offset = 0;
         new_shape = { new_numel };
         new_strides = { 1 };
-        new_buffer->resize(new_numel);
+        new_buffer = make_buffer<rtype>(new_numel);
         auto new_data = new_buffer->data();
 
         /* unpacking */
-        for_each( in, [ new_data ](int64_t i, uint8_t x){
-            new_data[8*i + 0] = (x >> 0) & 1;
-            new_data[8*i + 1] = (x >> 1) & 1;
-            new_data[8*i + 2] = (x >> 2) & 1;
-            new_data[8*i + 3] = (x >> 3) & 1;
-            new_data[8*i + 4] = (x >> 4) & 1;
-            new_data[8*i + 5] = (x >> 5) & 1;
-            new_data[8*i + 6] = (x >> 6) & 1;
-            new_data[8*i + 7] = (x >> 7) & 1;
-        });
+        if( detail::isLinearStrides( old_strides, old_shape ) )
+        {
+            unpackLane(old_data + old_offset, old_strides.back(), old_numel, new_data, 1);
+        }
+        else /* non-linear strides, linear iterators are not available */
+        {
+            auto compact = in.copy();
+            unpackLane(compact.data(), 1, old_numel, new_data, 1);
+        }
     }
 
     return { std::move(new_buffer), std::move(new_shape), std::move(new_strides), new_offset };
 }
 
+} // namespace detail
+
+///@brief performs packbits for the input NDArrayRef
+///@param in NDArray to perform bit-packing operation.
+///@param _axis Specifies the axis of the packaging operation, default no-value, which mean output is one-dimensional
+///@return The packed NDArray, where each element represents the bit-packed result at the corresponding position in the input
+NDArrayRef<uint8_t> packbits(NDArrayRef<uint8_t> const& in, std::optional<int64_t> _axis)
+{
+    return detail::packbits(in, _axis);
+}
+
+///@brief performs packbits for the input boolean NDArrayRef
+///@param in NDArray to perform bit-packing operation.
+///@param _axis Specifies the axis of the packaging operation, default no-value, which mean output is one-dimensional
+///@return The packed NDArray, holding eight booleans per byte
+NDArrayRef<uint8_t> packbits(NDArrayRef<bool> const& in, std::optional<int64_t> _axis)
+{
+    return detail::packbits(in, _axis);
+}
+
+///@brief performs unpackbits for the input NDArrayRef
+///@param in NDArray to perform bit-unpacking operation.
+///@param _axis Specifies the axis of the packaging operation, default no-value, which mean output is one-dimensional
+///@return Unpacked NDArray, where each element represents the bit unpacked result at the corresponding position in the input
+NDArrayRef<uint8_t> unpackbits(NDArrayRef<uint8_t> const& in, std::optional<int64_t> _axis)
+{
+    return detail::unpackbits<uint8_t>(in, _axis);
+}
+
+///@brief performs unpackbits for the input NDArrayRef, producing booleans
+///@param in NDArray to perform bit-unpacking operation.
+///@param _axis Specifies the axis of the packaging operation, default no-value, which mean output is one-dimensional
+///@return Unpacked boolean NDArray, the inverse of packbits(NDArrayRef<bool>) up to padding
+NDArrayRef<bool> unpackbits_bool(NDArrayRef<uint8_t> const& in, std::optional<int64_t> _axis)
+{
+    return detail::unpackbits<bool>(in, _axis);
+}
+
 } // namspace core
@@ -0,0 +1,191 @@
+#include "parallel.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace core
+{
+
+namespace
+{
+
+std::atomic<int64_t> g_num_threads{0};
+
+/// @brief Limit of the current thread set by ThreadLimit, 0 if none.
+thread_local int64_t t_thread_limit = 0;
+
+/// @brief Tasks of one run_parallel call, claimed one by one by the caller and the pool threads.
+struct Job {
+    std::function<void(int64_t)> const* task;
+    int64_t ntasks;
+    int64_t limit;
+    std::atomic<int64_t> next{0};
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    int64_t done = 0;
+    std::exception_ptr error;
+
+    /// @brief Run tasks until none is left to claim, under the thread limit of the caller.
+    void work()
+    {
+        int64_t saved = std::exchange(t_thread_limit, limit);
+        for(int64_t i; (i = next.fetch_add(1)) < ntasks; ) {
+            std::exception_ptr e;
+            bool failed;
+            {
+                std::lock_guard lock(mutex);
+                failed = bool(error);
+            }
+            if( !failed ) {
+                try {
+                    (*task)(i);
+                } catch(...) {
+                    e = std::current_exception();
+                }
+            }
+
+            std::lock_guard lock(mutex);
+            if( e && !error )
+                error = e;
+            if( ++done == ntasks )
+                finished.notify_all();
+        }
+        t_thread_limit = saved;
+    }
+};
+
+/// @brief Threads kept alive across parallel kernels, grown on demand and joined at exit.
+class ThreadPool
+{
+  public:
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard lock(_mutex);
+            _stop = true;
+        }
+        _wakeup.notify_all();
+        for(auto& t: _threads)
+            t.join();
+    }
+
+    /// @brief Offer a job to nhelpers pool threads, starting more threads if fewer exist.
+    void submit(std::shared_ptr<Job> const& job, int64_t nhelpers)
+    {
+        {
+            std::lock_guard lock(_mutex);
+            while( static_cast<int64_t>(_threads.size()) < nhelpers )
+                _threads.emplace_back([this] { loop(); });
+            for(int64_t i = 0; i < nhelpers; ++i)
+                _queue.push_back(job);
+        }
+        _wakeup.notify_all();
+    }
+
+  private:
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+    std::deque<std::shared_ptr<Job>> _queue;
+    std::vector<std::thread> _threads;
+    bool _stop = false;
+
+    void loop()
+    {
+        while( true ) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock lock(_mutex);
+                _wakeup.wait(lock, [this] { return _stop || !_queue.empty(); });
+                if( _queue.empty() )
+                    return;
+                job = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            job->work();
+        }
+    }
+};
+
+ThreadPool& thread_pool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+} // namespace
+
+/// @brief Get the number of threads used by parallel ndarray kernels.
+/// @return Number of threads, defaults to std::thread::hardware_concurrency()
+int64_t get_num_threads()
+{
+    int64_t n = g_num_threads.load(std::memory_order_relaxed);
+    if( n <= 0 )
+        n = std::max<int64_t>( std::thread::hardware_concurrency(), 1 );
+    if( t_thread_limit > 0 )
+        n = std::min(n, t_thread_limit);
+    return n;
+}
+
+/// @brief Set the number of threads used by parallel ndarray kernels.
+/// @param num_threads Number of threads, 0 restores the default and 1 disables threading
+void set_num_threads(int64_t num_threads)
+{
+    if( num_threads < 0 )
+        throw std::invalid_argument("number of threads must be non negative");
+    g_num_threads.store(num_threads, std::memory_order_relaxed);
+}
+
+/// @brief Constructor, start limiting.
+/// @param num_threads Maximum number of threads, at least 1
+ThreadLimit::ThreadLimit(int64_t num_threads)
+    : _saved(t_thread_limit)
+{
+    if( num_threads < 1 )
+        throw std::invalid_argument("thread limit must be positive");
+    t_thread_limit = _saved > 0 ? std::min(_saved, num_threads) : num_threads;
+}
+
+/// @brief Destructor, restore the previous limit.
+ThreadLimit::~ThreadLimit()
+{
+    t_thread_limit = _saved;
+}
+
+namespace detail
+{
+
+/// @brief Run task(0), ..., task(ntasks-1) on the calling thread and the threads of the kernel pool.
+/// @note The caller claims tasks like the pool threads do and only waits for tasks already running elsewhere,
+///       so nested calls from inside a task cannot deadlock on a busy pool.
+void run_parallel(int64_t ntasks, std::function<void(int64_t)> const& task)
+{
+    if( ntasks <= 0 )
+        return;
+
+    auto job = std::make_shared<Job>();
+    job->task   = &task;
+    job->ntasks = ntasks;
+    job->limit  = t_thread_limit;
+
+    int64_t nhelpers = std::min(get_num_threads(), ntasks) - 1;
+    if( nhelpers > 0 )
+        thread_pool().submit(job, nhelpers);
+
+    job->work();
+
+    std::unique_lock lock(job->mutex);
+    job->finished.wait(lock, [&] { return job->done == ntasks; });
+    if( job->error )
+        std::rethrow_exception(job->error);
+}
+
+} // namespace detail
+
+} // namespace core
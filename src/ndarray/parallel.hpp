@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace core
+{
+
+/// @brief Get the number of threads used by parallel ndarray kernels.
+/// @return Number of threads, defaults to std::thread::hardware_concurrency()
+int64_t get_num_threads();
+
+/// @brief Set the number of threads used by parallel ndarray kernels.
+/// @param num_threads Number of threads, 0 restores the default and 1 disables threading
+void set_num_threads(int64_t num_threads);
+
+/// @class ThreadLimit
+/// @brief Limit the threads of the parallel ndarray kernels called by the current thread while in scope.
+/// @note Nested limits only lower the number further. Pool threads working for a kernel inherit the limit of its caller.
+class ThreadLimit
+{
+  public:
+    /// @brief Constructor, start limiting.
+    /// @param num_threads Maximum number of threads, at least 1
+    explicit ThreadLimit(int64_t num_threads);
+
+    /// @brief Destructor, restore the previous limit.
+    ~ThreadLimit();
+
+    ThreadLimit(ThreadLimit const&)            = delete;
+    ThreadLimit& operator=(ThreadLimit const&) = delete;
+
+  private:
+    int64_t _saved;
+};
+
+namespace detail
+{
+
+/// @brief Run task(0), ..., task(ntasks-1) on the calling thread and the threads of the kernel pool.
+/// @param ntasks Number of tasks
+/// @param task Function called as task(int64_t index)
+/// @note Blocks until every task finished. The first exception thrown by a task is rethrown on the calling thread,
+///       tasks which did not start yet are skipped then. Tasks may call run_parallel themselves.
+void run_parallel(int64_t ntasks, std::function<void(int64_t)> const& task);
+
+/// @brief Split [begin, end) into contiguous chunks and run fn(chunk_begin, chunk_end) on each of them in parallel.
+/// @param begin First index of the range
+/// @param end One past the last index of the range
+/// @param grain Minimum number of indices per chunk, the range is never split further than this
+/// @param fn Function called as fn(int64_t chunk_begin, int64_t chunk_end)
+/// @note The calling thread processes chunks too, small ranges run inline. Exceptions propagate to the caller.
+template <typename Fn>
+void parallel_for(int64_t begin, int64_t end, int64_t grain, Fn&& fn)
+{
+    int64_t total = end - begin;
+    if( total <= 0 )
+        return;
+
+    grain = std::max<int64_t>(grain, 1);
+    int64_t nchunks = std::min( get_num_threads(), (total + grain - 1) / grain );
+
+    if( nchunks <= 1 ) {
+        std::invoke(fn, begin, end);
+        return;
+    }
+
+    int64_t chunk = (total + nchunks - 1) / nchunks;
+    nchunks = (total + chunk - 1) / chunk;
+
+    run_parallel(nchunks, [&fn, begin, end, chunk](int64_t i) {
+        int64_t b = begin + i * chunk;
+        std::invoke(fn, b, std::min(b + chunk, end));
+    });
+}
+
+} // namespace detail
+
+} // namespace core
@@ -1,55 +1,74 @@
 #pragma once
 
+#include <algorithm>
+#include <limits>
 
-#include "serialization/serialization.hpp"
+#include "../serialization/serialization.hpp"
 
 #include "concepts.hpp"
 
 #include "array_ref.hpp"
 #include "ndarray_ref.hpp"
+#include "tools.hpp"
 
-/// @brief Serializer for ArrayRef.
-/// @param sr Serializer reference
-/// @param array ArrayRef const reference
+// the serializer of ArrayRef lives in serialization/stl.h
+
+/// @brief Number of bytes written by serializing an NDArrayRef.
+/// @param array NDArrayRef const reference
+/// @return Size of the shape plus the (packed) elements
 template <typename dtype>
-void serialize(Serializer& sr, core::ArrayRef<dtype> const& array)
+requires ( detail::TriviallySerializable<dtype> )
+std::size_t serialized_size(core::NDArrayRef<dtype> const& array)
 {
-    sr << array.numel();
-    core::for_each(array, [&sr](auto const& x){
-        sr << x;
-    });
-}
-
-/// @brief Deserializer for ArrayRef.
-/// @param sr Deserializer reference
-/// @return Output ArrayRef
-template <isArrayRef ArrayRefType>
-ArrayRefType deserialize_get(Deserializer& dr)
-{
-    int64_t numel;
-    int64_t stride = 1;
-    int64_t offset = 0;
-
-    dr >> numel;
-
-    auto buffer = std::make_shared< typename ArrayRefType::BufferType >(numel);
-    auto data = buffer->data();
-
-    dr >> std::span( data, static_cast<std::size_t>(numel) );
-
-    return { std::move(buffer), numel, stride, offset };
+    return serialized_size( array.shape() ) + detail::array_payload_size<dtype>( array.numel() );
 }
 
 /// @brief Serializer for NDArrayRef.
 /// @param sr Serializer reference
 /// @param array NDArrayRef const reference
+/// @note Trivially serializable elements are written in bulk after reserving the exact size,
+///       packed serializable elements take wire_bits bits each.
 template <typename dtype>
 void serialize(Serializer& sr, core::NDArrayRef<dtype> const& array)
 {
-    sr << array.shape();
-    core::for_each(array, [&sr](auto const& x){
-        sr << x;
-    });
+    auto const& shape   = array.shape();
+    auto const& strides = array.strides();
+    int64_t     numel   = array.numel();
+
+    if constexpr ( detail::PackedSerializable<dtype> ) {
+        std::size_t nbytes = detail::array_payload_size<dtype>(numel);
+        sr.reserve( serialized_size(array) );
+        sr << shape;
+
+        if( numel == 0 ) return;
+        using word_type = typename dtype::unsigned_value_type;
+        if( core::detail::isLinearStrides(strides, shape) ) {
+            pack_words<dtype::wire_bits, word_type>(array.data() + array.offset(), strides.back(), numel, sr.extend(nbytes));
+        }
+        else /* non-linear strides, linear iterators are not available */ {
+            auto compact = array.copy();
+            pack_words<dtype::wire_bits, word_type>(compact.data(), 1, numel, sr.extend(nbytes));
+        }
+    }
+    else if constexpr ( detail::TriviallySerializable<dtype> ) {
+        sr.reserve( serialized_size(array) );
+        sr << shape;
+
+        if( numel == 0 ) return;
+        if( core::detail::isLinearStrides(strides, shape) ) {
+            detail::serialize_strided(sr, array.data() + array.offset(), strides.back(), numel);
+        }
+        else /* non-linear strides, linear iterators are not available */ {
+            auto compact = array.copy();
+            detail::serialize_strided(sr, compact.data(), 1, numel);
+        }
+    }
+    else {
+        sr << shape;
+        core::for_each(array, [&sr](std::span<const int64_t>, auto const& x){
+            sr << x;
+        });
+    }
 }
 
 /// @brief Deserializer for NDArrayRef.
@@ -58,15 +77,38 @@ void serialize(Serializer& sr, core::NDArrayRef<dtype> const& array)
 template <isNDArrayRef NDArrayRefType>
 NDArrayRefType deserialize_get(Deserializer& dr)
 {
-    auto    shape   = dr.get< std::vector<int64_t> >();
+    using dtype = typename NDArrayRefType::value_type;
+
+    auto shape = dr.get< std::vector<int64_t> >();
+
+    // the shape comes from the wire, its product must neither overflow nor exceed the payload
+    if( std::ranges::any_of(shape, [](int64_t extent) { return extent < 0; }) )
+        throw deserialization_error{};
+    std::size_t wire_numel = std::ranges::find(shape, 0) != shape.end() ? 0 : 1;
+    for(auto extent: shape) {
+        if( wire_numel == 0 )
+            break;
+        if( wire_numel > std::numeric_limits<std::size_t>::max() / static_cast<std::size_t>(extent) )
+            throw deserialization_error{};
+        wire_numel *= static_cast<std::size_t>(extent);
+    }
+    if constexpr ( detail::TriviallySerializable<dtype> )
+        detail::check_array_payload<dtype>(wire_numel, dr.remaining());
+
     auto    strides = core::detail::makeCompactStrides(shape);
-    int64_t numel   = core::detail::calcNumel(shape);
+    int64_t numel   = static_cast<int64_t>(wire_numel);
     int64_t offset  = 0;
 
-    auto buffer = std::make_shared< typename NDArrayRefType::BufferType >( numel );
+    auto buffer = core::make_buffer<dtype>( numel );
     auto data   = buffer->data();
 
-    dr >> std::span( data, static_cast<std::size_t>(numel) );
+    if constexpr ( detail::PackedSerializable<dtype> ) {
+        std::size_t nbytes = detail::array_payload_size<dtype>(numel);
+        unpack_words<dtype::wire_bits, typename dtype::unsigned_value_type>( dr.view(nbytes), numel, data );
+    }
+    else {
+        dr >> std::span( data, static_cast<std::size_t>(numel) );
+    }
 
     return { std::move(buffer), std::move(shape), std::move(strides), offset };
 }
@@ -96,4 +96,19 @@ NDArrayRef<rtype> apply(Fn&& fn, NDArrayRef<dtype> const& in);
 template <typename Fn, typename dtype1, typename dtype2, typename rtype = std::invoke_result_t<Fn, dtype1, dtype2>>
 NDArrayRef<rtype> apply(Fn&& fn, NDArrayRef<dtype1> const& lhs, NDArrayRef<dtype2> const& rhs);
 
+/// @brief In-place element wise operation, inout[i] = fn(inout[i]).
+/// @param fn(dtype) -> dtype
+/// @param inout Value to be applied and overwritten
+/// @note Memory allocation: never, elements shared with other arrays are overwritten as well.
+template <typename Fn, typename dtype>
+void apply_inplace(Fn&& fn, ArrayRef<dtype>& inout);
+
+/// @brief In-place element wise operation, lhs[i] = fn(lhs[i], rhs[i]).
+/// @param fn(dtype1, dtype2) -> dtype1
+/// @param lhs First input value, overwritten by the result
+/// @param rhs Second input value to be applied
+/// @note Memory allocation: only when lhs has zero stride and rhs does not.
+template <typename Fn, typename dtype1, typename dtype2>
+void apply_inplace(Fn&& fn, ArrayRef<dtype1>& lhs, ArrayRef<dtype2> const& rhs);
+
 } // namespace core
@@ -2,6 +2,7 @@
 
 #include "tools.h"
 
+#include <algorithm>
 #include <concepts>
 #include <type_traits>
 
@@ -27,10 +28,18 @@ ArrayRef<dtype> flatten(NDArrayRef<dtype> const& in)
 /// @param in The ArrayRef of the one-dimensional array to be unflattened
 /// @param shape Specifies the shape, passed as std::vector<int64_t>
 /// @return The recovered NDArrayRef object with the specified shape
-/// @note Memory allocation: never.
+/// @note Memory allocation: only for arrays reinterpreted by ArrayRef::as, which have no buffer of dtype to share.
 template <typename dtype>
 NDArrayRef<dtype> unflatten(ArrayRef<dtype> const& in, std::vector<int64_t> shape)
 {
+    if( !in.sptr() ) {
+        auto buffer = make_buffer<dtype>( in.numel() );
+        auto dest   = buffer->data();
+        for(int64_t i = 0; i < in.numel(); ++i)
+            dest[i] = in[i];
+        return unflatten(ArrayRef<dtype>(std::move(buffer), in.numel(), 1, 0), std::move(shape));
+    }
+
     auto new_buffer = in.sptr();
     auto new_strides = detail::makeLinearStrides( in.stride(), shape );
     auto new_offset = in.offset();
@@ -226,7 +235,7 @@ NDArrayRef<dtype> reduce(
         int64_t new_offset = 0;
         auto    new_shape  = old_shape;  new_shape[axis] = 1;
         int64_t new_numel  = detail::calcNumel( new_shape );
-        auto    new_buffer = std::make_shared<typename NDArrayRef<dtype>::BufferType>( new_numel );
+        auto    new_buffer = make_buffer<dtype>( new_numel );
         auto    new_data   = new_buffer->data();
 
         // fn = std::tuple<Fn>(std::forward<Fn>(fn)) is used to capture the reduction function fn 
@@ -252,7 +261,7 @@ NDArrayRef<dtype> reduce(
         for_each(in, [&sum, fn=std::tuple<Fn>(std::forward<Fn>(fn))](dtype const& x){
             sum = std::invoke(std::get<0>(fn), sum, x);
         });
-        auto    new_buffer  = std::make_shared< typename NDArrayRef<dtype>::BufferType >(1, sum);
+        auto    new_buffer  = make_buffer<dtype>(1, sum);
         auto    new_shape   = std::vector<int64_t> {};
         auto    new_strides = std::vector<int64_t> {};
         int64_t new_offset  = 0;
@@ -272,7 +281,7 @@ ArrayRef<rtype> apply(Fn&& fn, ArrayRef<dtype> const& in)
     // static_assert( std::same_as<rtype, void> == false );
     static_assert(  std::same_as< std::invoke_result_t<Fn, dtype>, void> == false );
     if(in.stride() == 0) {
-        auto new_buffer = std::make_shared< typename ArrayRef<rtype>::BufferType >( 1 );
+        auto new_buffer = make_buffer<rtype>( 1 );
         new_buffer->data()[0] = std::invoke(std::forward<Fn>(fn), in[0]);
         return { std::move(new_buffer), in.numel(), 0, 0 };
     }
@@ -280,7 +289,7 @@ ArrayRef<rtype> apply(Fn&& fn, ArrayRef<dtype> const& in)
     int64_t numel = in.numel();
     int64_t new_stride = 1;
     int64_t new_offset = 0;
-    auto new_buffer = std::make_shared< typename ArrayRef<rtype>::BufferType >(numel);
+    auto new_buffer = make_buffer<rtype>(numel);
     auto new_data = new_buffer->data();
 
     auto iter = in.begin();
@@ -324,7 +333,7 @@ ArrayRef<rtype> apply(Fn&& fn, ArrayRef<dtype1> const& lhs, ArrayRef<dtype2> con
     int64_t numel = lhs.numel();
     int64_t new_stride = 1;
     int64_t new_offset = 0;
-    auto    new_buffer = std::make_shared< typename ArrayRef<rtype>::BufferType >(numel);
+    auto    new_buffer = make_buffer<rtype>(numel);
     auto    new_data   = new_buffer->data();
 
     auto liter = lhs.begin();
@@ -346,11 +355,18 @@ NDArrayRef<rtype> apply(Fn&& fn, NDArrayRef<dtype> const& in)
     int64_t     old_numel = in.numel();
     auto const& old_shape = in.shape();
 
+    // a broadcast scalar stays a broadcast scalar
+    if( old_numel > 0 && detail::isBroadcastStrides(in.strides()) ) {
+        auto new_buffer = make_buffer<rtype>( 1 );
+        new_buffer->data()[0] = std::invoke(std::forward<Fn>(fn), in.data()[in.offset()]);
+        return { std::move(new_buffer), old_shape, in.strides(), 0 };
+    }
+
     int64_t new_offset  = 0;
     int64_t new_numel   = old_numel;
     auto    new_shape   = old_shape;
     auto    new_strides = detail::makeCompactStrides(new_shape);
-    auto    new_buffer  = std::make_shared< typename NDArrayRef<rtype>::BufferType >( new_numel );
+    auto    new_buffer  = make_buffer<rtype>( new_numel );
     auto    new_data    = new_buffer->data();
 
     for_each(in, [new_data, fn=std::tuple<Fn>(std::forward<Fn>(fn))](int64_t i, dtype const& x){
@@ -372,11 +388,18 @@ NDArrayRef<rtype> apply(Fn&& fn, NDArrayRef<dtype1> const& lhs, NDArrayRef<dtype
         throw std::invalid_argument("shape of arrays mismatch");
     }
 
+    // two broadcast scalars give a broadcast scalar
+    if( lhs.numel() > 0 && detail::isBroadcastStrides(lhs.strides()) && detail::isBroadcastStrides(rhs.strides()) ) {
+        auto new_buffer = make_buffer<rtype>( 1 );
+        new_buffer->data()[0] = std::invoke(std::forward<Fn>(fn), lhs.data()[lhs.offset()], rhs.data()[rhs.offset()]);
+        return { std::move(new_buffer), lhs.shape(), lhs.strides(), 0 };
+    }
+
     int64_t new_offset  = 0;
     int64_t new_numel   = lhs.numel();
     auto    new_shape   = lhs.shape();
     auto    new_strides = detail::makeCompactStrides(new_shape);
-    auto    new_buffer  = std::make_shared< typename NDArrayRef<rtype>::BufferType >( new_numel );
+    auto    new_buffer  = make_buffer<rtype>( new_numel );
     auto    new_data    = new_buffer->data();
 
     auto foo = [new_data, new_numel, fn=std::tuple<Fn>(std::forward<Fn>(fn))](auto lhs, auto rhs){
@@ -404,4 +427,51 @@ NDArrayRef<rtype> apply(Fn&& fn, NDArrayRef<dtype1> const& lhs, NDArrayRef<dtype
     return { std::move(new_buffer), std::move(new_shape), std::move(new_strides), new_offset };
 }
 
+/************************ in-place element wise op ************************/
+
+/// @brief In-place element wise operation, inout[i] = fn(inout[i]).
+/// @param fn(dtype) -> dtype
+/// @param inout Value to be applied and overwritten
+/// @note Memory allocation: never, elements shared with other arrays are overwritten as well.
+template <typename Fn, typename dtype>
+void apply_inplace(Fn&& fn, ArrayRef<dtype>& inout)
+{
+    // a broadcast array holds a single element
+    int64_t numel  = inout.stride() == 0 ? std::min<int64_t>(inout.numel(), 1) : inout.numel();
+    int64_t stride = inout.stride();
+    auto    data   = inout.data() + inout.offset();
+
+    for(int64_t i = 0; i < numel; ++i) {
+        data[i * stride] = std::invoke(fn, data[i * stride]);
+    }
+}
+
+/// @brief In-place element wise operation, lhs[i] = fn(lhs[i], rhs[i]).
+/// @param fn(dtype1, dtype2) -> dtype1
+/// @param lhs First input value, overwritten by the result
+/// @param rhs Second input value to be applied
+/// @note Memory allocation: only when lhs has zero stride and rhs does not.
+template <typename Fn, typename dtype1, typename dtype2>
+void apply_inplace(Fn&& fn, ArrayRef<dtype1>& lhs, ArrayRef<dtype2> const& rhs)
+{
+    if( lhs.numel() != rhs.numel() ) {
+        throw std::invalid_argument("number of elements mismatch");
+    }
+
+    if( lhs.stride() == 0 && rhs.stride() != 0 ) {
+        lhs = apply(std::forward<Fn>(fn), lhs, rhs);
+        return;
+    }
+
+    int64_t numel = lhs.stride() == 0 ? std::min<int64_t>(lhs.numel(), 1) : lhs.numel();
+    int64_t lhs_stride = lhs.stride();
+    int64_t rhs_stride = rhs.stride();
+    auto    lhs_data   = lhs.data() + lhs.offset();
+    auto    rhs_data   = rhs.data() + rhs.offset();
+
+    for(int64_t i = 0; i < numel; ++i) {
+        lhs_data[i * lhs_stride] = std::invoke(fn, lhs_data[i * lhs_stride], rhs_data[i * rhs_stride]);
+    }
+}
+
 } // namespace core
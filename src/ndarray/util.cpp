@@ -1,7 +1,9 @@
 #include "util.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
+#include <string>
 
 namespace core
 {
@@ -63,6 +65,15 @@ bool isLinearStrides(
     return true;
 }
 
+/// @brief Determines whether the given strides broadcast a single element over the whole array.
+/// @return If all strides are zero, return true
+/// @note Such arrays hold one element in memory, element wise ops only need to compute it once.
+bool isBroadcastStrides(
+    std::span<const int64_t> strides)
+{
+    return std::all_of(strides.begin(), strides.end(), [](int64_t stride){ return stride == 0; });
+}
+
 /// @brief Determine whether two shapes can be broadcast(like numpy).
 /// @return Broadcast shape if compatible
 std::optional<std::vector<int64_t>> broadcastCompatible(
@@ -130,6 +141,21 @@ std::vector<int64_t> normalize(
     return ans;
 }
 
+/// @brief Check that every index of a gather or scatter lies in [-extent, extent).
+/// @param indicies Indices along one dimension, negative ones count from the end
+/// @param extent Length of the dimension
+/// @note Throw std::out_of_range for the first invalid index
+void checkIndicies(
+    std::span<const int64_t> indicies,
+    int64_t extent)
+{
+    for (auto index: indicies) {
+        if (index < -extent || index >= extent) {
+            throw std::out_of_range("index " + std::to_string(index) + " out of range");
+        }
+    }
+}
+
 /// @brief Converts the linear_index in the slice to a position in memory.
 /// @param linear_index Indicates the linear_index in slice
 /// @return The memory location corresponding to linear_index
@@ -43,6 +43,12 @@ bool isLinearStrides(
     std::span<const int64_t> strides,
     std::span<const int64_t> shape);
 
+/// @brief Determines whether the given strides broadcast a single element over the whole array.
+/// @return If all strides are zero, return true
+/// @note Such arrays hold one element in memory, element wise ops only need to compute it once.
+bool isBroadcastStrides(
+    std::span<const int64_t> strides);
+
 /// @brief Generates a compact array based on a given shape.
 /// @note makeLinearStrides(1,shape).
 /// @return std::vector<int64_t> array represents a compace stride
@@ -87,6 +93,14 @@ std::vector<int64_t> normalize(
     std::span<const int64_t> index,
     std::span<const int64_t> shape);
 
+/// @brief Check that every index of a gather or scatter lies in [-extent, extent).
+/// @param indicies Indices along one dimension, negative ones count from the end
+/// @param extent Length of the dimension
+/// @note Throw std::out_of_range for the first invalid index
+void checkIndicies(
+    std::span<const int64_t> indicies,
+    int64_t extent);
+
 /// @return A array increment type of std::vector<int64_t>.
 /// @brief increment[i] indicates position change in memory after increment,
 ///        when the highest change value of the index is i
@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "channel.h"
+
+namespace network
+{
+
+namespace
+{
+
+/// @brief Append the channel id to a message.
+void push_channel(ByteVector& message, ChannelMux::channel_type channel)
+{
+    message.push_back(&channel, sizeof(channel));
+}
+
+/// @brief Remove the channel id from a message.
+/// @return The channel id
+ChannelMux::channel_type pop_channel(ByteVector& message)
+{
+    ChannelMux::channel_type channel;
+    if( message.size() < sizeof(channel) )
+        throw std::runtime_error("channel message without channel id");
+    std::copy_n(message.data() + message.size() - sizeof(channel), sizeof(channel), reinterpret_cast<std::byte*>(&channel));
+    message.pop_back(sizeof(channel));
+    return channel;
+}
+
+} // namespace
+
+/************************ channel mux ************************/
+
+/// @brief Constructor, start receiving on the connections of a player.
+/// @param player Connected player, only the mux may use it from now on
+ChannelMux::ChannelMux(std::unique_ptr<MultiPartyPlayer> player)
+    : _player(std::move(player)), _send_mutexes(_player->num_players())
+{
+    for(auto peer: _player->all_but_me())
+        _readers.emplace_back([this, peer] { read(peer); });
+}
+
+/// @brief Destructor, close the mux if it is still open.
+ChannelMux::~ChannelMux()
+{
+    try {
+        close();
+    } catch(...) {
+        // the peers are gone, nothing left to tell them
+    }
+}
+
+/// @brief Open a channel.
+/// @param channel Channel id, the same on every party, throws std::invalid_argument if it is open already
+/// @return Player of the channel, it must be destroyed before the mux
+std::unique_ptr<ChannelMultiPartyPlayer> ChannelMux::open(channel_type channel)
+{
+    if( channel == CLOSE_CHANNEL )
+        throw std::invalid_argument("channel id reserved for closing");
+    {
+        std::lock_guard lock(_mutex);
+        if( _closed )
+            throw std::runtime_error("channel mux closed");
+        auto& box = inbox(channel);
+        if( box.is_open )
+            throw std::invalid_argument("channel " + std::to_string(channel) + " already open");
+        box.is_open = true;
+    }
+    return std::make_unique<ChannelMultiPartyPlayer>(this, channel);
+}
+
+/// @brief Tell the peers that no more channels are used and stop receiving.
+/// @note Blocks until every peer has closed too. If telling them fails, the connections are shut down so the
+///       readers stop anyway. Calling it again after it threw does nothing.
+void ChannelMux::close()
+{
+    {
+        std::lock_guard lock(_mutex);
+        if( _closed )
+            return;
+        _closed = true;
+    }
+
+    // every reader stops at the close message of its peer
+    try {
+        send_same(CLOSE_CHANNEL, _player->all_but_me(), ByteVector());
+    } catch(...) {
+        // the peers never see the close message, so fail the receives of the readers instead
+        _player->shutdown();
+        join_readers();
+        throw;
+    }
+    join_readers();
+
+    std::lock_guard lock(_mutex);
+    if( _error )
+        std::rethrow_exception(_error);
+}
+
+/// @brief Return the number of channels open.
+ChannelMux::size_type ChannelMux::num_open() const
+{
+    std::lock_guard lock(_mutex);
+    return std::count_if(_inboxes.begin(), _inboxes.end(), [](auto const& x) { return x.second.is_open; });
+}
+
+/// @brief Get the inbox of a channel, created at the first message or opening, _mutex must be held.
+ChannelMux::Inbox& ChannelMux::inbox(channel_type channel)
+{
+    auto& box = _inboxes[channel];
+    if( box.from.empty() )
+        box.from.resize(num_players());
+    return box;
+}
+
+/// @brief Receive every message of a peer until its close message, run by the reader of the peer.
+void ChannelMux::read(playerid_t peer)
+{
+    try {
+        while( true ) {
+            ByteVector message = _player->impl_recv(peer, 0);
+            channel_type channel = pop_channel(message);
+            if( channel == CLOSE_CHANNEL )
+                return;
+
+            std::lock_guard lock(_mutex);
+            auto& box = inbox(channel);
+            box.from[peer].push_back( std::move(message) );
+            box.arrived.notify_one();
+        }
+    } catch(...) {
+        std::lock_guard lock(_mutex);
+        if( !_error )
+            _error = std::current_exception();
+        for(auto& [channel, box]: _inboxes)
+            box.arrived.notify_all();
+    }
+}
+
+/// @brief Wait for every reader to stop.
+void ChannelMux::join_readers()
+{
+    for(auto& t: _readers)
+        t.join();
+    _readers.clear();
+}
+
+/// @brief Release a channel id, messages which arrived for its next use are kept.
+void ChannelMux::release(channel_type channel)
+{
+    std::lock_guard lock(_mutex);
+    auto it = _inboxes.find(channel);
+    if( it == _inboxes.end() )
+        return;
+    it->second.is_open = false;
+    bool pending = std::any_of(it->second.from.begin(), it->second.from.end(), [](auto const& q) { return !q.empty(); });
+    if( !pending )
+        _inboxes.erase(it);
+}
+
+/// @brief Send different messages of a channel to other players separately.
+/// @param messages Messages indexed by player id
+void ChannelMux::send(channel_type channel, mplayerid_t tos, mByteVector&& messages)
+{
+    for(auto to: tos)
+        push_channel(messages.at(to), channel);
+
+    // lock in the order of player ids, so concurrent channels never wait for each other in a cycle
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for(auto to: tos)
+        locks.emplace_back(_send_mutexes.at(to));
+    _player->impl_msend(tos, std::move(messages));
+}
+
+/// @brief Send the same message of a channel to other players.
+void ChannelMux::send_same(channel_type channel, mplayerid_t tos, ByteVector&& message)
+{
+    push_channel(message, channel);
+
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for(auto to: tos)
+        locks.emplace_back(_send_mutexes.at(to));
+    _player->impl_mbroadcast(tos, std::move(message));
+}
+
+/// @brief Wait for the next message of a channel from every player of froms.
+/// @return Messages indexed by player id, empty for the other players
+mByteVector ChannelMux::recv(channel_type channel, mplayerid_t froms)
+{
+    std::unique_lock lock(_mutex);
+    auto& box = inbox(channel);
+    box.arrived.wait(lock, [&] {
+        if( _error )
+            return true;
+        for(auto from: froms)
+            if( box.from.at(from).empty() )
+                return false;
+        return true;
+    });
+    if( _error )
+        std::rethrow_exception(_error);
+
+    mByteVector messages(num_players());
+    for(auto from: froms) {
+        messages.at(from) = std::move(box.from.at(from).front());
+        box.from.at(from).pop_front();
+    }
+    return messages;
+}
+
+/************************ channel player ************************/
+
+/// @brief Constructor, use ChannelMux::open instead.
+/// @param mux Mux of the channel
+/// @param channel Channel id
+ChannelMultiPartyPlayer::ChannelMultiPartyPlayer(ChannelMux* mux, channel_type channel)
+    : MultiPartyPlayer(mux->id(), mux->num_players()), _mux(mux), _channel(channel),
+      _bytes_send(mux->num_players(), 0), _bytes_recv(mux->num_players(), 0)
+{
+}
+
+/// @brief Destructor, release the channel id.
+ChannelMultiPartyPlayer::~ChannelMultiPartyPlayer()
+{
+    _mux->release(_channel);
+}
+
+/// @brief Get network statistics of this channel.
+/// @return Payload bytes sent to and received from every player, elapsed time and rounds
+Statistics ChannelMultiPartyPlayer::get_statistics() const
+{
+    Statistics stat;
+    stat.bytes_send    = _bytes_send;
+    stat.bytes_recv    = _bytes_recv;
+    stat.elapsed_send.resize(_n_players);
+    stat.elapsed_recv.resize(_n_players);
+    stat.elapsed_total = _timer.total_elapsed();
+    stat.rounds        = _rounds;
+    return stat;
+}
+
+void ChannelMultiPartyPlayer::count_send(mplayerid_t tos, size_type bytes)
+{
+    for(auto to: tos)
+        _bytes_send.at(to) += bytes;
+}
+
+void ChannelMultiPartyPlayer::count_recv(mByteVector const& messages)
+{
+    for(size_type i = 0; i < messages.size(); ++i)
+        _bytes_recv.at(i) += messages[i].size();
+}
+
+/// @brief Implementation of clearing my buffer and sync with all other players of the channel.
+void ChannelMultiPartyPlayer::impl_sync()
+{
+    ByteVector VERIFY_CODE { std::byte(0x31), std::byte(0x28), std::byte(0xaf), std::byte(0x9b) };
+    auto msgs_recv = this->impl_broadcast_recv(VERIFY_CODE.copy());
+    for(auto peer: all_but_me()) {
+        if( msgs_recv[peer] != VERIFY_CODE ) {
+            throw std::runtime_error("network synchronization error");
+        }
+    }
+}
+
+/// @brief Implementation of closing the connections, which are shared by every channel of the mux.
+void ChannelMultiPartyPlayer::impl_shutdown()
+{
+    _mux->_player->shutdown();
+}
+
+/// @brief Implementation of sending message to another player of the channel.
+void ChannelMultiPartyPlayer::impl_send(playerid_t to, ByteVector &&message)
+{
+    count_send({to}, message.size());
+    _mux->send_same(_channel, {to}, std::move(message));
+}
+
+/// @brief Implementation of receiving message from another player of the channel.
+ByteVector ChannelMultiPartyPlayer::impl_recv(playerid_t from, size_type)
+{
+    auto messages = _mux->recv(_channel, {from});
+    count_recv(messages);
+    return std::move(messages.at(from));
+}
+
+/// @brief Implementation of sending message to, then receiving from another player of the channel.
+/// @note The readers of the mux receive concurrently, so the send never waits for the receive.
+ByteVector ChannelMultiPartyPlayer::impl_exchange(playerid_t peer, ByteVector &&message)
+{
+    impl_send(peer, std::move(message));
+    return impl_recv(peer, 0);
+}
+
+/// @brief Implementation of sending a message to the next player, and receiving from the previous player.
+ByteVector ChannelMultiPartyPlayer::impl_pass_around(offset_type offset, ByteVector &&message)
+{
+    playerid_t to   = _my_pid + offset;
+    playerid_t from = _my_pid - offset;
+    impl_send(to, std::move(message));
+    return impl_recv(from, 0);
+}
+
+/// @brief Implementation of broadcasting message, then receiving from all other players of the channel.
+mByteVector ChannelMultiPartyPlayer::impl_broadcast_recv(ByteVector &&message)
+{
+    return impl_mbroadcast_recv(all_but_me(), std::move(message));
+}
+
+/// @brief Implementation of broadcasting message to all the other players of the channel.
+void ChannelMultiPartyPlayer::impl_broadcast(ByteVector &&message)
+{
+    impl_mbroadcast(all_but_me(), std::move(message));
+}
+
+/// @brief Implementation of sending different messages to other players of the channel separately.
+void ChannelMultiPartyPlayer::impl_msend(mplayerid_t tos, mByteVector &&messages)
+{
+    for(auto to: tos)
+        _bytes_send.at(to) += messages.at(to).size();
+    _mux->send(_channel, tos, std::move(messages));
+}
+
+/// @brief Implementation of receiving different messages from other players of the channel separately.
+mByteVector ChannelMultiPartyPlayer::impl_mrecv(mplayerid_t froms, size_type)
+{
+    auto messages = _mux->recv(_channel, froms);
+    count_recv(messages);
+    return messages;
+}
+
+/// @brief Implementation of broadcasting the same message to a group of players of the channel.
+void ChannelMultiPartyPlayer::impl_mbroadcast(mplayerid_t tos, ByteVector &&message)
+{
+    count_send(tos, message.size());
+    _mux->send_same(_channel, tos, std::move(message));
+}
+
+/// @brief Implementation of broadcasting message, then receiving among a group of players of the channel.
+mByteVector ChannelMultiPartyPlayer::impl_mbroadcast_recv(mplayerid_t group, ByteVector &&message)
+{
+    impl_mbroadcast(group, std::move(message));
+    return impl_mrecv(group, 0);
+}
+
+} // namespace network
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "multi_party_player.h"
+#include "playerid.h"
+#include "statistics.h"
+
+#include "../tools/byte_vector.h"
+
+namespace network
+{
+
+class ChannelMultiPartyPlayer;
+
+/************************ channel mux ************************/
+
+/// @class ChannelMux
+/// @brief Multiplex independent channels over the connections of one player, which are kept open across channels.
+/// @details Every message carries the id of its channel as a trailer. One reader thread per peer receives every
+///          message of the peer and queues it in the inbox of its channel, so a channel never blocks the others and
+///          messages of a channel may arrive before the channel is opened. Sends to a peer are serialized.
+///          All parties must open the same channel ids for the same jobs, and close the mux together.
+class ChannelMux
+{
+  public:
+    using size_type    = std::size_t;
+    using channel_type = uint32_t;
+
+    /// @brief Channel id reserved for closing the mux.
+    static constexpr channel_type CLOSE_CHANNEL = std::numeric_limits<channel_type>::max();
+
+    ChannelMux(ChannelMux const&)            = delete;
+    ChannelMux& operator=(ChannelMux const&) = delete;
+
+    /// @brief Constructor, start receiving on the connections of a player.
+    /// @param player Connected player, only the mux may use it from now on
+    explicit ChannelMux(std::unique_ptr<MultiPartyPlayer> player);
+
+    /// @brief Destructor, close the mux if it is still open.
+    ~ChannelMux();
+
+    /// @brief Open a channel.
+    /// @param channel Channel id, the same on every party, throws std::invalid_argument if it is open already
+    /// @return Player of the channel, it must be destroyed before the mux
+    std::unique_ptr<ChannelMultiPartyPlayer> open(channel_type channel);
+
+    /// @brief Tell the peers that no more channels are used and stop receiving.
+    /// @note Blocks until every peer has closed too. If telling them fails, the connections are shut down so the
+    ///       readers stop anyway. Calling it again after it threw does nothing.
+    void close();
+
+    /// @brief Return my player id.
+    playerid_t id() const { return _player->id(); }
+
+    /// @brief Return the number of players.
+    size_type num_players() const { return _player->num_players(); }
+
+    /// @brief Return the number of channels open.
+    size_type num_open() const;
+
+    /// @brief Get the player of the connections, such as for emulating network conditions.
+    /// @note Sending or receiving with it directly corrupts the channels.
+    MultiPartyPlayer* player() const { return _player.get(); }
+
+  private:
+    friend class ChannelMultiPartyPlayer;
+
+    /// @brief Messages of a channel which are not received yet, one queue per peer.
+    struct Inbox {
+        std::vector<std::deque<ByteVector>> from;
+        std::condition_variable arrived;
+        bool is_open = false;
+    };
+
+    std::unique_ptr<MultiPartyPlayer> _player;
+
+    mutable std::mutex _mutex;
+    std::unordered_map<channel_type, Inbox> _inboxes;
+    std::exception_ptr _error;
+    bool _closed = false;
+
+    std::vector<std::mutex>  _send_mutexes;  // one per peer
+    std::vector<std::thread> _readers;       // one per peer
+
+    Inbox& inbox(channel_type channel);
+    void read(playerid_t peer);
+    void join_readers();
+    void release(channel_type channel);
+
+    void send(channel_type channel, mplayerid_t tos, mByteVector&& messages);
+    void send_same(channel_type channel, mplayerid_t tos, ByteVector&& message);
+    mByteVector recv(channel_type channel, mplayerid_t froms);
+};
+
+/************************ channel player ************************/
+
+/// @class ChannelMultiPartyPlayer
+/// @brief MultiPartyPlayer of one channel of a ChannelMux, its messages are only seen by the same channel of the peers.
+/// @details Sends block until the message is written to the connection, receives wait for the inbox of the channel.
+///          Statistics count the payload bytes and the rounds of this channel only.
+class ChannelMultiPartyPlayer : public MultiPartyPlayer
+{
+  public:
+    using channel_type = ChannelMux::channel_type;
+
+  protected:
+    ChannelMux*  _mux;
+    channel_type _channel;
+
+    std::vector<size_type> _bytes_send;
+    std::vector<size_type> _bytes_recv;
+
+    void        impl_sync           ();
+    void        impl_shutdown       ();
+
+    void        impl_send           ( playerid_t to,      ByteVector && message );
+    ByteVector  impl_recv           ( playerid_t from,    size_type size_hint   );
+    ByteVector  impl_exchange       ( playerid_t peer,    ByteVector && message );
+    ByteVector  impl_pass_around    (offset_type offset,  ByteVector && message );
+    mByteVector impl_broadcast_recv (                     ByteVector && message );
+
+    void        impl_broadcast      (                     ByteVector && message );
+    void        impl_msend          (mplayerid_t tos,    mByteVector && messages);
+    mByteVector impl_mrecv          (mplayerid_t froms,   size_type size_hint   );
+    void        impl_mbroadcast     (mplayerid_t tos,     ByteVector && message );
+    mByteVector impl_mbroadcast_recv(mplayerid_t group,   ByteVector && message );
+
+    void count_send(mplayerid_t tos, size_type bytes);
+    void count_recv(mByteVector const& messages);
+
+  public:
+    ChannelMultiPartyPlayer(ChannelMultiPartyPlayer const&)            = delete;
+    ChannelMultiPartyPlayer& operator=(ChannelMultiPartyPlayer const&) = delete;
+
+    /// @brief Constructor, use ChannelMux::open instead.
+    /// @param mux Mux of the channel
+    /// @param channel Channel id
+    ChannelMultiPartyPlayer(ChannelMux* mux, channel_type channel);
+
+    /// @brief Destructor, release the channel id.
+    ~ChannelMultiPartyPlayer();
+
+    /// @brief Return the channel id.
+    channel_type channel() const { return _channel; }
+
+    /// @brief Get network statistics of this channel.
+    /// @return Payload bytes sent to and received from every player, elapsed time and rounds
+    Statistics get_statistics() const;
+};
+
+} // namespace network
@@ -13,10 +13,12 @@
 
 #include "statistics.h"
 #include "bitrate.hpp"
+#include "compression.h"
 #include "socket_package.h"
 
 #include "../tools/byte_vector.h"
 #include "../tools/timer.h"
+#include "../tools/trace.h"
 
 namespace network {
 
@@ -126,6 +128,9 @@ protected:
     TokenBucket _bucket;
     Strategy _strategy;
 
+    // compression
+    CompressionPolicy _compression;
+
     // socket
     SocketType _socket;
 
@@ -148,6 +153,14 @@ public:
     /// @param capacity Specific buffer capacity
     void set_bucket(BitrateType rate, size_type capacity);
 
+    /// @brief Set the compression policy of this connection.
+    /// @param policy Compression settings
+    void set_compression(CompressionPolicy const& policy) { _compression = policy; }
+
+    /// @brief Get the compression policy of this connection.
+    /// @return Compression settings
+    CompressionPolicy const& get_compression() const { return _compression; }
+
     /// @brief Get the delay between every sending.
     /// @return The delay between every sending
     DurationType get_delay()           const;
@@ -173,6 +186,9 @@ public:
     /// @return Future communiacation
     std::future<void> send_copy(ByteVector const& message);
 
+    /// @brief Close the socket, pending and later sends fail.
+    void close() { boost::system::error_code ec; _socket.lowest_layer().close(ec); }
+
 };
 
 /// @class Recver
@@ -207,6 +223,9 @@ public:
     DurationType get_elapsed_recv() const { return _timer.elapsed(); }
 
     std::future<ByteVector> recv(size_type size_hint);
+
+    /// @brief Close the socket, pending and later receives fail.
+    void close() { boost::system::error_code ec; _socket.lowest_layer().close(ec); }
 };
 
 /// @class CommPackage
@@ -257,6 +276,14 @@ public:
             _senders.at(i).set_bucket(rate, capacity);
     }
 
+    /// @brief Set the compression policy of senders, receivers accept compressed messages regardless.
+    /// @param tos The mpid of players whose connections are configured
+    /// @param policy Compression settings
+    void set_compression(mplayerid_t tos, CompressionPolicy const& policy) {
+        for(auto i: tos)
+            _senders.at(i).set_compression(policy);
+    }
+
     /// @brief Get the number of players.
     /// @return Number of players
     size_type get_n_players() const { return _senders.size(); }
@@ -277,6 +304,12 @@ public:
         return _recvers.at(from).recv(size_hint);
     }
 
+    /// @brief Close the sockets of every sender and receiver, not thread safe with their operations.
+    void close() {
+        for(auto& sender: _senders) sender.close();
+        for(auto& recver: _recvers) recver.close();
+    }
+
     /// @brief Get network statistics.
     /// @return The network statistics such as traffic statistics
     Statistics get_statistics() const;
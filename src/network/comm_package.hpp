@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <future>
 #include <cstdio>
 
@@ -24,11 +25,14 @@ namespace detail
 /// @brief Implementation of communication function - receive, using certain socket. 
 /// @param socket The socket type
 /// @param size_hint Estimation of the size of received information
+/// @param bytes_recv Incremented by the number of bytes read from the socket
 /// @return The return type of a coroutine or asynchronous operation
+/// @note Compressed frames are flagged in the size header and decompressed here.
 template <typename SocketType>
 boost::asio::awaitable<ByteVector> co_recv(
     SocketType &socket,
-    std::size_t size_hint)
+    std::size_t size_hint,
+    std::size_t &bytes_recv)
 {
     using boost::asio::async_read;
     using boost::asio::buffer;
@@ -58,6 +62,8 @@ boost::asio::awaitable<ByteVector> co_recv(
     // debug
     // t.stop(); auto e1 = t.elapsed(); t.start();
 
+    bool compressed = (msg_size & COMPRESSED_FRAME) != 0;
+    msg_size &= ~COMPRESSED_FRAME;
     message.resize(msg_size);
 
     // debug
@@ -67,6 +73,10 @@ boost::asio::awaitable<ByteVector> co_recv(
         socket,
         buffer(message.data(), msg_size),
         use_awaitable);
+    bytes_recv += msg_size;
+
+    if (compressed)
+        message = decompress_frame(message);
 
     // debug
     // t.stop(); auto e3 = t.elapsed();
@@ -276,12 +286,14 @@ boost::asio::awaitable<void> co_send_buffer_dynamic_packet_size(
     }
 }
 
-/// @brief Implementation of communication function - send using const lvalue reference for broadcasting. 
+/// @brief Implementation of communication function - send a frame behind its size header. 
+/// @param header Size of the frame, possibly flagged with COMPRESSED_FRAME
 /// @return The return type of a coroutine or asynchronous operation
 template <typename SocketType>
-boost::asio::awaitable<void> co_send_byte_vector_copy(
+boost::asio::awaitable<void> co_send_frame(
     SocketType &socket,
     ByteVector const &message,
+    std::size_t header,
     std::chrono::steady_clock::duration delay,
     TokenBucket &bucket)
 {
@@ -291,14 +303,16 @@ boost::asio::awaitable<void> co_send_byte_vector_copy(
     auto buffer = boost::asio::const_buffer(message.data(), message.size());
 
     co_await co_delay(delay);
-    co_await co_send_size(socket, message.size());
 
     if ( bucket.bitrate() == decltype(bucket.bitrate())::unlimited() )
     {
-        co_await co_send_buffer_unlimited(socket, buffer);
+        // header and payload in one write, so a small message leaves in one segment
+        std::array<boost::asio::const_buffer, 2> buffers{ boost::asio::buffer(&header, sizeof(header)), buffer };
+        co_await async_write(socket, buffers, use_awaitable);
     }
     else
     {
+        co_await co_send_size(socket, header);
         co_await co_send_buffer_dynamic_packet_size(socket, buffer, bucket);
     }
 
@@ -325,6 +339,30 @@ boost::asio::awaitable<void> co_send_byte_vector_copy(
 }
 
 
+/// @brief Implementation of communication function - send using const lvalue reference for broadcasting. 
+/// @return The return type of a coroutine or asynchronous operation
+template <typename SocketType>
+boost::asio::awaitable<void> co_send_byte_vector_copy(
+    SocketType &socket,
+    ByteVector const &message,
+    std::chrono::steady_clock::duration delay,
+    TokenBucket &bucket)
+{
+    co_await co_send_frame(socket, message, message.size(), delay, bucket);
+}
+
+/// @brief Implementation of communication function - send a compressed frame owned by the coroutine. 
+/// @return The return type of a coroutine or asynchronous operation
+template <typename SocketType>
+boost::asio::awaitable<void> co_send_compressed(
+    SocketType &socket,
+    ByteVector frame,
+    std::chrono::steady_clock::duration delay,
+    TokenBucket &bucket)
+{
+    co_await co_send_frame(socket, frame, frame.size() | COMPRESSED_FRAME, delay, bucket);
+}
+
 /************************  sender ************************/
 
 /// @brief Set the delay between every sending.
@@ -380,15 +418,25 @@ std::future<void> Sender<SocketType>::send_copy(ByteVector const &message)
     std::promise<void> promise_send;
     auto future_send = promise_send.get_future();
 
-    auto task_send = detail::co_send_byte_vector_copy(
-        _socket, message, _delay, _bucket);
+    // compress only when the policy expects it to pay off on this link
+    ByteVector frame;
+    bool compressed = should_compress(message, _compression, _bucket.bitrate())
+                   && compress_frame(message, frame);
+    size_type wire_size = compressed ? frame.size() : message.size();
+
+    auto task_send = compressed
+        ? detail::co_send_compressed(_socket, std::move(frame), _delay, _bucket)
+        : detail::co_send_byte_vector_copy(_socket, message, _delay, _bucket);
 
-    auto callback = [this, &message, promise_send = std::move(promise_send)](std::exception_ptr e) mutable {
+    auto start = Timer::Clock::now();
+    auto callback = [this, wire_size, start, promise_send = std::move(promise_send)](std::exception_ptr e) mutable {
         this->_timer.stop();
         if (e)
             promise_send.set_exception(e);
         else {
-            this->_bytes_send += message.size();
+            this->_bytes_send += wire_size;
+            if (trace::enabled())
+                trace::record("socket send", "comm", start, Timer::Clock::now() - start, wire_size);
             promise_send.set_value();
         }
     };
@@ -413,14 +461,16 @@ std::future<ByteVector> Recver<SocketType>::recv(size_type size_hint)
     auto future_recv = promise_recv.get_future();
 
     _timer.start();
+    auto start = Timer::Clock::now();
     co_spawn(
-        executor, detail::co_recv(_socket, size_hint),
-        [this, promise_recv = std::move(promise_recv)](std::exception_ptr e, ByteVector message_recv) mutable {
+        executor, detail::co_recv(_socket, size_hint, _bytes_recv),
+        [this, start, promise_recv = std::move(promise_recv)](std::exception_ptr e, ByteVector message_recv) mutable {
             this->_timer.stop();
             if (e)
                 promise_recv.set_exception(e);
             else {
-                this->_bytes_recv += message_recv.size();
+                if (trace::enabled())
+                    trace::record("socket recv", "comm", start, Timer::Clock::now() - start, message_recv.size());
                 promise_recv.set_value(std::move(message_recv));
             }
         });
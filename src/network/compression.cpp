@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "compression.h"
+
+namespace network
+{
+
+namespace
+{
+
+// block format, similar to LZ4: a sequence is
+//   token            literal length in the high nibble, match length - MIN_MATCH in the low nibble
+//   [length bytes]   255 255 ... x extends a nibble of 15
+//   literals
+//   offset           2 bytes little endian, absent in the last sequence
+//   [length bytes]
+constexpr std::size_t MIN_MATCH     = 4;
+constexpr std::size_t LAST_LITERALS = 5;    // the block always ends with literals
+constexpr std::size_t MF_LIMIT      = 12;   // no match starts within the last MF_LIMIT bytes
+constexpr std::size_t MAX_OFFSET    = 65535;
+constexpr int         HASH_LOG      = 14;
+constexpr std::size_t MAX_EXPANSION = 255;  // an extended length byte yields at most 255 bytes, nothing yields more
+
+inline uint32_t load32(const std::byte* p)
+{
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+inline uint64_t load64(const std::byte* p)
+{
+    uint64_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+inline uint32_t hash32(uint32_t x)
+{
+    return (x * 2654435761u) >> (32 - HASH_LOG);
+}
+
+/// @brief Write an extended length, return false on overflow.
+inline bool put_length(std::byte*& op, std::byte* end, std::size_t len)
+{
+    for (; len >= 255; len -= 255) {
+        if (op >= end) return false;
+        *op++ = std::byte{255};
+    }
+    if (op >= end) return false;
+    *op++ = static_cast<std::byte>(len);
+    return true;
+}
+
+/// @brief Read an extended length, return false on truncated input.
+inline bool get_length(const std::byte*& ip, const std::byte* end, std::size_t& len)
+{
+    uint8_t b;
+    do {
+        if (ip >= end) return false;
+        b = static_cast<uint8_t>(*ip++);
+        len += b;
+    } while (b == 255);
+    return true;
+}
+
+/// @brief Write a sequence of literals [anchor, anchor + n_literals) followed by a match, or only literals if match_len is 0.
+inline bool put_sequence(std::byte*& op, std::byte* end,
+                         const std::byte* anchor, std::size_t n_literals,
+                         std::size_t offset, std::size_t match_len)
+{
+    if (op >= end) return false;
+    std::byte* token = op++;
+
+    std::size_t lit_nibble   = std::min<std::size_t>(n_literals, 15);
+    std::size_t match_nibble = match_len ? std::min<std::size_t>(match_len - MIN_MATCH, 15) : 0;
+    *token = static_cast<std::byte>( (lit_nibble << 4) | match_nibble );
+
+    if (lit_nibble == 15 && !put_length(op, end, n_literals - 15)) return false;
+    if (static_cast<std::size_t>(end - op) < n_literals) return false;
+    memcpy(op, anchor, n_literals);
+    op += n_literals;
+
+    if (match_len == 0) return true;
+
+    if (end - op < 2) return false;
+    *op++ = static_cast<std::byte>(offset & 0xFF);
+    *op++ = static_cast<std::byte>(offset >> 8);
+    if (match_nibble == 15 && !put_length(op, end, match_len - MIN_MATCH - 15)) return false;
+    return true;
+}
+
+} // namespace
+
+/// @brief Compress n bytes with a fast LZ77 block codec.
+/// @param src Input bytes
+/// @param n Number of input bytes
+/// @param dest Output buffer
+/// @param capacity Size of the output buffer
+/// @return Number of bytes written, or 0 if the output does not fit into capacity
+std::size_t compress_block(const std::byte* src, std::size_t n, std::byte* dest, std::size_t capacity)
+{
+    std::byte* op  = dest;
+    std::byte* end = dest + capacity;
+
+    const std::byte* anchor = src;
+    if (n >= MF_LIMIT + 1) {
+        std::vector<uint32_t> table(std::size_t(1) << HASH_LOG, 0);
+
+        std::size_t ip    = 0;
+        std::size_t limit = n - MF_LIMIT;
+        while (ip < limit) {
+            uint32_t seq = load32(src + ip);
+            uint32_t h   = hash32(seq);
+            std::size_t ref = table[h];
+            table[h] = static_cast<uint32_t>(ip);
+
+            if (ref < ip && ip - ref <= MAX_OFFSET && load32(src + ref) == seq) {
+                // extend the match a word at a time, the first differing byte is found from the xor
+                std::size_t len  = MIN_MATCH;
+                std::size_t lend = n - LAST_LITERALS - ip;
+                while (len + 8 <= lend) {
+                    uint64_t diff = load64(src + ref + len) ^ load64(src + ip + len);
+                    if (diff) { len += std::countr_zero(diff) / 8; break; }
+                    len += 8;
+                }
+                if (len + 8 > lend) {
+                    while (len < lend && src[ref + len] == src[ip + len])
+                        ++len;
+                }
+
+                if (!put_sequence(op, end, anchor, (src + ip) - anchor, ip - ref, len))
+                    return 0;
+                ip    += len;
+                anchor = src + ip;
+            } else {
+                // skip faster through data that does not match, so incompressible input is cheap to probe
+                ip += 1 + ((src + ip - anchor) >> 6);
+            }
+        }
+    }
+
+    if (!put_sequence(op, end, anchor, (src + n) - anchor, 0, 0))
+        return 0;
+    return op - dest;
+}
+
+/// @brief Decompress a block produced by compress_block.
+/// @param src Compressed bytes
+/// @param n Number of compressed bytes
+/// @param dest Output buffer
+/// @param size Exact number of decompressed bytes
+/// @note Throws std::runtime_error on malformed input.
+void decompress_block(const std::byte* src, std::size_t n, std::byte* dest, std::size_t size)
+{
+    const std::byte* ip   = src;
+    const std::byte* iend = src + n;
+    std::byte*       op   = dest;
+    std::byte*       oend = dest + size;
+
+    auto corrupted = [] { return std::runtime_error("corrupted compressed message"); };
+
+    while (ip < iend) {
+        uint8_t token = static_cast<uint8_t>(*ip++);
+
+        std::size_t n_literals = token >> 4;
+        if (n_literals == 15 && !get_length(ip, iend, n_literals)) throw corrupted();
+        if (static_cast<std::size_t>(iend - ip) < n_literals || static_cast<std::size_t>(oend - op) < n_literals)
+            throw corrupted();
+        memcpy(op, ip, n_literals);
+        ip += n_literals;
+        op += n_literals;
+
+        if (ip == iend) break;  // last sequence
+
+        if (iend - ip < 2) throw corrupted();
+        std::size_t offset = static_cast<uint8_t>(ip[0]) | (static_cast<std::size_t>(ip[1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > static_cast<std::size_t>(op - dest)) throw corrupted();
+
+        std::size_t match_len = token & 15;
+        if (match_len == 15 && !get_length(ip, iend, match_len)) throw corrupted();
+        match_len += MIN_MATCH;
+        if (static_cast<std::size_t>(oend - op) < match_len) throw corrupted();
+
+        const std::byte* match = op - offset;
+        if (offset >= match_len) {
+            memcpy(op, match, match_len);
+            op += match_len;
+        } else {
+            // overlapping match repeats the last offset bytes
+            for (std::size_t i = 0; i < match_len; ++i)
+                *op++ = match[i];
+        }
+    }
+
+    if (op != oend) throw corrupted();
+}
+
+/// @brief Decide whether a message is worth compressing on a link of the given bitrate.
+/// @param message The message to be sent
+/// @param policy Compression settings of the connection
+/// @param bitrate Bitrate limit of the connection, unlimited if not shaped
+/// @return If the message should be sent compressed, return true
+bool should_compress(ByteVector const& message, CompressionPolicy const& policy, GigaBitsPerSecond bitrate)
+{
+    using Mode = CompressionPolicy::Mode;
+    using std::chrono::steady_clock;
+
+    std::size_t n = message.size();
+    if (policy.mode == Mode::disabled || n < policy.min_size)
+        return false;
+    if (policy.mode == Mode::always)
+        return true;
+
+    // probe the head, the middle and the tail of the message
+    std::size_t slice = std::min(policy.sample_size, n);
+    std::size_t starts[3] = { 0, (n - slice) / 2, n - slice };
+    std::size_t n_slices = (n <= 3 * slice) ? 1 : 3;
+
+    std::vector<std::byte> scratch(slice);
+    std::size_t sampled = 0, compressed = 0;
+
+    auto start = steady_clock::now();
+    for (std::size_t i = 0; i < n_slices; ++i) {
+        std::size_t c = compress_block(message.data() + starts[i], slice, scratch.data(), scratch.size());
+        sampled    += slice;
+        compressed += (c == 0) ? slice : c;
+    }
+    double seconds = std::chrono::duration<double>(steady_clock::now() - start).count();
+
+    double ratio = double(compressed) / double(sampled);
+    if (ratio > policy.max_ratio)
+        return false;
+
+    // bytes per second of the link and of the codec, decompression is assumed to cost as much as compression
+    auto link = (bitrate == GigaBitsPerSecond::unlimited()) ? policy.assumed_bitrate : bitrate;
+    double link_rate  = static_cast<double>(link.count()) * 1e9 / 8;
+    double codec_rate = double(sampled) / std::max(seconds, 1e-9);
+
+    double saved = double(n) * (1 - ratio) / link_rate;
+    double spent = 2 * double(n) / codec_rate;
+    return saved > spent;
+}
+
+/// @brief Build a compressed frame, holding the original size followed by the compressed block.
+/// @param message The message to be sent
+/// @param frame Output frame
+/// @return If the message shrinks, return true, otherwise frame is unspecified
+bool compress_frame(ByteVector const& message, ByteVector& frame)
+{
+    std::size_t n = message.size();
+    if (n <= sizeof(n))
+        return false;
+
+    // the frame must be strictly smaller than the message, anything larger is sent as is
+    frame.resize(n - 1);
+    memcpy(frame.data(), &n, sizeof(n));
+    std::size_t c = compress_block(message.data(), n, frame.data() + sizeof(n), frame.size() - sizeof(n));
+    if (c == 0)
+        return false;
+
+    frame.resize(sizeof(n) + c);
+    return true;
+}
+
+/// @brief Restore the message from a compressed frame.
+/// @param frame Frame built by compress_frame
+/// @return The original message
+ByteVector decompress_frame(ByteVector const& frame)
+{
+    std::size_t n;
+    if (frame.size() < sizeof(n))
+        throw std::runtime_error("corrupted compressed message");
+    memcpy(&n, frame.data(), sizeof(n));
+
+    // the size comes from the wire, reject it before allocating if the block cannot possibly expand to it
+    std::size_t c = frame.size() - sizeof(n);
+    if (n / MAX_EXPANSION > c)
+        throw std::runtime_error("corrupted compressed message");
+
+    ByteVector message(n);
+    decompress_block(frame.data() + sizeof(n), c, message.data(), n);
+    return message;
+}
+
+} // namespace network
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "bitrate.hpp"
+#include "../tools/byte_vector.h"
+
+namespace network {
+
+/// @struct CompressionPolicy
+/// @brief Per connection settings of the optional compression stage of Sender.
+/// @details Compression is decided per message by the sender. In adaptive mode a few slices of the
+///          message are compressed first, the message is sent compressed only if the sampled ratio
+///          is good enough and the time saved on the link exceeds the time spent (de)compressing.
+///          Random looking data such as secret shares is therefore bypassed after a cheap probe.
+///          Receivers always accept both compressed and plain frames.
+struct CompressionPolicy {
+    enum class Mode { disabled, adaptive, always };
+
+    Mode mode = Mode::disabled;
+
+    /// @brief Messages smaller than this are always sent as is.
+    std::size_t min_size = 4096;
+
+    /// @brief Number of bytes compressed from each of the three sampled slices.
+    std::size_t sample_size = 16384;
+
+    /// @brief Sampled compressed/plain ratios above this are treated as incompressible.
+    double max_ratio = 0.9;
+
+    /// @brief Link bitrate assumed when the sender has no bitrate limit.
+    GigaBitsPerSecond assumed_bitrate = GigaBitsPerSecond(10);
+
+    /// @brief Default constructor, compression disabled.
+    CompressionPolicy() = default;
+
+    /// @brief Constructor, set the mode and keep other defaults.
+    /// @param mode Compression mode
+    CompressionPolicy(Mode mode): mode(mode) {}
+};
+
+/// @brief Flag set in the size header of a compressed frame.
+inline constexpr std::size_t COMPRESSED_FRAME = std::size_t(1) << 63;
+
+/// @brief Compress n bytes with a fast LZ77 block codec.
+/// @param src Input bytes
+/// @param n Number of input bytes
+/// @param dest Output buffer
+/// @param capacity Size of the output buffer
+/// @return Number of bytes written, or 0 if the output does not fit into capacity
+std::size_t compress_block(const std::byte* src, std::size_t n, std::byte* dest, std::size_t capacity);
+
+/// @brief Decompress a block produced by compress_block.
+/// @param src Compressed bytes
+/// @param n Number of compressed bytes
+/// @param dest Output buffer
+/// @param size Exact number of decompressed bytes
+/// @note Throws std::runtime_error on malformed input.
+void decompress_block(const std::byte* src, std::size_t n, std::byte* dest, std::size_t size);
+
+/// @brief Decide whether a message is worth compressing on a link of the given bitrate.
+/// @param message The message to be sent
+/// @param policy Compression settings of the connection
+/// @param bitrate Bitrate limit of the connection, unlimited if not shaped
+/// @return If the message should be sent compressed, return true
+bool should_compress(ByteVector const& message, CompressionPolicy const& policy, GigaBitsPerSecond bitrate);
+
+/// @brief Build a compressed frame, holding the original size followed by the compressed block.
+/// @param message The message to be sent
+/// @param frame Output frame
+/// @return If the message shrinks, return true, otherwise frame is unspecified
+bool compress_frame(ByteVector const& message, ByteVector& frame);
+
+/// @brief Restore the message from a compressed frame.
+/// @param frame Frame built by compress_frame
+/// @return The original message
+/// @note Throws std::runtime_error on malformed input, sizes the block cannot expand to are rejected before allocating.
+ByteVector decompress_frame(ByteVector const& frame);
+
+} // namespace network
@@ -54,6 +54,9 @@ boost::asio::awaitable<void> co_connect(
         co_await tcp_socket_send.async_connect(endpoint, use_awaitable);
         co_await acceptor.async_accept(tcp_socket_recv, use_awaitable);
     }
+
+    // messages of concurrent channels follow each other without waiting for the delayed acks of the peer
+    tcp_socket_send.set_option(boost::asio::ip::tcp::no_delay(true));
 }
 
 /// @brief Handshake for plaintext socket.
@@ -73,6 +73,30 @@ MultiPartyPlayer::size_type MultiPartyPlayer::num_players() const
 void MultiPartyPlayer::sync()
 {
     this->impl_sync();
+    trace::align();
+}
+
+/// @brief Close the connections, pending and later operations fail instead of waiting for the other players.
+/// @note Safe to call from another thread than the one blocked in an operation. The player is unusable afterwards.
+void MultiPartyPlayer::shutdown()
+{
+    impl_shutdown();
+}
+
+/// @brief Note a send, the next receive waits for messages which depend on it.
+void MultiPartyPlayer::count_send_round()
+{
+    _sent_since_recv = true;
+}
+
+/// @brief Count a round at a receive, unless nothing was sent since the last one.
+/// @note Messages received one peer after another, with no send in between, were all sent before they could depend
+///       on each other, so they belong to the same round.
+void MultiPartyPlayer::count_recv_round()
+{
+    if( _sent_since_recv )
+        ++_rounds;
+    _sent_since_recv = false;
 }
 
 /// @brief Send message to another player.
@@ -82,6 +106,8 @@ void MultiPartyPlayer::sync()
 void MultiPartyPlayer::send(playerid_t to, ByteVector &&message_send)
 {
     TimerGuard guard(_timer);
+    trace::Span span("send", "network");
+    count_send_round();
     impl_send(to, std::move(message_send));
 }
 
@@ -92,6 +118,8 @@ void MultiPartyPlayer::send(playerid_t to, ByteVector &&message_send)
 void MultiPartyPlayer::msend(mplayerid_t tos, mByteVector &&messages)
 {
     TimerGuard guard(_timer);
+    trace::Span span("msend", "network");
+    count_send_round();
     impl_msend(tos, std::move(messages));
 }
 
@@ -101,6 +129,8 @@ void MultiPartyPlayer::msend(mplayerid_t tos, mByteVector &&messages)
 void MultiPartyPlayer::broadcast(ByteVector &&messages)
 {
     TimerGuard guard(_timer);
+    trace::Span span("broadcast", "network");
+    count_send_round();
     impl_broadcast(std::move(messages));
 }
 
@@ -110,6 +140,8 @@ void MultiPartyPlayer::broadcast(ByteVector &&messages)
 void MultiPartyPlayer::mbroadcast(mplayerid_t tos, ByteVector &&message)
 {
     TimerGuard guard(_timer);
+    trace::Span span("mbroadcast", "network");
+    count_send_round();
     impl_mbroadcast(tos, std::move(message));
 }
 
@@ -121,6 +153,8 @@ void MultiPartyPlayer::mbroadcast(mplayerid_t tos, ByteVector &&message)
 ByteVector MultiPartyPlayer::recv(playerid_t from, size_type size_hint)
 {
     TimerGuard guard(_timer);
+    trace::Span span("recv", "network");
+    count_recv_round();
     return impl_recv(from, size_hint);
 }
 
@@ -132,6 +166,8 @@ ByteVector MultiPartyPlayer::recv(playerid_t from, size_type size_hint)
 mByteVector MultiPartyPlayer::mrecv(mplayerid_t froms, size_type size_hint)
 {
     TimerGuard guard(_timer);
+    trace::Span span("mrecv", "network");
+    count_recv_round();
     return impl_mrecv(froms, size_hint);
 }
 
@@ -144,6 +180,9 @@ mByteVector MultiPartyPlayer::mrecv(mplayerid_t froms, size_type size_hint)
 ByteVector MultiPartyPlayer::exchange(playerid_t peer, ByteVector &&message_send)
 {
     TimerGuard guard(_timer);
+    trace::Span span("exchange", "network");
+    count_send_round();
+    count_recv_round();
     return impl_exchange(peer, std::move(message_send));
 }
 
@@ -155,6 +194,9 @@ ByteVector MultiPartyPlayer::exchange(playerid_t peer, ByteVector &&message_send
 ByteVector MultiPartyPlayer::pass_around(offset_type offset, ByteVector &&message_send)
 {
     TimerGuard guard(_timer);
+    trace::Span span("pass_around", "network");
+    count_send_round();
+    count_recv_round();
     return impl_pass_around(offset, std::move(message_send));
 }
 
@@ -165,6 +207,9 @@ ByteVector MultiPartyPlayer::pass_around(offset_type offset, ByteVector &&messag
 mByteVector MultiPartyPlayer::broadcast_recv(ByteVector &&message_send)
 {
     TimerGuard guard(_timer);
+    trace::Span span("broadcast_recv", "network");
+    count_send_round();
+    count_recv_round();
     return impl_broadcast_recv(std::move(message_send));
 }
 
@@ -175,6 +220,9 @@ mByteVector MultiPartyPlayer::broadcast_recv(ByteVector &&message_send)
 mByteVector MultiPartyPlayer::mbroadcast_recv(mplayerid_t group, ByteVector &&message)
 {
     TimerGuard guard(_timer);
+    trace::Span span("mbroadcast_recv", "network");
+    count_send_round();
+    count_recv_round();
     return impl_mbroadcast_recv(group, std::move(message));
 }
 
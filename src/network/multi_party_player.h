@@ -3,15 +3,19 @@
 #include "bitrate.hpp"
 #include "comm_package.h"
 #include "playerid.h"
+#include "profile.h"
 #include "socket_package.h"
 #include "statistics.h"
 
 #include "../tools/byte_vector.h"
 #include "../tools/timer.h"
+#include "../tools/trace.h"
 
 namespace network
 {
 
+class ChannelMux;
+
 /************************ multi party player ************************/
 
 /// @class MultiPartyPlayer
@@ -27,10 +31,19 @@ class MultiPartyPlayer
     playerid_t _my_pid;
     size_type  _n_players;
     Timer      _timer;
+    size_type  _rounds = 0;
+    bool       _sent_since_recv = true;  // a receive starts a new round only after a send
+
+    // multiplexes channels over the connections of a player, see channel.h
+    friend class ChannelMux;
 
   protected:
 
+    void count_send_round();
+    void count_recv_round();
+
     virtual void impl_sync() = 0;
+    virtual void impl_shutdown() = 0;
 
     virtual void        impl_send           ( playerid_t to,      ByteVector && message ) = 0;
     virtual ByteVector  impl_recv           ( playerid_t from,    size_type size_hint   ) = 0;
@@ -76,6 +89,10 @@ class MultiPartyPlayer
     /// @brief Clear my buffer and sync with all other players.
     void sync();
 
+    /// @brief Close the connections, pending and later operations fail instead of waiting for the other players.
+    /// @note Safe to call from another thread than the one blocked in an operation. The player is unusable afterwards.
+    void shutdown();
+
     /// @brief Send message to another player.
     /// @note Blocks until operation completes.
     /// @param to Another receiver player's pid
@@ -174,6 +191,9 @@ class SocketMultiPartyPlayer : public MultiPartyPlayer
     /// @brief Implementation of clearing my buffer and sync with all other players.
     void impl_sync();
 
+    /// @brief Implementation of closing the sockets, on an io thread while the player runs.
+    void impl_shutdown();
+
     /// @brief Implementation of sending message to another player using TCP socket.
     /// @param to Another receiver player's pid
     /// @param message The message to be sent
@@ -247,6 +267,15 @@ class SocketMultiPartyPlayer : public MultiPartyPlayer
     /// @param capacity Specific buffer capacity
     void set_bucket(mplayerid_t tos, BitrateType bitrate, size_type capacity);
 
+    /// @brief Emulate different network conditions - set the delay and bucket of a profile.
+    /// @param profile Network profile applied to the connections to all the other players
+    void set_profile(NetworkProfile const& profile);
+
+    /// @brief Enable optional compression of messages sent to the given players.
+    /// @param tos The mpid of players whose connections are configured
+    /// @param policy Compression settings, adaptive mode bypasses incompressible messages
+    void set_compression(mplayerid_t tos, CompressionPolicy const& policy);
+
     /// @brief Judge whether the threads are running.
     /// @return If they are running, return true, otherwise return false
     bool is_running() const;
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <future>
+
+#include <boost/asio/post.hpp>
+
 #include "mp_connect.hpp"
 
 #include "comm_package.hpp"
@@ -92,6 +96,25 @@ void SocketMultiPartyPlayer<SocketType>::set_bucket(
     _comm.set_bucket(tos, rate, capacity);
 }
 
+/// @brief Emulate different network conditions - set the delay and bucket of a profile.
+/// @param profile Network profile applied to the connections to all the other players
+template <typename SocketType>
+void SocketMultiPartyPlayer<SocketType>::set_profile(NetworkProfile const& profile)
+{
+    auto tos = this->all_but_me();
+    _comm.set_delay(tos, profile.delay());
+    _comm.set_bucket(tos, profile.bitrate, profile.capacity());
+}
+
+/// @brief Enable optional compression of messages sent to the given players.
+/// @param tos The mpid of players whose connections are configured
+/// @param policy Compression settings, adaptive mode bypasses incompressible messages
+template <typename SocketType>
+void SocketMultiPartyPlayer<SocketType>::set_compression(mplayerid_t tos, CompressionPolicy const& policy)
+{
+    _comm.set_compression(tos, policy);
+}
+
 /// @brief Get network statistics.
 /// @return The network statistics such as traffic statistics
 template <typename SocketType>
@@ -99,6 +122,7 @@ Statistics SocketMultiPartyPlayer<SocketType>::get_statistics() const
 {
     auto stat = _comm.get_statistics();
     stat.elapsed_total = MultiPartyPlayer::_timer.total_elapsed();
+    stat.rounds        = MultiPartyPlayer::_rounds;
     return stat;
 }
 
@@ -149,6 +173,24 @@ void SocketMultiPartyPlayer<SocketType>::connect(EndpointVector const &endpoints
     _comm = std::move(CommPackageType(std::move(sockets)));
 }
 
+/// @brief Implementation of closing the sockets, on an io thread while the player runs.
+/// @note Sockets are not thread safe, so the close runs on the io context which runs their operations.
+template <typename SocketType>
+void SocketMultiPartyPlayer<SocketType>::impl_shutdown()
+{
+    if (!_is_running || _ioc.stopped()) {
+        _comm.close();
+        return;
+    }
+    std::promise<void> promise_closed;
+    auto future_closed = promise_closed.get_future();
+    boost::asio::post(_ioc, [this, &promise_closed] {
+        _comm.close();
+        promise_closed.set_value();
+    });
+    future_closed.get();
+}
+
 /// @brief Implementation of clearing my buffer and sync with all other players.
 template <typename SocketType>
 void SocketMultiPartyPlayer<SocketType>::impl_sync()
@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <optional>
+#include <stdexcept>
+
+#include "profile.h"
+
+#include "../config/config.h"
+
+namespace network
+{
+
+namespace
+{
+
+/// @brief Throw std::invalid_argument unless the bitrate is positive and the round trip time is not negative.
+/// @param profile Profile to check
+/// @param source Where the profile came from, for the message
+void check_network_profile(NetworkProfile const& profile, std::string const& source)
+{
+    if( profile.bitrate.count() <= 0 || profile.rtt < NetworkProfile::DurationType::zero() )
+        throw std::invalid_argument("malformed network profile " + source);
+}
+
+} // namespace
+
+/// @brief Token bucket capacity of the links, 8ms of traffic at the bitrate.
+/// @return Capacity in bytes, zero for an unlimited bitrate
+std::size_t NetworkProfile::capacity() const
+{
+    if( bitrate == BitrateType::unlimited() )
+        return 0;
+    // in nanoseconds, the product with whole milliseconds truncates slow links to zero
+    auto window = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::milliseconds(8) );
+    return Bytes( window * bitrate ).count();
+}
+
+/// @brief Emulated time spent waiting on the latency of a number of rounds.
+NetworkProfile::DurationType NetworkProfile::latency(double rounds) const
+{
+    return std::chrono::duration_cast<DurationType>( delay() * rounds );
+}
+
+/// @brief Emulated time spent transferring a number of bytes over one link.
+NetworkProfile::DurationType NetworkProfile::transfer(double bytes) const
+{
+    if( bitrate == BitrateType::unlimited() )
+        return DurationType::zero();
+    std::chrono::duration<double> seconds( bytes * 8 / (bitrate.count() * 1e9) );
+    return std::chrono::duration_cast<DurationType>(seconds);
+}
+
+/// @brief Description of the profile, such as "wan (0.1Gbps, 40ms)".
+std::string NetworkProfile::to_string() const
+{
+    char buf[128];
+    double ms = std::chrono::duration<double, std::milli>(rtt).count();
+    if( bitrate == BitrateType::unlimited() )
+        std::snprintf(buf, sizeof(buf), "%s (unlimited, %gms)", name.c_str(), ms);
+    else
+        std::snprintf(buf, sizeof(buf), "%s (%gGbps, %gms)", name.c_str(), static_cast<double>(bitrate.count()), ms);
+    return buf;
+}
+
+/// @brief Get the predefined profiles.
+std::vector<NetworkProfile> const& network_profiles()
+{
+    using namespace std::chrono_literals;
+    using namespace literals;
+    static const std::vector<NetworkProfile> profiles = {
+        { "none",  GigaBitsPerSecond::unlimited(), 0us    },
+        { "lan",   10_Gbps,                        100us  },
+        { "metro", 1_Gbps,                         5ms    },
+        { "wan",   0.1_Gbps,                       40ms   },
+    };
+    return profiles;
+}
+
+/// @brief Find a predefined profile by name.
+NetworkProfile const& find_network_profile(std::string const& name)
+{
+    for(auto const& profile: network_profiles())
+        if( profile.name == name )
+            return profile;
+    throw std::invalid_argument("unknown network profile " + name);
+}
+
+/// @brief Parse a profile given on the command line.
+NetworkProfile parse_network_profile(std::string const& spec)
+{
+    auto colon = spec.find(':');
+    if( colon == std::string::npos )
+        return find_network_profile(spec);
+
+    NetworkProfile ans;
+    try {
+        ans.name    = "custom";
+        ans.bitrate = GigaBitsPerSecond( std::stold(spec.substr(0, colon)) );
+        ans.rtt     = std::chrono::duration_cast<NetworkProfile::DurationType>(
+                          std::chrono::duration<double, std::milli>( std::stod(spec.substr(colon + 1)) ));
+    } catch(std::logic_error const&) {
+        throw std::invalid_argument("malformed network profile " + spec);
+    }
+    check_network_profile(ans, spec);
+    return ans;
+}
+
+/// @brief Read a profile from a config file.
+NetworkProfile load_network_profile(ConfigFile const& conf, std::string const& section)
+{
+    // ConfigFile throws a string literal for missing entries
+    auto entry = [&](std::string const& name) -> std::optional<std::string> {
+        try {
+            return conf.value(section, name);
+        } catch(const char*) {
+            return std::nullopt;
+        }
+    };
+
+    NetworkProfile ans = find_network_profile( entry("profile").value_or("none") );
+    try {
+        if( auto bitrate = entry("bitrate") )
+            ans.bitrate = GigaBitsPerSecond( std::stold(*bitrate) );
+        if( auto rtt = entry("rtt") )
+            ans.rtt = std::chrono::duration_cast<NetworkProfile::DurationType>(
+                          std::chrono::duration<double, std::milli>( std::stod(*rtt) ));
+    } catch(std::logic_error const&) {
+        throw std::invalid_argument("malformed network profile in section " + section);
+    }
+    check_network_profile(ans, "in section " + section);
+    return ans;
+}
+
+} // namespace network
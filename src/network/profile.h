@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "bitrate.hpp"
+
+class ConfigFile;
+
+namespace network {
+
+/// @struct NetworkProfile
+/// @brief Named network condition emulated by the senders of a player, a link bitrate and a round trip time.
+/// @details Every message is delayed by half of the round trip time, so one round of a protocol, where
+///          all parties send and then wait, costs rtt / 2 on top of the transfer time at the bitrate.
+struct NetworkProfile {
+    using DurationType = std::chrono::steady_clock::duration;
+    using BitrateType  = GigaBitsPerSecond;
+
+    std::string  name;
+    BitrateType  bitrate;  // bitrate of every link, unlimited for no limit
+    DurationType rtt;      // round trip time
+
+    /// @brief Delay of every message.
+    DurationType delay() const { return rtt / 2; }
+
+    /// @brief Token bucket capacity of the links, 8ms of traffic at the bitrate.
+    /// @return Capacity in bytes, zero for an unlimited bitrate
+    /// @note The paced sender needs a capacity above 2ms of traffic.
+    std::size_t capacity() const;
+
+    /// @brief Emulated time spent waiting on the latency of a number of rounds.
+    DurationType latency(double rounds) const;
+
+    /// @brief Emulated time spent transferring a number of bytes over one link.
+    DurationType transfer(double bytes) const;
+
+    /// @brief Description of the profile, such as "wan (0.1Gbps, 40ms)".
+    std::string to_string() const;
+};
+
+/// @brief Get the predefined profiles.
+/// @return none (no emulation), lan (10Gbps, 0.1ms), metro (1Gbps, 5ms) and wan (100Mbps, 40ms)
+std::vector<NetworkProfile> const& network_profiles();
+
+/// @brief Find a predefined profile by name.
+/// @param name Name of the profile
+/// @return The profile, throws std::invalid_argument for an unknown name
+NetworkProfile const& find_network_profile(std::string const& name);
+
+/// @brief Parse a profile given on the command line.
+/// @param spec Name of a predefined profile, or "<bitrate in Gbps>:<rtt in ms>" such as "0.5:20"
+/// @return The profile, throws std::invalid_argument for a malformed spec
+NetworkProfile parse_network_profile(std::string const& spec);
+
+/// @brief Read a profile from a config file.
+/// @param conf Config file
+/// @param section Section holding the entries, "profile" names a predefined profile (default none),
+///                "bitrate" (Gbps) and "rtt" (ms) override its values
+/// @return The profile
+NetworkProfile load_network_profile(ConfigFile const& conf, std::string const& section = "network");
+
+} // namespace network
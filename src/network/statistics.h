@@ -23,6 +23,7 @@ struct Statistics
     std::vector<DurationType> elapsed_send;   // time comsumed to send to   player i
     std::vector<DurationType> elapsed_recv;   // time consumed to recv from player i
     DurationType              elapsed_total;  // time consumed on networking operations(blocking)
+    size_type                 rounds = 0;     // receives which followed a send, consecutive receives share a round
 
 };
 
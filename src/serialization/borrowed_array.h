@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+#include "stl.h"
+
+/// @class BorrowedArray
+/// @brief Read only view of a serialized ArrayRef that aliases the received bytes instead of copying them.
+/// @details Elements are loaded with memcpy, so the view has no alignment requirement on the message.
+///          A view made from a Deserializer is valid as long as the deserializer,
+///          a view made from a shared message keeps the message alive by itself.
+template <typename T>
+requires ( detail::TriviallySerializable<T> && !detail::PackedSerializable<T> )
+class BorrowedArray {
+
+    std::shared_ptr<const ByteVector> _owner;   // null when borrowed from a deserializer
+    const std::byte*                  _data;
+    int64_t                           _numel;
+
+public:
+
+    using value_type = T;
+
+    BorrowedArray(const std::byte* data, int64_t numel, std::shared_ptr<const ByteVector> owner = nullptr):
+        _owner(std::move(owner)), _data(data), _numel(numel) {}
+
+    /// @brief Return number of elements.
+    int64_t numel() const { return _numel; }
+
+    /// @brief Return the serialized bytes of the elements.
+    const std::byte* bytes() const { return _data; }
+
+    /// @brief Load the element at index.
+    T operator[](int64_t index) const {
+        T x;
+        memcpy(&x, _data + index * sizeof(T), sizeof(T));
+        return x;
+    }
+
+    /// @brief Copy the elements into a new ArrayRef.
+    core::ArrayRef<T> to_array() const {
+        auto buffer = core::make_buffer<T>(_numel);
+        if (_numel > 0)
+            memcpy(buffer->data(), _data, _numel * sizeof(T));
+        return core::ArrayRef<T>(std::move(buffer), _numel, 1, 0);
+    }
+};
+
+/// @brief Deserialize an ArrayRef as a view over the bytes of the deserializer.
+/// @param dr Deserializer reference
+/// @return View of the elements, valid as long as dr
+template <typename T>
+BorrowedArray<T> deserialize_borrowed(Deserializer& dr) {
+    auto numel = dr.get<std::size_t>();
+    if (numel > dr.remaining() / sizeof(T))
+        throw deserialization_error{};
+    return BorrowedArray<T>( dr.view(numel * sizeof(T)), static_cast<int64_t>(numel) );
+}
+
+/// @brief Borrow the ArrayRef serialized as the only object of a message.
+/// @param message Received message, shared with the returned view
+/// @return View of the elements, keeping message alive
+template <typename T>
+BorrowedArray<T> borrow_array(std::shared_ptr<const ByteVector> message) {
+    std::size_t numel;
+    if (message->size() < sizeof(numel))
+        throw deserialization_error{};
+    memcpy(&numel, message->data(), sizeof(numel));
+    if (numel > (message->size() - sizeof(numel)) / sizeof(T))
+        throw deserialization_error{};
+
+    const std::byte* data = message->data() + sizeof(numel);
+    return BorrowedArray<T>( data, static_cast<int64_t>(numel), std::move(message) );
+}
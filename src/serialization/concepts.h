@@ -131,6 +131,21 @@ concept TriviallySerializable = (
 );
 
 
+/// @details Arrays of a packed serializable type are sent with wire_bits bits per element,
+///          the object representation must be an unsigned word holding the value in its low wire_bits bits
+///          and zeros above, e.g. Z2<K> with K <= 128.
+///          class UserDefinedClass {
+///              using unsigned_value_type = ...;
+///              static constexpr std::size_t wire_bits = ...;
+///          }
+template <typename T>
+concept PackedSerializable = (
+    TriviallySerializableCustomObject<T> &&
+    requires { typename T::unsigned_value_type; T::wire_bits; } &&
+    sizeof(T) == sizeof(typename T::unsigned_value_type) &&
+    T::wire_bits < 8 * sizeof(T) && T::wire_bits <= 128
+);
+
 /**************** serializable ****************/
 
 /// @brief Determine whether a object is serializable or not.
@@ -43,6 +43,19 @@ public:
         return *this;
     }
 
+    /// @brief Return the number of bytes not deserialized yet.
+    /// @note Lengths read from the wire are checked against it before allocating.
+    std::size_t remaining() const {
+        return super::_remaining();
+    }
+
+    /// @brief Consume the next n bytes in place, for decoders reading raw bytes.
+    /// @param n The number of bytes
+    /// @return Pointer to the consumed bytes, valid as long as the deserializer
+    const std::byte* view(std::size_t n) {
+        return super::_view(n);
+    }
+
     /// @brief Get the stored data of deserialized type T object.
     /// @return The stored data of deserialized type T object
     template <typename T>
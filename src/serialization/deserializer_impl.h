@@ -35,13 +35,29 @@ protected:
 
     /// @brief Load n bytes from _src into data.
     void _read(void* data, size_type n) {
-        if(_head + n > _src.size())
+        if(n > _src.size() - _head)
             throw deserialization_error{};
 
         memcpy(data, _src.data() + _head, n);
         _head += n;
     }
 
+    /// @brief Number of bytes of _src not read yet.
+    size_type _remaining() const {
+        return _src.size() - _head;
+    }
+
+    /// @brief Skip n bytes of _src without copying them.
+    /// @return Pointer to the skipped bytes, valid as long as the deserializer
+    const std::byte* _view(size_type n) {
+        if(n > _src.size() - _head)
+            throw deserialization_error{};
+
+        const std::byte* data = _src.data() + _head;
+        _head += n;
+        return data;
+    }
+
     /// @brief Implementation of serialization for a custom object.
     /// @param x The ByteVector object input pointer
     template <TriviallySerializable T>
@@ -3,3 +3,4 @@
 #include "serializer.h"
 #include "deserializer.h"
 #include "stl.h"
+#include "borrowed_array.h"
@@ -2,6 +2,15 @@
 
 #include "serializer_impl.h"
 
+/// @brief Number of bytes written by serializing a trivially serializable object.
+/// @param x The C++ object
+/// @return sizeof(x)
+template <typename T>
+requires detail::TriviallySerializable<T>
+constexpr std::size_t serialized_size(const T& x) {
+    return sizeof(x);
+}
+
 /// @class Serializer
 /// @brief Responsible for converting C++objects into byte sequences.
 /// @details When instantiating a Serializer object, the default constructor should 
@@ -17,6 +26,15 @@ public detail::SerializerImpl<Serializer> {
 public:
 
     Serializer()                             = default;
+
+    /// @brief Reserve room for n bytes up front, e.g. serialized_size() of the objects to write.
+    /// @param n The number of bytes
+    explicit Serializer(std::size_t n) { super::_reserve(n); }
+
+    /// @brief Write into an existing byte vector, such as a recycled message buffer.
+    /// @param sink Byte vector whose contents are discarded and whose capacity is reused
+    explicit Serializer(ByteVector&& sink): super(std::move(sink)) {}
+
     ~Serializer()                            = default;
     Serializer(Serializer&&)                 = delete;
     Serializer(const Serializer&)            = delete;
@@ -40,6 +58,19 @@ public:
         return *this;
     }
 
+    /// @brief Reserve room for n more bytes, so that the following writes do not reallocate.
+    /// @param n The number of bytes
+    void reserve(std::size_t n) {
+        super::_reserve(n);
+    }
+
+    /// @brief Append n uninitialized bytes, to be filled in place by the caller.
+    /// @param n The number of bytes
+    /// @return Pointer to the first appended byte, valid until the next write
+    std::byte* extend(std::size_t n) {
+        return super::_extend(n);
+    }
+
     /// @brief Returns the right value reference of a byte sequence.
     /// @return The right value reference of a byte sequence
     ByteVector&& finalize() {
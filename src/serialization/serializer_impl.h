@@ -23,6 +23,10 @@ protected:
     ByteVector _sink;
 
     SerializerImpl()                                 = default;
+
+    /// @brief Write into an existing byte vector, its contents are discarded and its capacity is kept.
+    SerializerImpl(ByteVector&& sink):
+        _sink(std::move(sink)) { _sink.clear(); }
     ~SerializerImpl()                                = default;
     SerializerImpl(SerializerImpl&&)                 = delete;
     SerializerImpl(const SerializerImpl&)            = delete;
@@ -36,6 +40,21 @@ protected:
         _sink.push_back(data, n);
     }
 
+    /// @brief Reserve room in _sink for n more bytes.
+    /// @param n The number of bytes
+    void _reserve(size_type n) {
+        _sink.reserve(_sink.size() + n);
+    }
+
+    /// @brief Append n uninitialized bytes to _sink.
+    /// @param n The number of bytes
+    /// @return Pointer to the first appended byte
+    std::byte* _extend(size_type n) {
+        auto pos = _sink.size();
+        _sink.resize(pos + n);
+        return _sink.data() + pos;
+    }
+
     /// @brief Forward function for trivial object / c_array to write().
     /// @param x The C++ object input pointer
     template <typename T>
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <span>
+#include <cstring>
+#include <limits>
 #include <set>
 #include <unordered_set>
 #include <string>
@@ -14,6 +16,7 @@
 #include <unordered_set>
 
 #include "../ndarray/array_ref.hpp"
+#include "../tools/bit_packing.h"
 #include "serializer.h"
 #include "deserializer.h"
 
@@ -40,6 +43,13 @@ static void serialize(Serializer& sr, const std::string& str) {
     sr << std::span(str.begin(), str.end());
 }
 
+/// @brief Number of bytes written by serializing a string.
+/// @param str String const reference
+/// @return Size of the length prefix plus the characters
+inline std::size_t serialized_size(const std::string& str) {
+    return sizeof(std::size_t) + str.length();
+}
+
 /// @brief Deserializer for string.
 /// @param sr Deserializer reference
 /// @return Output string
@@ -58,6 +68,20 @@ void serialize(Serializer& sr, std::array<T, N> const& arr) {
     sr << std::span<const T, N>(arr);
 }
 
+/// @brief Number of bytes written by serializing an array.
+/// @param array Array const reference
+/// @return Sum of the sizes of the elements
+template <typename T, size_t N>
+std::size_t serialized_size(std::array<T, N> const& arr) {
+    if constexpr ( detail::TriviallySerializable<T> ) {
+        return N * sizeof(T);
+    } else {
+        std::size_t n = 0;
+        for (auto const& x: arr) n += serialized_size(x);
+        return n;
+    }
+}
+
 /// @brief Deserializer for array.
 /// @param sr Deserializer reference
 /// @return Output array
@@ -77,12 +101,31 @@ void serialize(Serializer& sr, std::vector<T> const& vec) {
     sr << std::span(vec.begin(), vec.end());
 }
 
+/// @brief Number of bytes written by serializing a vector.
+/// @param array Vector const reference
+/// @return Size of the length prefix plus the elements
+template <typename T>
+std::size_t serialized_size(std::vector<T> const& vec) {
+    if constexpr ( detail::TriviallySerializable<T> ) {
+        return sizeof(std::size_t) + vec.size() * sizeof(T);
+    } else {
+        std::size_t n = sizeof(std::size_t);
+        for (auto const& x: vec) n += serialized_size(x);
+        return n;
+    }
+}
+
 /// @brief Deserializer for vector.
 /// @param sr Deserializer reference
 /// @return Output vector
 template <typename T>
 void deserialize(Deserializer& dr, std::vector<T>& vec) {
-    vec.resize( dr.get<std::size_t>() );
+    auto size = dr.get<std::size_t>();
+    if constexpr ( detail::TriviallySerializable<T> ) {
+        if (size > dr.remaining() / sizeof(T))
+            throw deserialization_error{};
+    }
+    vec.resize(size);
     dr >> std::span(vec.begin(), vec.end());
 }
 
@@ -220,21 +263,109 @@ void deserialize(Deserializer& dr, std::tuple<T...>& _tuple) {
 
 /************************ core::ArrayRef ************************/
 
+namespace detail
+{
+
+/// @brief Write numel trivially serializable elements, read from src with the given stride.
+/// @note Stride 1 is a single memcpy, otherwise the elements are gathered in place into the sink.
+template <typename T>
+void serialize_strided(Serializer& sr, const T* src, int64_t stride, int64_t numel) {
+    static_assert( TriviallySerializable<T> );
+
+    if (numel <= 0) return;
+    if (stride == 1) {
+        sr << std::span(src, static_cast<std::size_t>(numel));
+        return;
+    }
+
+    std::byte* dest = sr.extend(static_cast<std::size_t>(numel) * sizeof(T));
+    for (int64_t i = 0; i < numel; ++i)
+        memcpy(dest + i * sizeof(T), src + i * stride, sizeof(T));
+}
+
+/// @brief Number of bytes taken by numel elements of an array, without the length prefix.
+template <typename T>
+requires ( TriviallySerializable<T> )
+constexpr std::size_t array_payload_size(std::size_t numel) {
+    if constexpr ( PackedSerializable<T> ) {
+        return packed_bytes(T::wire_bits, numel);
+    } else {
+        return numel * sizeof(T);
+    }
+}
+
+/// @brief Throw deserialization_error unless nbytes can hold numel elements of an array.
+/// @note numel comes from the wire, so it is checked without multiplying it before anything is allocated.
+template <typename T>
+requires ( TriviallySerializable<T> )
+void check_array_payload(std::size_t numel, std::size_t nbytes) {
+    bool fits;
+    if constexpr ( PackedSerializable<T> ) {
+        fits = numel <= nbytes / T::wire_bits * 8 + (nbytes % T::wire_bits) * 8 / T::wire_bits;
+    } else {
+        fits = numel <= nbytes / sizeof(T);
+    }
+    if (!fits || numel > static_cast<std::size_t>(std::numeric_limits<int64_t>::max()))
+        throw deserialization_error{};
+}
+
+} // namespace detail
+
+/// @brief Number of bytes written by serializing an ArrayRef.
+/// @param array ArrayRef const reference
+/// @return Size of the length prefix plus the (packed) elements
+template <typename T>
+requires ( detail::TriviallySerializable<T> )
+std::size_t serialized_size(const core::ArrayRef<T>& arr) {
+    return sizeof(std::size_t) + detail::array_payload_size<T>(arr.numel());
+}
+
 /// @brief Serializer for ArrayRef.
 /// @param sr Serializer reference
 /// @param array ArrayRef const reference
+/// @note Trivially serializable elements are written in bulk after reserving the exact size,
+///       packed serializable elements take wire_bits bits each.
 template <typename T>
 void serialize(Serializer& sr, const core::ArrayRef<T>& arr) {
-    std::vector<T> vec(arr.data(), arr.data() + arr.numel());
-    sr << vec;
+    std::size_t numel = static_cast<std::size_t>(arr.numel());
+
+    if constexpr ( detail::PackedSerializable<T> ) {
+        std::size_t nbytes = detail::array_payload_size<T>(numel);
+        sr.reserve(serialized_size(arr));
+        sr << numel;
+        pack_words<T::wire_bits, typename T::unsigned_value_type>(
+            arr.data() + arr.offset(), arr.stride(), arr.numel(), sr.extend(nbytes));
+    } else if constexpr ( detail::TriviallySerializable<T> ) {
+        sr.reserve(serialized_size(arr));
+        sr << numel;
+        detail::serialize_strided(sr, arr.data() + arr.offset(), arr.stride(), arr.numel());
+    } else {
+        sr << numel;
+        for (int64_t i = 0; i < arr.numel(); ++i)
+            sr << arr[i];
+    }
 }
 
 /// @brief Deserializer for ArrayRef.
 /// @param sr Deserializer reference
 /// @return Output ArrayRef
+/// @note If arr is the only owner of a compact buffer with the same number of elements,
+///       it is overwritten in place, otherwise the elements are read into a new pooled buffer.
 template <typename T>
 void deserialize(Deserializer& dr, core::ArrayRef<T>& arr) {
-    std::vector<T> vec;
-    dr >> vec;
-    arr = core::make_array(vec);
+    auto wire_numel = dr.get<std::size_t>();
+    if constexpr ( detail::TriviallySerializable<T> )
+        detail::check_array_payload<T>(wire_numel, dr.remaining());
+    auto numel = static_cast<int64_t>(wire_numel);
+
+    if ( !(arr.unique() && arr.stride() == 1 && arr.numel() == numel) )
+        arr = core::ArrayRef<T>(core::make_buffer<T>(numel), numel, 1, 0);
+
+    T* data = arr.data() + arr.offset();
+    if constexpr ( detail::PackedSerializable<T> ) {
+        std::size_t nbytes = detail::array_payload_size<T>(numel);
+        unpack_words<T::wire_bits, typename T::unsigned_value_type>(dr.view(nbytes), numel, data);
+    } else {
+        dr >> std::span(data, static_cast<std::size_t>(numel));
+    }
 }
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "math.h"
+
+/// @brief Pack eight consecutive 0/1 bytes into one byte, the first byte becomes the least significant bit.
+/// @note Only the least significant bit of each byte is used.
+inline uint8_t pack8(void const* src)
+{
+    uint64_t x;
+    memcpy(&x, src, 8);
+    x &= 0x0101010101010101ULL;
+#if defined(__BMI2__)
+    return static_cast<uint8_t>( _pext_u64(x, 0x0101010101010101ULL) );
+#else
+    // byte k is shifted to bit 56 + k, no two partial products overlap
+    return static_cast<uint8_t>( (x * 0x0102040810204080ULL) >> 56 );
+#endif
+}
+
+/// @brief Unpack one byte into eight consecutive 0/1 bytes, the least significant bit becomes the first byte.
+inline void unpack8(uint8_t x, void* dest)
+{
+#if defined(__BMI2__)
+    uint64_t y = _pdep_u64(x, 0x0101010101010101ULL);
+#else
+    // broadcast the byte, keep bit k in byte k, then move any set bit of a byte down to its bit 0
+    uint64_t y = (x * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+    y = ( (y + 0x7F7F7F7F7F7F7F7FULL) >> 7 ) & 0x0101010101010101ULL;
+#endif
+    memcpy(dest, &y, 8);
+}
+
+/// @brief Number of bytes holding numel elements of K bits each.
+inline constexpr size_t packed_bytes(size_t K, size_t numel) {
+    return ceildiv(K * numel, 8);
+}
+
+/// @brief Pack the low K bits of numel words, read from src with the given stride, into a little endian bit stream.
+/// @param src Elements whose object representation is an unsigned word with all bits above K cleared
+/// @param dest Receives exactly packed_bytes(K, numel) bytes
+/// @note Words are accumulated into a 64 or 128 bit register and flushed whole, K = 1 packs eight bytes at once.
+template <size_t K, typename Word, typename T>
+void pack_words(T const* src, int64_t stride, int64_t numel, std::byte* dest)
+{
+    static_assert( sizeof(T) == sizeof(Word) && K <= 128 );
+    using acc_type = std::conditional_t< (K <= 64), uint64_t, __uint128_t >;
+    constexpr int     ACC_BITS = 8 * sizeof(acc_type);
+    constexpr acc_type MASK    = acc_type(~acc_type(0)) >> (ACC_BITS - K);
+
+    int64_t i = 0;
+    if constexpr ( K == 1 ) {
+        if( stride == 1 ) {
+            for(; i + 8 <= numel; i += 8)
+                *dest++ = static_cast<std::byte>( pack8(src + i) );
+        }
+    }
+
+    acc_type acc  = 0;
+    int      bits = 0;
+    for(; i < numel; ++i) {
+        Word w;
+        memcpy(&w, src + i * stride, sizeof(Word));
+        acc_type v = static_cast<acc_type>(w) & MASK;
+
+        acc |= v << bits;
+        if( bits + static_cast<int>(K) >= ACC_BITS ) {
+            memcpy(dest, &acc, sizeof(acc));
+            dest += sizeof(acc);
+            acc   = (bits > 0) ? (v >> (ACC_BITS - bits)) : 0;
+            bits  = bits + K - ACC_BITS;
+        } else {
+            bits += K;
+        }
+    }
+    memcpy(dest, &acc, ceildiv(bits, 8));
+}
+
+/// @brief Unpack numel elements of K bits from a little endian bit stream, the inverse of pack_words.
+/// @param src Holds packed_bytes(K, numel) bytes
+/// @param dest Receives numel contiguous elements, bits above K are cleared
+template <size_t K, typename Word, typename T>
+void unpack_words(std::byte const* src, int64_t numel, T* dest)
+{
+    static_assert( sizeof(T) == sizeof(Word) && K <= 128 );
+    using acc_type = std::conditional_t< (K <= 64), uint64_t, __uint128_t >;
+    constexpr int     ACC_BITS = 8 * sizeof(acc_type);
+    constexpr acc_type MASK    = acc_type(~acc_type(0)) >> (ACC_BITS - K);
+
+    int64_t i = 0;
+    if constexpr ( K == 1 ) {
+        for(; i + 8 <= numel; i += 8)
+            unpack8( static_cast<uint8_t>(*src++), dest + i );
+    }
+
+    std::byte const* end = src + ( packed_bytes(K, numel) - i / 8 );
+
+    acc_type acc  = 0;
+    int      bits = 0;
+    for(; i < numel; ++i) {
+        acc_type v;
+        if( bits >= static_cast<int>(K) ) {
+            v     = acc & MASK;
+            acc >>= K;
+            bits -= K;
+        } else {
+            // refill, the last word of the stream may be short
+            acc_type next = 0;
+            size_t   n    = std::min<size_t>(sizeof(next), end - src);
+            memcpy(&next, src, n);
+            src += n;
+
+            v = (acc | (next << bits)) & MASK;
+            int used = K - bits;
+            acc  = (used < ACC_BITS) ? (next >> used) : 0;
+            bits = ACC_BITS - used;
+        }
+        Word w = static_cast<Word>(v);
+        memcpy(dest + i, &w, sizeof(Word));
+    }
+}
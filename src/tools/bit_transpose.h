@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "bit_packing.h"
+#include "math.h"
+
+/// @brief Transpose a 64x64 bit matrix in place, bit j of m[i] is swapped with bit i of m[j].
+/// @note Six rounds of block swaps, each round exchanges the off diagonal blocks of half the size
+///       with one shift, xor and mask per pair of rows.
+inline void transpose64(uint64_t* m)
+{
+    uint64_t mask = 0x00000000FFFFFFFFULL;
+    for(int j = 32; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for(int k = 0; k < 64; k = (k + j + 1) & ~j) {
+            uint64_t t = ( (m[k] >> j) ^ m[k + j] ) & mask;
+            m[k]     ^= t << j;
+            m[k + j] ^= t;
+        }
+    }
+}
+
+/// @brief Split numel elements, read from src with the given stride, into nplanes bit planes.
+/// @param src Elements whose object representation is a little endian integer
+/// @param planes planes[i][e] receives bit i of element e as Out(0) or Out(1)
+/// @note Each 64 bit limb of 64 elements is turned into 64 bit planes by one transpose64, so every element is
+///       loaded once for all planes. Eight such tiles are buffered, every plane then receives 512 elements in a row.
+template <typename T, typename Out>
+void split_bit_planes(T const* src, int64_t stride, int64_t numel, int64_t nplanes, Out* const* planes)
+{
+    static_assert( std::is_trivially_copyable_v<T> );
+    constexpr std::size_t BYTES = sizeof(T);
+    constexpr int64_t     TILES = 8;
+
+    uint64_t rows[TILES][64];
+    const int64_t nlimbs = ceildiv(nplanes, 64);
+    for(int64_t e0 = 0; e0 < numel; e0 += 64 * TILES) {
+        int64_t n = std::min<int64_t>(64 * TILES, numel - e0);
+        for(int64_t l = 0; l < nlimbs; ++l) {
+            std::size_t nbytes = std::min<std::size_t>(8, BYTES - 8 * l);
+            for(int64_t t = 0; t < TILES; ++t) {
+                for(int64_t j = 0; j < 64; ++j) {
+                    int64_t e = 64 * t + j;
+                    rows[t][j] = 0;
+                    if( e < n )
+                        memcpy(&rows[t][j], reinterpret_cast<std::byte const*>(src + (e0 + e) * stride) + 8 * l, nbytes);
+                }
+                transpose64(rows[t]);
+            }
+
+            int64_t nbits = std::min<int64_t>(64, nplanes - 64 * l);
+            for(int64_t b = 0; b < nbits; ++b) {
+                Out* dest = planes[64 * l + b] + e0;
+                for(int64_t t = 0; 64 * t < n; ++t) {
+                    // spread the word to 0/1 bytes eight bits at a time, widening bytes vectorizes well
+                    uint8_t bits[64];
+                    for(int k = 0; k < 8; ++k)
+                        unpack8( static_cast<uint8_t>(rows[t][b] >> (8 * k)), bits + 8 * k );
+
+                    int64_t m = std::min<int64_t>(64, n - 64 * t);
+                    if( m == 64 ) {
+                        for(int64_t j = 0; j < 64; ++j)
+                            dest[64 * t + j] = Out( bits[j] );
+                    } else {
+                        for(int64_t j = 0; j < m; ++j)
+                            dest[64 * t + j] = Out( bits[j] );
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+
+/// @brief Scaled values at least this large are left to the scalar conversion.
+inline constexpr double FIXED_CODEC_LIMIT = 0x1p51;
+
+namespace detail {
+
+/// @brief Adding 1.5 * 2^52 to a double in [0, 2^51) leaves its rounded integer in the low bits of the significand.
+inline constexpr double  FIXED_CODEC_MAGIC      = 0x1.8p52;
+inline constexpr int64_t FIXED_CODEC_MAGIC_BITS = std::bit_cast<int64_t>(FIXED_CODEC_MAGIC);
+
+/// @brief Check that fracbits keeps 2^fracbits and 2^-fracbits normal doubles.
+inline constexpr bool fixed_codec_scale_ok(int64_t fracbits) {
+    return fracbits > -1000 && fracbits < 1000;
+}
+
+} // namespace detail
+
+/// @brief Encode n floating point values to fixed point integers, dest[i] = round(src[i * stride] * 2^fracbits).
+/// @param dest Receives n integers, ties are rounded away from zero like std::round
+/// @return If every scaled value is finite and below FIXED_CODEC_LIMIT in magnitude, return true,
+///         otherwise the values of dest are unspecified and the caller converts them one by one
+/// @note The loop has no branch and no int conversion instruction, so it is vectorized by the compiler.
+template <std::floating_point T>
+bool encode_fixed(T const* src, int64_t stride, int64_t n, int64_t fracbits, int64_t* dest)
+{
+    using detail::FIXED_CODEC_MAGIC;
+    using detail::FIXED_CODEC_MAGIC_BITS;
+    if( !detail::fixed_codec_scale_ok(fracbits) )
+        return false;
+
+    const double scale = std::ldexp(1.0, static_cast<int>(fracbits));
+    int64_t bad = 0;
+    for(int64_t i = 0; i < n; ++i) {
+        double y = static_cast<double>(src[i * stride]) * scale;
+        double a = std::fabs(y);
+        bad |= !(a < FIXED_CODEC_LIMIT);
+
+        // r - MAGIC is a rounded half to even, move ties that went down one step up
+        double  r = a + FIXED_CODEC_MAGIC;
+        int64_t k = std::bit_cast<int64_t>(r) - FIXED_CODEC_MAGIC_BITS;
+        k += ( a - (r - FIXED_CODEC_MAGIC) == 0.5 );
+
+        int64_t s = std::bit_cast<int64_t>(y) >> 63;
+        dest[i] = (k ^ s) - s;
+    }
+    return bad == 0;
+}
+
+/// @brief Decode n fixed point integers to floating point values, dest[i] = src[i] * 2^-fracbits.
+/// @return If every integer is below FIXED_CODEC_LIMIT in magnitude, return true,
+///         otherwise the values of dest are unspecified and the caller converts them one by one
+template <std::floating_point T>
+bool decode_fixed(int64_t const* src, int64_t n, int64_t fracbits, T* dest)
+{
+    using detail::FIXED_CODEC_MAGIC;
+    using detail::FIXED_CODEC_MAGIC_BITS;
+    if( !detail::fixed_codec_scale_ok(fracbits) )
+        return false;
+
+    constexpr int64_t LIMIT = static_cast<int64_t>(FIXED_CODEC_LIMIT);
+    const double scale = std::ldexp(1.0, -static_cast<int>(fracbits));
+    int64_t bad = 0;
+    for(int64_t i = 0; i < n; ++i) {
+        int64_t v = src[i];
+        bad |= ( v >= LIMIT ) | ( v <= -LIMIT );
+
+        // v is exact in the significand of MAGIC, scaling by a power of two is exact as well
+        double d = std::bit_cast<double>(v + FIXED_CODEC_MAGIC_BITS) - FIXED_CODEC_MAGIC;
+        dest[i] = static_cast<T>(d * scale);
+    }
+    return bad == 0;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
@@ -117,8 +118,9 @@ void RawVector<T>::resize(size_type n)
         _size = new_size;
         return;
     }
-    // save original contents first, in case of reallocation
-    this->reserve(new_size);
+    // grow geometrically, so that appending one piece at a time is amortized O(1)
+    if (new_size > this->capacity())
+        this->reserve( std::max(new_size, 2 * this->capacity()) );
     _size = new_size;
 }
 
@@ -138,7 +140,7 @@ void RawVector<T>::reserve(size_type n)
     std::vector<T> tmp;
     tmp.reserve(new_capacity);
     if (size > 0)
-        memcpy(tmp.data(), this->data(), size);
+        memcpy(tmp.data(), this->data(), size * sizeof(T));
     _vec.swap(tmp);
 }
 
@@ -160,7 +162,7 @@ void RawVector<T>::shrink_to_fit()
         return;
 
     if (this->size() > 0)
-        memcpy(tmp.data(), this->data(), this->size());
+        memcpy(tmp.data(), this->data(), this->size() * sizeof(T));
     _vec.swap(tmp);
 }
 
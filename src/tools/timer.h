@@ -37,6 +37,12 @@ public:
         return _elapsed;
     }
 
+    /// @brief Get the last start time.
+    /// @return A Clock::time_point object records the last start time.
+    TimePointType last_start() const {
+        return _last_update;
+    }
+
     /// @brief Get the total elapsed time.
     /// @return A Clock::duration object records the total elapsed time.
     DurationType total_elapsed() const {
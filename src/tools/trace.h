@@ -0,0 +1,266 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+
+/// @brief Tracing of scoped spans, exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+/// @details Every thread records into its own buffer, a disabled tracer costs one relaxed atomic load per span.
+///          Names and categories are not copied, they must be string literals.
+namespace trace
+{
+
+/// @struct Event
+/// @brief A complete event, a span of time on one thread.
+struct Event
+{
+    const char*          name;
+    const char*          category;
+    Timer::TimePointType start;
+    Timer::DurationType  duration;
+    int64_t              bytes;     // payload of network events, -1 otherwise
+};
+
+namespace detail
+{
+
+/// @struct ThreadBuffer
+/// @brief Events of one thread, the mutex is only contended while exporting.
+struct ThreadBuffer
+{
+    uint64_t           tid;
+    std::mutex         mutex;
+    std::vector<Event> events;
+};
+
+/// @struct Registry
+/// @brief Process wide state of the tracer.
+struct Registry
+{
+    std::atomic<bool>                          enabled{false};
+    std::mutex                                 mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    Timer::TimePointType                       origin = Timer::Clock::now();
+};
+
+inline Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+inline ThreadBuffer& local_buffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto& r = registry();
+        std::lock_guard lock(r.mutex);
+        auto ans = std::make_shared<ThreadBuffer>();
+        ans->tid = r.buffers.size();
+        r.buffers.push_back(ans);
+        return ans;
+    }();
+    return *buffer;
+}
+
+/// @brief Append a string to JSON text as a quoted and escaped JSON string.
+inline void append_json_string(std::string& out, const char* str)
+{
+    static constexpr char hex[] = "0123456789abcdef";
+    out += '"';
+    for(auto p = reinterpret_cast<unsigned char const*>(str); *p; ++p) {
+        switch( *p ) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if( *p < 0x20 ) {
+                    out += "\\u00";
+                    out += hex[*p >> 4];
+                    out += hex[*p & 0xf];
+                } else {
+                    out += static_cast<char>(*p);
+                }
+        }
+    }
+    out += '"';
+}
+
+/// @brief Append a number of microseconds to JSON text, with three decimals.
+inline void append_json_micros(std::string& out, double micros)
+{
+    int n    = std::snprintf(nullptr, 0, "%.3f", micros);
+    auto old = out.size();
+    out.resize(old + n + 1);
+    std::snprintf(out.data() + old, n + 1, "%.3f", micros);
+    out.resize(old + n);
+}
+
+} // namespace detail
+
+/// @brief Turn tracing on or off, spans already open are not affected.
+inline void enable(bool on = true) { detail::registry().enabled.store(on, std::memory_order_relaxed); }
+
+/// @brief Whether tracing is on.
+inline bool enabled() { return detail::registry().enabled.load(std::memory_order_relaxed); }
+
+/// @brief Use now as time zero of the exported timestamps.
+/// @note Called by MultiPartyPlayer::sync(), so traces of all parties share time zero up to one network latency.
+inline void align()
+{
+    auto& r = detail::registry();
+    std::lock_guard lock(r.mutex);
+    r.origin = Timer::Clock::now();
+}
+
+/// @brief Drop all recorded events.
+inline void clear()
+{
+    auto& r = detail::registry();
+    std::lock_guard lock(r.mutex);
+    for(auto& buffer: r.buffers) {
+        std::lock_guard buffer_lock(buffer->mutex);
+        buffer->events.clear();
+    }
+}
+
+/// @brief Record an event on the calling thread.
+inline void record(const char* name, const char* category, Timer::TimePointType start, Timer::DurationType duration, int64_t bytes = -1)
+{
+    auto& buffer = detail::local_buffer();
+    std::lock_guard lock(buffer.mutex);
+    buffer.events.push_back( Event{name, category, start, duration, bytes} );
+}
+
+/// @class Span
+/// @brief Record the lifetime of a scope as an event.
+class Span
+{
+protected:
+    const char* _name;
+    const char* _category;
+    bool        _active;
+    Timer       _timer;
+
+public:
+    Span(Span const&)            = delete;
+    Span& operator=(Span const&) = delete;
+
+    /// @brief Constructor, start the span if tracing is on.
+    /// @param name Name of the span
+    /// @param category Category of the span, such as "pppu", "semi2k" or "network"
+    Span(const char* name, const char* category = "pppu")
+        : _name(name), _category(category), _active(enabled())
+    {
+        if( _active ) _timer.start();
+    }
+
+    /// @brief Destructor, record the span.
+    ~Span() { finish(); }
+
+    /// @brief Record the current span and start the next one in the same scope.
+    /// @param name Name of the next span
+    void next(const char* name)
+    {
+        finish();
+        _name   = name;
+        _active = enabled();
+        if( _active ) _timer.start();
+    }
+
+protected:
+    void finish()
+    {
+        if( !_active ) return;
+        _timer.stop();
+        record(_name, _category, _timer.last_start(), _timer.elapsed());
+        _active = false;
+    }
+};
+
+/// @brief Export the recorded events as Chrome trace JSON.
+/// @param pid Process id of the events, the player id so the parties appear as separate processes
+/// @return JSON text, one event per line
+inline std::string chrome_trace(int64_t pid)
+{
+    using std::chrono::duration;
+    using std::micro;
+
+    auto& r = detail::registry();
+    std::lock_guard lock(r.mutex);
+
+    std::string ans = "{\"traceEvents\":[\n";
+    bool first = true;
+    for(auto& buffer: r.buffers) {
+        std::lock_guard buffer_lock(buffer->mutex);
+        for(auto const& e: buffer->events) {
+            double ts  = duration<double, micro>(e.start - r.origin).count();
+            double dur = duration<double, micro>(e.duration).count();
+            ans += first ? "{\"name\":" : ",\n{\"name\":";
+            detail::append_json_string(ans, e.name);
+            ans += ",\"cat\":";
+            detail::append_json_string(ans, e.category);
+            ans += ",\"ph\":\"X\",\"ts\":";
+            detail::append_json_micros(ans, ts);
+            ans += ",\"dur\":";
+            detail::append_json_micros(ans, dur);
+            ans += ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(buffer->tid);
+            if( e.bytes >= 0 )
+                ans += ",\"args\":{\"bytes\":" + std::to_string(e.bytes) + "}";
+            ans += '}';
+            first = false;
+        }
+    }
+    ans += "\n]}\n";
+    return ans;
+}
+
+/// @brief Write the recorded events to a Chrome trace JSON file.
+/// @param path Output file
+/// @param pid Process id of the events, see chrome_trace
+inline void write_chrome_trace(std::string const& path, int64_t pid)
+{
+    std::ofstream out(path);
+    if( !out )
+        throw std::runtime_error("unable to open trace file " + path);
+    out << chrome_trace(pid);
+}
+
+/// @brief Merge Chrome trace files written by write_chrome_trace, for example one per party.
+/// @param path Output file
+/// @param inputs Files to merge
+inline void merge_chrome_traces(std::string const& path, std::vector<std::string> const& inputs)
+{
+    std::ofstream out(path);
+    if( !out )
+        throw std::runtime_error("unable to open trace file " + path);
+
+    out << "{\"traceEvents\":[\n";
+    bool first = true;
+    for(auto const& input: inputs) {
+        std::ifstream in(input);
+        if( !in )
+            throw std::runtime_error("unable to open trace file " + input);
+        std::string line;
+        while( std::getline(in, line) ) {
+            // every event is on a line of its own
+            if( line.rfind("{\"name\"", 0) != 0 )
+                continue;
+            if( line.back() == ',' ) line.pop_back();
+            out << (first ? "" : ",\n") << line;
+            first = false;
+        }
+    }
+    out << "\n]}\n";
+}
+
+} // namespace trace